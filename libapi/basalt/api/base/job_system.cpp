@@ -0,0 +1,407 @@
+#include <basalt/api/base/job_system.h>
+
+#include <basalt/api/base/asserts.h>
+
+#include <algorithm>
+
+namespace basalt {
+
+namespace {
+
+// the JobSystem and index of worker threads. Other threads are thread 0
+thread_local JobSystem const* tJobSystem{};
+thread_local u32 tThreadIndex{};
+
+// number of tries to find a job before the thread goes to sleep
+constexpr auto NUM_SPINS = u32{64};
+
+// Chase-Lev deque with a fixed capacity (Lê et al. 2013, "Correct and
+// Efficient Work-Stealing for Weak Memory Models"). Only the owning thread
+// pushes and pops
+class JobDeque final {
+public:
+  enum class StealResult : u8 { Stolen, Empty, Contended };
+
+  auto push(Job* const job) -> void {
+    auto const bottom = mBottom.load(std::memory_order_relaxed);
+    auto const top = mTop.load(std::memory_order_acquire);
+    // would overwrite a job which wasn't taken yet, also in release builds
+    if (bottom - top >= CAPACITY) {
+      BASALT_CRASH("job deque overflow");
+    }
+
+    mJobs[bottom & MASK].store(job, std::memory_order_release);
+    std::atomic_thread_fence(std::memory_order_release);
+    mBottom.store(bottom + 1, std::memory_order_relaxed);
+  }
+
+  auto pop() -> Job* {
+    auto const bottom = mBottom.load(std::memory_order_relaxed) - 1;
+    mBottom.store(bottom, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    auto top = mTop.load(std::memory_order_relaxed);
+
+    if (top > bottom) {
+      mBottom.store(bottom + 1, std::memory_order_relaxed);
+
+      return nullptr;
+    }
+
+    auto* job = mJobs[bottom & MASK].load(std::memory_order_relaxed);
+    if (top == bottom) {
+      // the last job might be stolen concurrently
+      if (!mTop.compare_exchange_strong(top, top + 1,
+                                        std::memory_order_seq_cst,
+                                        std::memory_order_relaxed)) {
+        job = nullptr;
+      }
+
+      mBottom.store(bottom + 1, std::memory_order_relaxed);
+    }
+
+    return job;
+  }
+
+  auto steal(Job*& job) -> StealResult {
+    auto top = mTop.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    auto const bottom = mBottom.load(std::memory_order_acquire);
+
+    if (top >= bottom) {
+      return StealResult::Empty;
+    }
+
+    job = mJobs[top & MASK].load(std::memory_order_acquire);
+    if (!mTop.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+                                      std::memory_order_relaxed)) {
+      return StealResult::Contended;
+    }
+
+    return StealResult::Stolen;
+  }
+
+  [[nodiscard]]
+  auto is_empty() const -> bool {
+    return mBottom.load(std::memory_order_relaxed) <=
+           mTop.load(std::memory_order_relaxed);
+  }
+
+private:
+  static constexpr auto CAPACITY = i64{JobSystem::MAX_JOBS_PER_THREAD};
+  static constexpr auto MASK = CAPACITY - 1;
+  static_assert((CAPACITY & MASK) == 0);
+
+  // thieves and the owner don't share a cache line
+  alignas(64) std::atomic<i64> mTop{};
+  alignas(64) std::atomic<i64> mBottom{};
+  std::array<std::atomic<Job*>, CAPACITY> mJobs{};
+};
+
+} // namespace
+
+struct JobSystem::Worker final {
+  JobDeque deque;
+  std::unique_ptr<Job[]> jobs{new Job[MAX_JOBS_PER_THREAD]};
+  u32 nextJob{};
+  // xorshift state to pick the victims of steals
+  u32 randomState{};
+
+  // only written by the worker
+  std::atomic<u64> numJobs{};
+  std::atomic<u64> numSteals{};
+  std::atomic<u64> numFailedSteals{};
+  std::atomic<u64> numContendedSteals{};
+  std::atomic<u64> numSleeps{};
+};
+
+namespace {
+
+auto increment(std::atomic<u64>& counter) -> void {
+  counter.store(counter.load(std::memory_order_relaxed) + 1,
+                std::memory_order_relaxed);
+}
+
+} // namespace
+
+auto JobSystem::global() -> JobSystem& {
+  static auto instance =
+    JobSystem{std::max(std::thread::hardware_concurrency(), 1u)};
+
+  return instance;
+}
+
+JobSystem::JobSystem(u32 const numThreads)
+  : mOwnerThread{std::this_thread::get_id()} {
+  BASALT_ASSERT(numThreads > 0);
+
+  mWorkers.reserve(numThreads);
+  for (auto i = u32{0}; i < numThreads; ++i) {
+    mWorkers.push_back(std::make_unique<Worker>());
+    mWorkers.back()->randomState = i + 1;
+  }
+
+  mThreads.reserve(numThreads - 1);
+  for (auto i = u32{1}; i < numThreads; ++i) {
+    mThreads.emplace_back([this, i] { work(i); });
+  }
+}
+
+JobSystem::~JobSystem() noexcept {
+  {
+    auto const lock = std::lock_guard{mMutex};
+    mIsShuttingDown.store(true);
+  }
+  mWakeUp.notify_all();
+
+  for (auto& thread : mThreads) {
+    thread.join();
+  }
+}
+
+auto JobSystem::num_threads() const -> u32 {
+  return static_cast<u32>(mWorkers.size());
+}
+
+auto JobSystem::add_dependency(Job& job, Job& dependency) -> void {
+  BASALT_ASSERT(dependency.mNumContinuations < Job::MAX_CONTINUATIONS);
+
+  job.mNumPending.fetch_add(1, std::memory_order_relaxed);
+  dependency.mContinuations[dependency.mNumContinuations++] = &job;
+}
+
+auto JobSystem::run(Job& job) -> void {
+  release(job);
+}
+
+auto JobSystem::wait(Job const& job) -> void {
+  auto const threadIndex = thread_index();
+
+  while (!job.is_finished()) {
+    if (auto* const other = find_job(threadIndex)) {
+      execute(*other);
+    } else {
+      std::this_thread::yield();
+    }
+  }
+}
+
+auto JobSystem::stats() const -> Stats {
+  auto stats = Stats{};
+
+  for (auto const& worker : mWorkers) {
+    stats.numJobs += worker->numJobs.load(std::memory_order_relaxed);
+    stats.numSteals += worker->numSteals.load(std::memory_order_relaxed);
+    stats.numFailedSteals +=
+      worker->numFailedSteals.load(std::memory_order_relaxed);
+    stats.numContendedSteals +=
+      worker->numContendedSteals.load(std::memory_order_relaxed);
+    stats.numSleeps += worker->numSleeps.load(std::memory_order_relaxed);
+  }
+
+  return stats;
+}
+
+// not synchronized with the workers. Call while no jobs are running
+auto JobSystem::reset_stats() -> void {
+  for (auto& worker : mWorkers) {
+    worker->numJobs.store(0, std::memory_order_relaxed);
+    worker->numSteals.store(0, std::memory_order_relaxed);
+    worker->numFailedSteals.store(0, std::memory_order_relaxed);
+    worker->numContendedSteals.store(0, std::memory_order_relaxed);
+    worker->numSleeps.store(0, std::memory_order_relaxed);
+  }
+}
+
+auto JobSystem::allocate_job(Job* const parent) -> Job& {
+  auto& worker = *mWorkers[thread_index()];
+  auto& job = worker.jobs[worker.nextJob++ & (MAX_JOBS_PER_THREAD - 1)];
+  // reusing a running job corrupts it and whoever waits for it. Waiting for it
+  // to finish could deadlock, e.g. when it's the calling job itself
+  if (!job.is_finished()) {
+    BASALT_CRASH("too many jobs in flight");
+  }
+
+  job.mParent = parent;
+  job.mNumUnfinished.store(1, std::memory_order_relaxed);
+  job.mNumPending.store(1, std::memory_order_relaxed);
+  job.mNumContinuations = 0;
+
+  if (parent) {
+    parent->mNumUnfinished.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  return job;
+}
+
+auto JobSystem::parallel_for(u32 const count, u32 const minChunkSize,
+                             RangeFunction const& function) -> void {
+  auto const chunkSize = std::max(minChunkSize, 1u);
+  if (count <= chunkSize || mWorkers.size() == 1) {
+    function.invoke(function.function, 0, count);
+
+    return;
+  }
+
+  auto& root = create_job([] {});
+  split_range(root, function, 0, count, chunkSize);
+  run(root);
+  wait(root);
+}
+
+// lazy binary splitting: a range is only split when the own deque is empty,
+// i.e. when the previous half was stolen by another thread. This adapts the
+// number of jobs to the number of idle threads instead of the range size
+auto JobSystem::split_range(Job& parent, RangeFunction const& function,
+                            u32 begin, u32 end, u32 const chunkSize) -> void {
+  auto& deque = mWorkers[thread_index()]->deque;
+
+  while (end - begin > chunkSize) {
+    if (deque.is_empty()) {
+      auto const middle = begin + (end - begin) / 2;
+      run(create_child_job(
+        parent, [this, &parent, &function, middle, end, chunkSize] {
+          split_range(parent, function, middle, end, chunkSize);
+        }));
+      end = middle;
+    } else {
+      function.invoke(function.function, begin, begin + chunkSize);
+      begin += chunkSize;
+    }
+  }
+
+  function.invoke(function.function, begin, end);
+}
+
+auto JobSystem::thread_index() const -> u32 {
+  if (tJobSystem == this) {
+    return tThreadIndex;
+  }
+
+  BASALT_ASSERT(std::this_thread::get_id() == mOwnerThread,
+                    "the JobSystem can't be used from this thread");
+
+  return 0;
+}
+
+auto JobSystem::find_job(u32 const threadIndex) -> Job* {
+  auto& worker = *mWorkers[threadIndex];
+
+  auto* job = worker.deque.pop();
+  if (!job) {
+    // start at a random victim to spread the thieves
+    auto& x = worker.randomState;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+
+    auto const numWorkers = num_threads();
+    auto const first = x % numWorkers;
+    for (auto i = u32{0}; i < numWorkers && !job; ++i) {
+      auto const victim = (first + i) % numWorkers;
+      if (victim == threadIndex) {
+        continue;
+      }
+
+      switch (mWorkers[victim]->deque.steal(job)) {
+      case JobDeque::StealResult::Stolen:
+        increment(worker.numSteals);
+        break;
+
+      case JobDeque::StealResult::Empty:
+        increment(worker.numFailedSteals);
+        job = nullptr;
+        break;
+
+      case JobDeque::StealResult::Contended:
+        increment(worker.numContendedSteals);
+        job = nullptr;
+        break;
+      }
+    }
+  }
+
+  if (job) {
+    mNumQueued.fetch_sub(1, std::memory_order_relaxed);
+  }
+
+  return job;
+}
+
+auto JobSystem::execute(Job& job) -> void {
+  job.mFunction(job);
+  increment(mWorkers[thread_index()]->numJobs);
+
+  finish(job);
+}
+
+auto JobSystem::finish(Job& job) -> void {
+  // Read before the decrement. Once the count reaches zero on any thread, the
+  // job may be reused by its creator
+  auto* const parent = job.mParent;
+  auto const continuations = job.mContinuations;
+  auto const numContinuations = job.mNumContinuations;
+
+  if (job.mNumUnfinished.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+    return;
+  }
+
+  for (auto i = u32{0}; i < numContinuations; ++i) {
+    release(*continuations[i]);
+  }
+
+  if (parent) {
+    finish(*parent);
+  }
+}
+
+auto JobSystem::release(Job& job) -> void {
+  if (job.mNumPending.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+    return;
+  }
+
+  // pairs with the check of the sleeping worker, so one of both sees the other
+  mNumQueued.fetch_add(1, std::memory_order_seq_cst);
+  mWorkers[thread_index()]->deque.push(&job);
+
+  if (mNumSleeping.load(std::memory_order_seq_cst) > 0) {
+    // the worker is either waiting or will see the queued job
+    { auto const lock = std::lock_guard{mMutex}; }
+    mWakeUp.notify_one();
+  }
+}
+
+auto JobSystem::work(u32 const threadIndex) -> void {
+  tJobSystem = this;
+  tThreadIndex = threadIndex;
+
+  auto& worker = *mWorkers[threadIndex];
+  auto numSpins = u32{0};
+
+  while (!mIsShuttingDown.load(std::memory_order_relaxed)) {
+    if (auto* const job = find_job(threadIndex)) {
+      execute(*job);
+      numSpins = 0;
+
+      continue;
+    }
+
+    if (++numSpins < NUM_SPINS) {
+      std::this_thread::yield();
+
+      continue;
+    }
+
+    numSpins = 0;
+    increment(worker.numSleeps);
+
+    auto lock = std::unique_lock{mMutex};
+    mNumSleeping.fetch_add(1, std::memory_order_seq_cst);
+    mWakeUp.wait(lock, [&] {
+      return mNumQueued.load(std::memory_order_seq_cst) > 0 ||
+             mIsShuttingDown.load(std::memory_order_relaxed);
+    });
+    mNumSleeping.fetch_sub(1, std::memory_order_relaxed);
+  }
+}
+
+} // namespace basalt
@@ -0,0 +1,194 @@
+#pragma once
+
+#include <basalt/api/base/types.h>
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace basalt {
+
+class JobSystem;
+
+// A unit of work of the JobSystem. Jobs live in a ring buffer of the thread
+// which created them and are reused after the buffer wrapped around, so a job
+// must be finished long before that (see JobSystem::MAX_JOBS_PER_THREAD)
+class alignas(64) Job final {
+public:
+  static constexpr auto PAYLOAD_SIZE = uSize{64};
+  static constexpr auto MAX_CONTINUATIONS = uSize{4};
+
+  [[nodiscard]]
+  auto is_finished() const -> bool {
+    return mNumUnfinished.load(std::memory_order_acquire) == 0;
+  }
+
+private:
+  friend JobSystem;
+
+  using Function = void (*)(Job&);
+
+  Function mFunction{};
+  Job* mParent{};
+  // the job itself + its unfinished children
+  std::atomic<u32> mNumUnfinished{};
+  // the pending call to run + the unfinished dependencies
+  std::atomic<u32> mNumPending{};
+  u32 mNumContinuations{};
+  std::array<Job*, MAX_CONTINUATIONS> mContinuations{};
+  alignas(std::max_align_t) std::array<std::byte, PAYLOAD_SIZE> mPayload{};
+};
+
+// Work-stealing job scheduler. Every thread has its own Chase-Lev deque: the
+// owner pushes and pops jobs at the bottom without contention, idle threads
+// steal from the top of a random other deque. The thread which created the
+// JobSystem is thread 0 and helps executing jobs while waiting for one. Jobs
+// may only be created and waited for by thread 0 and from within jobs.
+//
+// Jobs form graphs in two ways: a child job keeps its parent unfinished until
+// it finished itself, and a job with dependencies only starts after all of
+// them finished.
+class JobSystem final {
+public:
+  // Jobs in flight and queued jobs per thread. Exceeding it crashes in all
+  // builds instead of corrupting jobs
+  static constexpr auto MAX_JOBS_PER_THREAD = u32{4096};
+
+  struct Stats final {
+    u64 numJobs{};
+    u64 numSteals{};
+    // the deque of the victim was empty
+    u64 numFailedSteals{};
+    // another thread took the job first
+    u64 numContendedSteals{};
+    u64 numSleeps{};
+  };
+
+  // uses every hardware thread. Created on first use, which makes the calling
+  // thread its thread 0
+  static auto global() -> JobSystem&;
+
+  // numThreads includes the calling thread
+  explicit JobSystem(u32 numThreads);
+
+  JobSystem(JobSystem const&) = delete;
+  JobSystem(JobSystem&&) = delete;
+
+  ~JobSystem() noexcept;
+
+  auto operator=(JobSystem const&) -> JobSystem& = delete;
+  auto operator=(JobSystem&&) -> JobSystem& = delete;
+
+  [[nodiscard]]
+  auto num_threads() const -> u32;
+
+  // index of the calling thread in [0, num_threads()), e.g. to look up
+  // per-thread data
+  [[nodiscard]]
+  auto thread_index() const -> u32;
+
+  // F must be callable without arguments and fit into the payload of a Job
+  template <typename F>
+  auto create_job(F&& function) -> Job& {
+    return create_job(nullptr, std::forward<F>(function));
+  }
+
+  // the parent is finished only after all of its children
+  template <typename F>
+  auto create_child_job(Job& parent, F&& function) -> Job& {
+    return create_job(&parent, std::forward<F>(function));
+  }
+
+  // The job won't start before the dependency finished. Call before running
+  // any of the two
+  auto add_dependency(Job& job, Job& dependency) -> void;
+
+  // the job starts as soon as all of its dependencies finished
+  auto run(Job&) -> void;
+
+  // executes other jobs until the job finished
+  auto wait(Job const&) -> void;
+
+  // Calls function(begin, end) for disjoint ranges covering [0, count) and
+  // waits for all of them. Ranges are split in half while other threads are
+  // out of work, otherwise they're processed in chunks of at least
+  // minChunkSize on the calling thread
+  template <typename F>
+  auto parallel_for(u32 const count, u32 const minChunkSize, F const& function)
+    -> void {
+    parallel_for(count, minChunkSize,
+                 RangeFunction{&function, [](void const* f, u32 const begin,
+                                             u32 const end) {
+                                 (*static_cast<F const*>(f))(begin, end);
+                               }});
+  }
+
+  [[nodiscard]]
+  auto stats() const -> Stats;
+
+  auto reset_stats() -> void;
+
+private:
+  struct Worker;
+
+  struct RangeFunction final {
+    void const* function{};
+    void (*invoke)(void const*, u32 begin, u32 end){};
+  };
+
+  std::vector<std::unique_ptr<Worker>> mWorkers;
+  std::vector<std::thread> mThreads;
+  std::thread::id mOwnerThread;
+  std::mutex mMutex;
+  std::condition_variable mWakeUp;
+  std::atomic<u32> mNumQueued{};
+  std::atomic<u32> mNumSleeping{};
+  std::atomic<bool> mIsShuttingDown{};
+
+  template <typename F>
+  auto create_job(Job* const parent, F&& function) -> Job& {
+    using Function = std::decay_t<F>;
+    static_assert(sizeof(Function) <= Job::PAYLOAD_SIZE);
+    static_assert(alignof(Function) <= alignof(std::max_align_t));
+
+    auto& job = allocate_job(parent);
+    new (job.mPayload.data()) Function{std::forward<F>(function)};
+    job.mFunction = [](Job& self) {
+      auto& f =
+        *std::launder(reinterpret_cast<Function*>(self.mPayload.data()));
+      f();
+      f.~Function();
+    };
+
+    return job;
+  }
+
+  auto allocate_job(Job* parent) -> Job&;
+
+  auto parallel_for(u32 count, u32 minChunkSize, RangeFunction const&) -> void;
+
+  auto split_range(Job& parent, RangeFunction const&, u32 begin, u32 end,
+                   u32 chunkSize) -> void;
+
+  // null if there is no job to take
+  auto find_job(u32 threadIndex) -> Job*;
+
+  auto execute(Job&) -> void;
+
+  auto finish(Job&) -> void;
+
+  // queues the job if this was the last thing it was waiting for
+  auto release(Job&) -> void;
+
+  auto work(u32 threadIndex) -> void;
+};
+
+} // namespace basalt
@@ -55,6 +55,8 @@ public:
   auto set_stencil_write_mask(u32) -> void;
   auto set_blend_constant(Color const&) -> void;
   auto set_transform(TransformState, Matrix4x4f32 const&) -> void;
+  // records only the 48 bytes of the affine matrix. Not for ViewToClip
+  auto set_transform(TransformState, Affine3x4f32 const&) -> void;
   auto set_ambient_light(Color const&) -> void;
   auto set_lights(gsl::span<LightData const>) -> void;
   auto set_material(Color const& diffuse, Color const& ambient = {},
@@ -6,6 +6,9 @@
 #include "backend/ext/types.h"
 
 #include <basalt/api/shared/handle_pool.h>
+#include <basalt/api/shared/handle_reserve.h>
+
+#include <basalt/api/base/types.h>
 
 #include <gsl/span>
 
@@ -20,6 +23,10 @@ namespace basalt::gfx {
 
 class Context : public std::enable_shared_from_this<Context> {
 public:
+  // handles reserve_mesh and reserve_material hand out per submit before they
+  // fall back to new slots
+  static constexpr auto HANDLE_RESERVE_SIZE = u32{256};
+
   static auto create(DevicePtr, ext::DeviceExtensions, SwapChainPtr, Info)
     -> ContextPtr;
 
@@ -46,11 +53,18 @@ public:
 
   [[nodiscard]]
   auto create_material(MaterialCreateInfo const&) -> UniqueMaterial;
+  // the handle must come from reserve_material
+  [[nodiscard]]
+  auto create_material(MaterialHandle reserved, MaterialCreateInfo const&)
+    -> UniqueMaterial;
   auto destroy(MaterialHandle) noexcept -> void;
   [[nodiscard]]
   auto get(MaterialHandle) const -> Material const&;
   [[nodiscard]]
   auto get(MaterialHandle) -> Material&;
+  // false for reserved materials which aren't created yet
+  [[nodiscard]]
+  auto is_valid(MaterialHandle) const noexcept -> bool;
 
   [[nodiscard]]
   auto create_material_class(MaterialClassCreateInfo const&)
@@ -61,9 +75,15 @@ public:
 
   [[nodiscard]]
   auto create_mesh(MeshCreateInfo const&) -> UniqueMesh;
+  // the handle must come from reserve_mesh
+  [[nodiscard]]
+  auto create_mesh(MeshHandle reserved, MeshCreateInfo const&) -> UniqueMesh;
   auto destroy(MeshHandle) noexcept -> void;
   [[nodiscard]]
   auto get(MeshHandle) const -> Mesh const&;
+  // false for reserved meshes which aren't created yet
+  [[nodiscard]]
+  auto is_valid(MeshHandle) const noexcept -> bool;
 
   [[nodiscard]]
   auto create_pipeline(PipelineCreateInfo const&) -> Pipeline;
@@ -154,6 +174,17 @@ public:
 
   auto destroy(ext::XMeshHandle) noexcept -> void;
 
+  // Thread safe and never blocks. Hands out the handle of a mesh or material
+  // before it is created, e.g. to a loader on a worker thread. The handle
+  // becomes valid once the resource is created with it on the main thread.
+  // The first HANDLE_RESERVE_SIZE handles after a submit reuse free slots, any
+  // further ones take new slots
+  [[nodiscard]]
+  auto reserve_mesh() -> MeshHandle;
+  [[nodiscard]]
+  auto reserve_material() -> MaterialHandle;
+
+  // refills the handle reserves
   auto submit(gsl::span<CommandList>) -> void;
 
   // engine-private
@@ -182,6 +213,8 @@ private:
   HandlePool<MaterialClass, MaterialClassHandle> mMaterialClasses;
   HandlePool<Material, MaterialHandle> mMaterials;
   HandlePool<Mesh, MeshHandle> mMeshes;
+  HandleReserve<MaterialHandle> mReservedMaterials;
+  HandleReserve<MeshHandle> mReservedMeshes;
   std::function<OnFrameCapturedFn> mOnFrameCaptured;
 
   auto make_deleter() -> ContextResourceDeleter;
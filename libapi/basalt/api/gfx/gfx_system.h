@@ -3,19 +3,86 @@
 #include <basalt/api/scene/system.h>
 #include <basalt/api/scene/types.h>
 
+#include <basalt/api/shared/types.h>
+
+#include <basalt/api/base/types.h>
+
 #include <entt/core/hashed_string.hpp>
 
+#include <memory>
+
 namespace basalt::gfx {
 
+class LightSelector;
+class OcclusionCuller;
+class PortalCuller;
+class RenderProxyList;
+
+// Enables occlusion culling for a scene when added to the context of its
+// entity registry. Entities with an Occluder component are rasterized into a
+// small software depth buffer and entities with a LocalBounds component are
+// tested against it before a draw call is generated for them
+struct OcclusionCulling final {
+  struct Stats final {
+    u32 numOccluders{};
+    u32 numTested{};
+    u32 numOccluded{};
+    // outside of the view frustum
+    u32 numOutside{};
+    SecondsF32 rasterizationTime{};
+    SecondsF32 testTime{};
+  };
+
+  bool enabled{true};
+
+  // written by the GfxSystem every frame
+  Stats stats;
+};
+
+// Enables portal culling for a scene when added to the context of its entity
+// registry. Starting at the Cell containing the camera, the view is narrowed
+// recursively through the screen space bounds of the portals. Entities with a
+// CellMember component are only drawn if their cell is visible. Everything is
+// drawn while the camera isn't inside of a cell
+struct PortalCulling final {
+  struct Stats final {
+    u32 numCells{};
+    u32 numVisibleCells{};
+    u32 numPortalsTested{};
+    u32 numCulled{};
+    SecondsF32 time{};
+  };
+
+  bool enabled{true};
+
+  // written by the GfxSystem every frame
+  Stats stats;
+};
+
 class GfxSystem final : public System {
 public:
   using UpdateAfter = TransformSystem;
 
   static constexpr auto sMainCamera = entt::hashed_string::value("main camera");
 
-  GfxSystem() noexcept = default;
+  GfxSystem() noexcept;
+
+  GfxSystem(GfxSystem const&) = delete;
+  GfxSystem(GfxSystem&&) = delete;
+
+  ~GfxSystem() noexcept override;
+
+  auto operator=(GfxSystem const&) -> GfxSystem& = delete;
+  auto operator=(GfxSystem&&) -> GfxSystem& = delete;
 
   auto on_update(UpdateContext const&) -> void override;
+
+private:
+  std::unique_ptr<OcclusionCuller> mOcclusionCuller;
+  std::unique_ptr<PortalCuller> mPortalCuller;
+  std::unique_ptr<LightSelector> mLightSelector;
+  // created on the first update, then kept in sync with the entities
+  std::unique_ptr<RenderProxyList> mRenderProxies;
 };
 
 } // namespace basalt::gfx
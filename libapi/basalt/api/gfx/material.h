@@ -9,11 +9,15 @@
 
 #include <basalt/api/math/matrix4.h>
 
+#include <basalt/api/base/asserts.h>
 #include <basalt/api/base/types.h>
 
 #include <gsl/span>
 
+#include <cstddef>
+#include <cstring>
 #include <optional>
+#include <type_traits>
 #include <variant>
 #include <vector>
 
@@ -47,38 +51,83 @@ struct MaterialProperty {
   MaterialPropertyValue value;
 };
 
+template <typename T>
+constexpr auto material_property_type_of() noexcept -> MaterialPropertyType {
+  if constexpr (std::is_same_v<T, UniformColors>) {
+    return MaterialPropertyType::UniformColors;
+  } else if constexpr (std::is_same_v<T, FogParameters>) {
+    return MaterialPropertyType::FogParameters;
+  } else if constexpr (std::is_same_v<T, SampledTexture>) {
+    return MaterialPropertyType::SampledTexture;
+  } else {
+    static_assert(std::is_same_v<T, Matrix4x4f32>,
+                  "not a material property type");
+
+    return MaterialPropertyType::Matrix4x4F32;
+  }
+}
+
 struct MaterialCreateInfo {
   MaterialClassHandle clazz;
   gsl::span<MaterialProperty const> initialValues;
 };
 
+// The values of the properties are packed into one blob in the layout of the
+// class. Properties are looked up in constant time
 class Material {
 public:
+  // the values of the properties are zeroed
   Material(MaterialClassHandle, PipelineHandle, MaterialFeatures,
-           std::vector<MaterialProperty>);
+           MaterialLayout const&);
 
   [[nodiscard]]
   auto features() const -> MaterialFeatures;
   [[nodiscard]]
-  auto properties() const -> gsl::span<MaterialProperty const>;
+  auto layout() const -> MaterialLayout const&;
   [[nodiscard]]
   auto clazz() const -> MaterialClassHandle;
   [[nodiscard]]
   auto pipeline() const -> PipelineHandle;
 
   [[nodiscard]]
-  auto get_value(MaterialPropertyId) const -> std::optional<MaterialPropertyValue>;
-  auto set_value(MaterialPropertyId, MaterialPropertyValue) -> void;
+  auto has(MaterialPropertyId) const -> bool;
+
+  // the property must exist and be of type T
+  template <typename T>
+  [[nodiscard]]
+  auto get(MaterialPropertyId const id) const -> T {
+    auto value = T{};
+    std::memcpy(&value, value_data(id, material_property_type_of<T>()),
+                sizeof(T));
+
+    return value;
+  }
+
+  // the property must exist and be of type T
+  template <typename T>
+  auto set(MaterialPropertyId const id, T const& value) -> void {
+    std::memcpy(value_data(id, material_property_type_of<T>()), &value,
+                sizeof(T));
+  }
+
+  [[nodiscard]]
+  auto get_value(MaterialPropertyId) const
+    -> std::optional<MaterialPropertyValue>;
+  // the property must exist and hold the type of the value
+  auto set_value(MaterialPropertyId, MaterialPropertyValue const&) -> void;
 
 private:
   MaterialClassHandle mClass;
   PipelineHandle mPipeline;
   MaterialFeatures mFeatures;
-  // FIXME: reduce size
-  std::vector<MaterialProperty> mProperties;
+  MaterialLayout mLayout;
+  std::vector<std::byte> mData;
 
-  auto find_property(MaterialPropertyId) const -> std::optional<MaterialProperty const*>;
-  auto find_property(MaterialPropertyId) -> std::optional<MaterialProperty*>;
+  [[nodiscard]]
+  auto value_data(MaterialPropertyId, MaterialPropertyType) const
+    -> std::byte const*;
+  [[nodiscard]]
+  auto value_data(MaterialPropertyId, MaterialPropertyType) -> std::byte*;
 };
 
 } // namespace basalt::gfx
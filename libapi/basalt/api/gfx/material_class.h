@@ -6,11 +6,13 @@
 #include "types.h"
 #include "backend/types.h"
 
+#include <basalt/api/base/enum_array.h>
 #include <basalt/api/base/enum_set.h>
 #include <basalt/api/base/types.h>
 
 #include <gsl/span>
 
+#include <array>
 #include <vector>
 
 namespace basalt::gfx {
@@ -41,6 +43,7 @@ enum class MaterialPropertyId : u8 {
   SampledTexture,
   TexTransform,
 };
+constexpr auto MATERIAL_PROPERTY_ID_COUNT = u8{4};
 
 struct MaterialPropertyInfo {
   MaterialPropertyId id;
@@ -51,6 +54,37 @@ struct MaterialPropertyInfo {
 auto collect_material_properties(MaterialClassCreateInfo const&)
   -> std::vector<MaterialPropertyInfo>;
 
+// Where the values of the properties lie in the data of a material. The values
+// are packed in the order of the properties, each aligned to its type
+class MaterialLayout {
+public:
+  struct Entry {
+    MaterialPropertyId id;
+    MaterialPropertyType type;
+    u16 offset;
+  };
+
+  // every property id must appear at most once
+  explicit MaterialLayout(gsl::span<MaterialPropertyInfo const>);
+
+  [[nodiscard]]
+  auto entries() const noexcept -> gsl::span<Entry const>;
+  // nullptr if absent
+  [[nodiscard]]
+  auto find(MaterialPropertyId) const noexcept -> Entry const*;
+  [[nodiscard]]
+  auto size_in_bytes() const noexcept -> u16;
+
+private:
+  static constexpr auto ABSENT = u8{0xff};
+
+  std::array<Entry, MATERIAL_PROPERTY_ID_COUNT> mEntries{};
+  // index of the entry of each property id
+  EnumArray<MaterialPropertyId, u8, MATERIAL_PROPERTY_ID_COUNT> mIndices;
+  u8 mNumEntries{};
+  u16 mSizeInBytes{};
+};
+
 class MaterialClass {
 public:
   MaterialClass(Pipeline, MaterialFeatures, std::vector<MaterialPropertyInfo>);
@@ -60,6 +94,8 @@ public:
   [[nodiscard]]
   auto properties() const noexcept -> gsl::span<MaterialPropertyInfo const>;
   [[nodiscard]]
+  auto layout() const noexcept -> MaterialLayout const&;
+  [[nodiscard]]
   auto pipeline() const noexcept -> PipelineHandle;
 
 private:
@@ -67,6 +103,7 @@ private:
   // TODO: Input and output requirements
   MaterialFeatures mFeatures;
   std::vector<MaterialPropertyInfo> mProperties;
+  MaterialLayout mLayout;
 };
 
 } // namespace basalt::gfx
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "backend/types.h"
+#include "backend/vertex_layout.h"
 
 #include <basalt/api/base/types.h>
 
@@ -18,6 +19,17 @@ struct MeshCreateInfo {
   u32 indexCount{};
 };
 
+// a mesh with its own vertex and index buffer created from the data
+struct MeshDataCreateInfo {
+  VertexLayoutSpan layout;
+  gsl::span<std::byte const> vertexData;
+  u32 vertexCount{};
+  // without index buffer if empty
+  gsl::span<std::byte const> indexData;
+  u32 indexCount{};
+  IndexType indexType{IndexType::U16};
+};
+
 class Mesh {
 public:
   Mesh(VertexBufferHandle, u32 vertexStart, u32 vertexCount, IndexBufferHandle,
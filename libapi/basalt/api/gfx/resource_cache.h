@@ -10,6 +10,7 @@
 
 #include <cstddef>
 #include <filesystem>
+#include <memory>
 #include <vector>
 
 namespace basalt::gfx {
@@ -75,10 +76,30 @@ public:
   [[nodiscard]]
   auto load_x_meshes(std::filesystem::path const&) -> ext::XModelData;
 
+  // Thread safe, also on the main thread and inside jobs. Copies the data and
+  // returns the handle of the mesh or material right away, which lets loaders
+  // on worker threads build them in parallel. They are created by the next
+  // call to commit_queued. The handles must not be used before.
+  // There is no limit per frame: the first Context::HANDLE_RESERVE_SIZE
+  // handles of each kind after a submit reuse free slots, any further ones
+  // grow the pool. See Context::reserve_mesh
+  [[nodiscard]]
+  auto queue_mesh(MeshDataCreateInfo const&) -> MeshHandle;
+  [[nodiscard]]
+  auto queue_material(MaterialCreateInfo const&) -> MaterialHandle;
+
+  // creates the queued meshes and materials. Call on the main thread, e.g.
+  // once per frame before drawing
+  auto commit_queued() -> void;
+
   auto destroy_all() noexcept -> void;
 
 private:
+  struct CreationQueue;
+
   ContextPtr mContext;
+  // one per thread to keep the threads from contending for one lock
+  std::vector<std::unique_ptr<CreationQueue>> mQueues;
 
   // owned resources
   std::vector<PipelineHandle> mPipelines;
@@ -91,6 +112,8 @@ private:
   std::vector<IndexBufferHandle> mIndexBuffers;
   std::vector<MeshHandle> mMeshes;
   std::vector<ext::XMeshHandle> mXMeshes;
+
+  auto queue_of_this_thread() -> CreationQueue&;
 };
 
 } // namespace basalt::gfx
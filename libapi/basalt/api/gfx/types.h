@@ -3,15 +3,20 @@
 #include "backend/types.h"
 #include "backend/ext/types.h"
 
+#include <basalt/api/scene/types.h>
+
 #include <basalt/api/shared/color.h>
 #include <basalt/api/shared/handle.h>
 #include <basalt/api/shared/unique_handle.h>
 #include <basalt/api/shared/types.h>
 
+#include <basalt/api/math/aabb.h>
 #include <basalt/api/math/angle.h>
+#include <basalt/api/math/vector3.h>
 
 #include <basalt/api/base/types.h>
 
+#include <array>
 #include <memory>
 #include <variant>
 
@@ -85,6 +90,7 @@ using UniqueMaterialClass =
 
 class Mesh;
 struct MeshCreateInfo;
+struct MeshDataCreateInfo;
 BASALT_DEFINE_HANDLE(MeshHandle);
 using UniqueMesh = UniqueHandle<MeshHandle, ContextResourceDeleter>;
 
@@ -93,6 +99,36 @@ struct Model {
   MaterialHandle material;
 };
 
+// Marks an entity as an occluder for the occlusion culling of the GfxSystem.
+// The box is specified in the local space of the entity and must be fully
+// covered by the rendered geometry of the entity
+struct Occluder {
+  Aabb box;
+};
+
+struct OcclusionCulling;
+
+// A convex region of an indoor level for the portal culling of the GfxSystem.
+// The box is specified in world space
+struct Cell {
+  Aabb box;
+};
+
+// Connects two cells and can be looked through from both of them. The corners
+// of the quad are specified in world space in winding order
+struct Portal {
+  EntityId cell1;
+  EntityId cell2;
+  std::array<Vector3f32, 4> corners;
+};
+
+// Entities without a CellMember component are never portal culled
+struct CellMember {
+  EntityId cell;
+};
+
+struct PortalCulling;
+
 namespace ext {
 
 struct XModel {
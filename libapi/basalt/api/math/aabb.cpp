@@ -0,0 +1,46 @@
+#include <basalt/api/math/aabb.h>
+
+#include <basalt/api/math/affine3x4.h>
+#include <basalt/api/math/matrix4.h>
+
+#include <cmath>
+
+namespace basalt {
+
+namespace {
+
+// Arvo, "Transforming Axis-Aligned Bounding Boxes", Graphics Gems (1990)
+template <typename Matrix>
+auto transformed(Aabb const& box, Matrix const& m) -> Aabb {
+  auto const c = box.center();
+  auto const e = box.half_extents();
+
+  auto const newCenter = Vector3f32{
+    c.x() * m.m11() + c.y() * m.m21() + c.z() * m.m31() + m.m41(),
+    c.x() * m.m12() + c.y() * m.m22() + c.z() * m.m32() + m.m42(),
+    c.x() * m.m13() + c.y() * m.m23() + c.z() * m.m33() + m.m43(),
+  };
+
+  auto const newHalfExtents = Vector3f32{
+    e.x() * std::abs(m.m11()) + e.y() * std::abs(m.m21()) +
+      e.z() * std::abs(m.m31()),
+    e.x() * std::abs(m.m12()) + e.y() * std::abs(m.m22()) +
+      e.z() * std::abs(m.m32()),
+    e.x() * std::abs(m.m13()) + e.y() * std::abs(m.m23()) +
+      e.z() * std::abs(m.m33()),
+  };
+
+  return Aabb::from_center_half_extents(newCenter, newHalfExtents);
+}
+
+} // namespace
+
+auto Aabb::transformed(Matrix4x4f32 const& m) const -> Aabb {
+  return basalt::transformed(*this, m);
+}
+
+auto Aabb::transformed(Affine3x4f32 const& m) const -> Aabb {
+  return basalt::transformed(*this, m);
+}
+
+} // namespace basalt
@@ -0,0 +1,137 @@
+#pragma once
+
+#include "types.h"
+#include "vector3.h"
+
+#include <basalt/api/base/types.h>
+
+#include <algorithm>
+#include <array>
+
+namespace basalt {
+
+// axis-aligned bounding box
+class Aabb final {
+public:
+  [[nodiscard]]
+  static constexpr auto from_min_max(Vector3f32 const& min,
+                                     Vector3f32 const& max) -> Aabb {
+    return Aabb{min, max};
+  }
+
+  [[nodiscard]]
+  static constexpr auto from_center_half_extents(Vector3f32 const& center,
+                                                 Vector3f32 const& halfExtents)
+    -> Aabb {
+    return Aabb{center - halfExtents, center + halfExtents};
+  }
+
+  // smallest box containing both boxes
+  [[nodiscard]]
+  static constexpr auto merged(Aabb const& a, Aabb const& b) -> Aabb {
+    return Aabb{
+      Vector3f32{std::min(a.mMin.x(), b.mMin.x()),
+                 std::min(a.mMin.y(), b.mMin.y()),
+                 std::min(a.mMin.z(), b.mMin.z())},
+      Vector3f32{std::max(a.mMax.x(), b.mMax.x()),
+                 std::max(a.mMax.y(), b.mMax.y()),
+                 std::max(a.mMax.z(), b.mMax.z())},
+    };
+  }
+
+  // unit cube centered at the origin
+  constexpr Aabb() = default;
+
+  [[nodiscard]] constexpr auto operator==(Aabb const& rhs) const -> bool {
+    return mMin == rhs.mMin && mMax == rhs.mMax;
+  }
+
+  [[nodiscard]] constexpr auto operator!=(Aabb const& rhs) const -> bool {
+    return !(*this == rhs);
+  }
+
+  [[nodiscard]]
+  constexpr auto min() const -> Vector3f32 const& {
+    return mMin;
+  }
+
+  [[nodiscard]]
+  constexpr auto max() const -> Vector3f32 const& {
+    return mMax;
+  }
+
+  [[nodiscard]]
+  constexpr auto center() const -> Vector3f32 {
+    return (mMin + mMax) * 0.5f;
+  }
+
+  [[nodiscard]]
+  constexpr auto half_extents() const -> Vector3f32 {
+    return (mMax - mMin) * 0.5f;
+  }
+
+  [[nodiscard]]
+  constexpr auto surface_area() const -> f32 {
+    auto const size = mMax - mMin;
+
+    return 2.0f *
+           (size.x() * size.y() + size.y() * size.z() + size.z() * size.x());
+  }
+
+  // 0-7: bit 0 selects max x, bit 1 max y and bit 2 max z
+  [[nodiscard]]
+  constexpr auto corner(uSize const idx) const -> Vector3f32 {
+    return Vector3f32{idx & 0x1 ? mMax.x() : mMin.x(),
+                      idx & 0x2 ? mMax.y() : mMin.y(),
+                      idx & 0x4 ? mMax.z() : mMin.z()};
+  }
+
+  [[nodiscard]]
+  constexpr auto corners() const -> std::array<Vector3f32, 8> {
+    return std::array{corner(0), corner(1), corner(2), corner(3),
+                      corner(4), corner(5), corner(6), corner(7)};
+  }
+
+  [[nodiscard]]
+  constexpr auto contains(Vector3f32 const& p) const -> bool {
+    return p.x() >= mMin.x() && p.x() <= mMax.x() && p.y() >= mMin.y() &&
+           p.y() <= mMax.y() && p.z() >= mMin.z() && p.z() <= mMax.z();
+  }
+
+  [[nodiscard]]
+  constexpr auto contains(Aabb const& o) const -> bool {
+    return o.mMin.x() >= mMin.x() && o.mMax.x() <= mMax.x() &&
+           o.mMin.y() >= mMin.y() && o.mMax.y() <= mMax.y() &&
+           o.mMin.z() >= mMin.z() && o.mMax.z() <= mMax.z();
+  }
+
+  [[nodiscard]]
+  constexpr auto intersects(Aabb const& o) const -> bool {
+    return mMin.x() <= o.mMax.x() && mMax.x() >= o.mMin.x() &&
+           mMin.y() <= o.mMax.y() && mMax.y() >= o.mMin.y() &&
+           mMin.z() <= o.mMax.z() && mMax.z() >= o.mMin.z();
+  }
+
+  // grows the box by margin in every direction
+  [[nodiscard]]
+  constexpr auto expanded(f32 const margin) const -> Aabb {
+    return Aabb{mMin - Vector3f32{margin}, mMax + Vector3f32{margin}};
+  }
+
+  // bounding box of this box after transforming it with m
+  [[nodiscard]]
+  auto transformed(Matrix4x4f32 const& m) const -> Aabb;
+  [[nodiscard]]
+  auto transformed(Affine3x4f32 const& m) const -> Aabb;
+
+private:
+  Vector3f32 mMin{-0.5f};
+  Vector3f32 mMax{0.5f};
+
+  constexpr Aabb(Vector3f32 const& min, Vector3f32 const& max)
+    : mMin{min}
+    , mMax{max} {
+  }
+};
+
+} // namespace basalt
@@ -0,0 +1,32 @@
+#include "affine3x4.h"
+
+namespace basalt {
+
+// Treats the stored columns as the rows of a 3x4 matrix [M | t] for column
+// vectors, whose inverse is [M^-1 | -M^-1 t]. The columns of M^-1 are the
+// cross products of the rows of M divided by its determinant
+auto Affine3x4f32::inverse(Affine3x4f32 const& a) -> Affine3x4f32 {
+  auto const r1 = Vector3f32{a.m11(), a.m21(), a.m31()};
+  auto const r2 = Vector3f32{a.m12(), a.m22(), a.m32()};
+  auto const r3 = Vector3f32{a.m13(), a.m23(), a.m33()};
+  auto const t = a.translation();
+
+  auto const c1 = Vector3f32::cross(r2, r3);
+  auto const invDet = 1.0f / r1.dot(c1);
+  auto const i1 = c1 * invDet;
+  auto const i2 = Vector3f32::cross(r3, r1) * invDet;
+  auto const i3 = Vector3f32::cross(r1, r2) * invDet;
+
+  // row j of M^-1 is (i1[j], i2[j], i3[j])
+  // clang-format off
+  return Affine3x4f32{
+    i1.x(), i1.y(), i1.z(),
+    i2.x(), i2.y(), i2.z(),
+    i3.x(), i3.y(), i3.z(),
+    -(i1.x() * t.x() + i2.x() * t.y() + i3.x() * t.z()),
+    -(i1.y() * t.x() + i2.y() * t.y() + i3.y() * t.z()),
+    -(i1.z() * t.x() + i2.z() * t.y() + i3.z() * t.z())};
+  // clang-format on
+}
+
+} // namespace basalt
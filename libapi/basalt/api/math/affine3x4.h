@@ -0,0 +1,228 @@
+#pragma once
+
+#include "matrix4.h"
+#include "simd_p.h"
+#include "types.h"
+#include "vector3.h"
+
+#include <basalt/api/base/types.h>
+
+#include <array>
+
+namespace basalt {
+
+// 4x4 matrix whose last column is (0, 0, 0, 1), i.e. a linear transformation
+// in the upper 3x3 matrix followed by the translation in the last row. Only
+// the first three columns are stored, each as (m1j, m2j, m3j, m4j). That's 48
+// instead of 64 bytes and a multiplication needs 36 instead of 64 products.
+// Accessors and operators behave like the ones of the full 4x4 matrix
+class Affine3x4f32 final {
+public:
+  [[nodiscard]]
+  static constexpr auto identity() -> Affine3x4f32 {
+    // clang-format off
+    return Affine3x4f32{1.0f, 0.0f, 0.0f,
+                        0.0f, 1.0f, 0.0f,
+                        0.0f, 0.0f, 1.0f,
+                        0.0f, 0.0f, 0.0f};
+    // clang-format on
+  }
+
+  [[nodiscard]]
+  static constexpr auto translation(Vector3f32 const& t) -> Affine3x4f32 {
+    // clang-format off
+    return Affine3x4f32{ 1.0f,  0.0f,  0.0f,
+                         0.0f,  1.0f,  0.0f,
+                         0.0f,  0.0f,  1.0f,
+                        t.x(), t.y(), t.z()};
+    // clang-format on
+  }
+
+  // the last column of m is dropped and must be (0, 0, 0, 1)
+  [[nodiscard]]
+  static constexpr auto from_matrix(Matrix4x4f32 const& m) -> Affine3x4f32 {
+    // clang-format off
+    return Affine3x4f32{m.m11(), m.m12(), m.m13(),
+                        m.m21(), m.m22(), m.m23(),
+                        m.m31(), m.m32(), m.m33(),
+                        m.m41(), m.m42(), m.m43()};
+    // clang-format on
+  }
+
+  // a must be invertible
+  [[nodiscard]]
+  static auto inverse(Affine3x4f32 const& a) -> Affine3x4f32;
+
+  constexpr Affine3x4f32() = default;
+
+  // the elements of the 4x4 matrix without the last column
+  // clang-format off
+  constexpr Affine3x4f32(
+    f32 const m11, f32 const m12, f32 const m13,
+    f32 const m21, f32 const m22, f32 const m23,
+    f32 const m31, f32 const m32, f32 const m33,
+    f32 const m41, f32 const m42, f32 const m43)
+    : mColumns{m11, m21, m31, m41,
+               m12, m22, m32, m42,
+               m13, m23, m33, m43} {
+  }
+
+  // clang-format on
+
+  [[nodiscard]]
+  constexpr auto to_matrix() const -> Matrix4x4f32 {
+    auto result = Matrix4x4f32{};
+    if constexpr (detail::simd::HAS_4X4_F32) {
+      if (!detail::simd::is_constant_evaluated()) {
+        detail::simd::affine_3x4_to_4x4(mColumns.data(), &result.m11());
+
+        return result;
+      }
+    }
+
+    // clang-format off
+    return Matrix4x4f32{m11(), m12(), m13(), 0.0f,
+                        m21(), m22(), m23(), 0.0f,
+                        m31(), m32(), m33(), 0.0f,
+                        m41(), m42(), m43(), 1.0f};
+    // clang-format on
+  }
+
+  [[nodiscard]]
+  constexpr auto translation() const -> Vector3f32 {
+    return Vector3f32{m41(), m42(), m43()};
+  }
+
+  // p * this with w = 1
+  [[nodiscard]]
+  constexpr auto transform_point(Vector3f32 const& p) const -> Vector3f32 {
+    return Vector3f32{
+      p.x() * m11() + p.y() * m21() + p.z() * m31() + m41(),
+      p.x() * m12() + p.y() * m22() + p.z() * m32() + m42(),
+      p.x() * m13() + p.y() * m23() + p.z() * m33() + m43(),
+    };
+  }
+
+  // d * this with w = 0
+  [[nodiscard]]
+  constexpr auto transform_direction(Vector3f32 const& d) const -> Vector3f32 {
+    return Vector3f32{
+      d.x() * m11() + d.y() * m21() + d.z() * m31(),
+      d.x() * m12() + d.y() * m22() + d.z() * m32(),
+      d.x() * m13() + d.y() * m23() + d.z() * m33(),
+    };
+  }
+
+  [[nodiscard]]
+  friend constexpr auto operator*(Affine3x4f32 const& l, Affine3x4f32 const& r)
+    -> Affine3x4f32 {
+    auto result = Affine3x4f32{};
+    if constexpr (detail::simd::HAS_4X4_F32) {
+      if (!detail::simd::is_constant_evaluated()) {
+        detail::simd::mul_affine_3x4(l.mColumns.data(), r.mColumns.data(),
+                                     result.mColumns.data());
+
+        return result;
+      }
+    }
+
+    // same order of the sums as the SSE kernel
+    for (auto j = uSize{0}; j < 3; ++j) {
+      for (auto i = uSize{0}; i < 4; ++i) {
+        result.mColumns[4 * j + i] =
+          l.mColumns[i] * r.mColumns[4 * j] +
+          l.mColumns[4 + i] * r.mColumns[4 * j + 1] +
+          l.mColumns[8 + i] * r.mColumns[4 * j + 2] +
+          (i == 3 ? r.mColumns[4 * j + 3] : 0.0f);
+      }
+    }
+
+    return result;
+  }
+
+  [[nodiscard]]
+  constexpr auto operator==(Affine3x4f32 const& r) const -> bool {
+    return mColumns == r.mColumns;
+  }
+
+  [[nodiscard]]
+  constexpr auto operator!=(Affine3x4f32 const& r) const -> bool {
+    return !(*this == r);
+  }
+
+  [[nodiscard]]
+  constexpr auto m11() const -> f32 {
+    return mColumns[0];
+  }
+
+  [[nodiscard]]
+  constexpr auto m12() const -> f32 {
+    return mColumns[4];
+  }
+
+  [[nodiscard]]
+  constexpr auto m13() const -> f32 {
+    return mColumns[8];
+  }
+
+  [[nodiscard]]
+  constexpr auto m21() const -> f32 {
+    return mColumns[1];
+  }
+
+  [[nodiscard]]
+  constexpr auto m22() const -> f32 {
+    return mColumns[5];
+  }
+
+  [[nodiscard]]
+  constexpr auto m23() const -> f32 {
+    return mColumns[9];
+  }
+
+  [[nodiscard]]
+  constexpr auto m31() const -> f32 {
+    return mColumns[2];
+  }
+
+  [[nodiscard]]
+  constexpr auto m32() const -> f32 {
+    return mColumns[6];
+  }
+
+  [[nodiscard]]
+  constexpr auto m33() const -> f32 {
+    return mColumns[10];
+  }
+
+  [[nodiscard]]
+  constexpr auto m41() const -> f32 {
+    return mColumns[3];
+  }
+
+  [[nodiscard]]
+  constexpr auto m42() const -> f32 {
+    return mColumns[7];
+  }
+
+  [[nodiscard]]
+  constexpr auto m43() const -> f32 {
+    return mColumns[11];
+  }
+
+  // the stored columns, e.g. for SIMD code
+  [[nodiscard]]
+  constexpr auto data() const -> f32 const* {
+    return mColumns.data();
+  }
+
+  [[nodiscard]]
+  constexpr auto data() -> f32* {
+    return mColumns.data();
+  }
+
+private:
+  std::array<f32, 12> mColumns{};
+};
+
+} // namespace basalt
@@ -40,6 +40,41 @@ auto Angle::tan() const noexcept -> f32 {
   return std::tan(mRadians);
 }
 
+auto Angle::sincos() const noexcept -> SinCos {
+  // the angle is in [-pi, pi). Mirror it into [-pi/2, pi/2], which keeps the
+  // sine and flips the sign of the cosine
+  auto x = mRadians;
+  auto cosSign = 1.0f;
+  if (x > 0.5f * PI) {
+    x = PI - x;
+    cosSign = -1.0f;
+  } else if (x < -0.5f * PI) {
+    x = -PI - x;
+    cosSign = -1.0f;
+  }
+
+  // Taylor series up to x^11 and x^12. The error of the remainder is below
+  // 1e-7 in [-pi/2, pi/2]
+  auto const x2 = x * x;
+  auto const sin =
+    x * (1.0f +
+         x2 * (-1.0f / 6.0f +
+               x2 * (1.0f / 120.0f +
+                     x2 * (-1.0f / 5040.0f +
+                           x2 * (1.0f / 362880.0f +
+                                 x2 * (-1.0f / 39916800.0f))))));
+  auto const cos =
+    1.0f +
+    x2 * (-0.5f +
+          x2 * (1.0f / 24.0f +
+                x2 * (-1.0f / 720.0f +
+                      x2 * (1.0f / 40320.0f +
+                            x2 * (-1.0f / 3628800.0f +
+                                  x2 * (1.0f / 479001600.0f))))));
+
+  return SinCos{sin, cosSign * cos};
+}
+
 auto Angle::operator+=(Angle const rhs) noexcept -> Angle& {
   mRadians += rhs.mRadians;
   normalize();
@@ -25,6 +25,11 @@ public:
   [[nodiscard]]
   static auto arctan(f32 tan) noexcept -> Angle;
 
+  struct SinCos final {
+    f32 sin;
+    f32 cos;
+  };
+
   constexpr Angle() noexcept = default;
 
   [[nodiscard]]
@@ -46,6 +51,11 @@ public:
   [[nodiscard]]
   auto tan() const noexcept -> f32;
 
+  // Both at once with one range reduction and two polynomials. Cheaper than
+  // sin() and cos(), but may differ from them in the last bits
+  [[nodiscard]]
+  auto sincos() const noexcept -> SinCos;
+
   auto operator+=(Angle rhs) noexcept -> Angle&;
   [[nodiscard]] friend auto operator+(Angle lhs, Angle rhs) noexcept -> Angle;
 
@@ -0,0 +1,432 @@
+#include "batch.h"
+
+#include "aabb.h"
+#include "affine3x4.h"
+#include "angle.h"
+#include "constants.h"
+#include "matrix4.h"
+#include "simd_p.h"
+#include "vector3.h"
+
+#include <basalt/api/base/asserts.h>
+
+#include <array>
+#include <cmath>
+
+namespace basalt::batch {
+
+namespace {
+
+// Matrix3x3f32::rotation (y * x * z) with the products of zero left out,
+// scaled and translated like Transform::to_matrix
+auto compose_transform(f32 const px, f32 const py, f32 const pz,
+                       f32 const rx, f32 const ry, f32 const rz,
+                       f32 const sx, f32 const sy, f32 const sz)
+  -> Matrix4x4f32 {
+  auto const [sinX, cosX] = Angle::radians(rx).sincos();
+  auto const [sinY, cosY] = Angle::radians(ry).sincos();
+  auto const [sinZ, cosZ] = Angle::radians(rz).sincos();
+  auto const sinYSinX = sinY * sinX;
+  auto const cosYSinX = cosY * sinX;
+
+  // clang-format off
+  return Matrix4x4f32{
+    sx * (cosY * cosZ - sinYSinX * sinZ),
+    sx * (cosY * sinZ + sinYSinX * cosZ),
+    sx * -(sinY * cosX),
+    0.0f,
+    sy * -(cosX * sinZ), sy * (cosX * cosZ), sy * sinX, 0.0f,
+    sz * (sinY * cosZ + cosYSinX * sinZ),
+    sz * (sinY * sinZ - cosYSinX * cosZ),
+    sz * (cosY * cosX),
+    0.0f,
+    px, py, pz, 1.0f};
+  // clang-format on
+}
+
+#if BASALT_MATH_SSE
+// Angle::radians(radians[lane]).sincos() for all four lanes, with the same
+// operations in the same order
+auto sincos_lanes(f32 const* const radians, __m128& sin, __m128& cos) -> void {
+  constexpr auto twoPi = f32{2.0f * PI};
+
+  auto const pi = _mm_set1_ps(PI);
+  auto const zero = _mm_setzero_ps();
+
+  // Angle::normalize. fmod doesn't change values below 2 pi, which is the
+  // common case of angles kept normalized by Transform::rotate
+  auto x = _mm_add_ps(_mm_loadu_ps(radians), pi);
+  auto const absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+  if (_mm_movemask_ps(
+        _mm_cmpge_ps(_mm_and_ps(x, absMask), _mm_set1_ps(twoPi))) == 0) {
+    auto const isNegative = _mm_cmplt_ps(x, zero);
+    x = _mm_add_ps(x, _mm_and_ps(isNegative, _mm_set1_ps(twoPi)));
+    x = _mm_sub_ps(x, pi);
+  } else {
+    alignas(16) auto normalized = std::array<f32, 4>{};
+    for (auto lane = uSize{0}; lane < 4; ++lane) {
+      normalized[lane] = Angle::radians(radians[lane]).radians();
+    }
+    x = _mm_load_ps(normalized.data());
+  }
+
+  // mirror into [-pi/2, pi/2]
+  auto const isAbove = _mm_cmpgt_ps(x, _mm_set1_ps(0.5f * PI));
+  auto const isBelow = _mm_cmplt_ps(x, _mm_set1_ps(-0.5f * PI));
+  auto const mirrored =
+    _mm_or_ps(_mm_and_ps(isAbove, _mm_sub_ps(pi, x)),
+              _mm_and_ps(isBelow, _mm_sub_ps(_mm_set1_ps(-PI), x)));
+  auto const isMirrored = _mm_or_ps(isAbove, isBelow);
+  x = _mm_or_ps(mirrored, _mm_andnot_ps(isMirrored, x));
+  auto const cosSign = _mm_or_ps(_mm_and_ps(isMirrored, _mm_set1_ps(-1.0f)),
+                                 _mm_andnot_ps(isMirrored, _mm_set1_ps(1.0f)));
+
+  auto const horner = [](__m128 const x2, __m128 const acc, f32 const c) {
+    return _mm_add_ps(_mm_set1_ps(c), _mm_mul_ps(x2, acc));
+  };
+
+  auto const x2 = _mm_mul_ps(x, x);
+  auto s = _mm_set1_ps(-1.0f / 39916800.0f);
+  s = horner(x2, s, 1.0f / 362880.0f);
+  s = horner(x2, s, -1.0f / 5040.0f);
+  s = horner(x2, s, 1.0f / 120.0f);
+  s = horner(x2, s, -1.0f / 6.0f);
+  s = horner(x2, s, 1.0f);
+  sin = _mm_mul_ps(x, s);
+
+  auto c = _mm_set1_ps(1.0f / 479001600.0f);
+  c = horner(x2, c, -1.0f / 3628800.0f);
+  c = horner(x2, c, 1.0f / 40320.0f);
+  c = horner(x2, c, -1.0f / 720.0f);
+  c = horner(x2, c, 1.0f / 24.0f);
+  c = horner(x2, c, -0.5f);
+  c = horner(x2, c, 1.0f);
+  cos = _mm_mul_ps(cosSign, c);
+}
+
+// the elements of four composed transforms. One register per element, one
+// lane per transform
+struct ComposedLanes final {
+  __m128 m11, m12, m13;
+  __m128 m21, m22, m23;
+  __m128 m31, m32, m33;
+  __m128 m41, m42, m43;
+};
+
+auto compose_lanes(ConstVectors3f32 const& positions,
+                   ConstVectors3f32 const& rotations,
+                   ConstVectors3f32 const& scales, uSize const i)
+  -> ComposedLanes {
+  auto const negate = [](__m128 const v) {
+    return _mm_xor_ps(v, _mm_set1_ps(-0.0f));
+  };
+
+  auto sinX = __m128{};
+  auto cosX = __m128{};
+  auto sinY = __m128{};
+  auto cosY = __m128{};
+  auto sinZ = __m128{};
+  auto cosZ = __m128{};
+  sincos_lanes(&rotations.x()[i], sinX, cosX);
+  sincos_lanes(&rotations.y()[i], sinY, cosY);
+  sincos_lanes(&rotations.z()[i], sinZ, cosZ);
+  auto const sinYSinX = _mm_mul_ps(sinY, sinX);
+  auto const cosYSinX = _mm_mul_ps(cosY, sinX);
+
+  auto const scaleX = _mm_loadu_ps(&scales.x()[i]);
+  auto const scaleY = _mm_loadu_ps(&scales.y()[i]);
+  auto const scaleZ = _mm_loadu_ps(&scales.z()[i]);
+
+  return ComposedLanes{
+    _mm_mul_ps(scaleX, _mm_sub_ps(_mm_mul_ps(cosY, cosZ),
+                                  _mm_mul_ps(sinYSinX, sinZ))),
+    _mm_mul_ps(scaleX, _mm_add_ps(_mm_mul_ps(cosY, sinZ),
+                                  _mm_mul_ps(sinYSinX, cosZ))),
+    _mm_mul_ps(scaleX, negate(_mm_mul_ps(sinY, cosX))),
+    _mm_mul_ps(scaleY, negate(_mm_mul_ps(cosX, sinZ))),
+    _mm_mul_ps(scaleY, _mm_mul_ps(cosX, cosZ)),
+    _mm_mul_ps(scaleY, sinX),
+    _mm_mul_ps(scaleZ, _mm_add_ps(_mm_mul_ps(sinY, cosZ),
+                                  _mm_mul_ps(cosYSinX, sinZ))),
+    _mm_mul_ps(scaleZ, _mm_sub_ps(_mm_mul_ps(sinY, sinZ),
+                                  _mm_mul_ps(cosYSinX, cosZ))),
+    _mm_mul_ps(scaleZ, _mm_mul_ps(cosY, cosX)),
+    _mm_loadu_ps(&positions.x()[i]),
+    _mm_loadu_ps(&positions.y()[i]),
+    _mm_loadu_ps(&positions.z()[i]),
+  };
+}
+#endif // BASALT_MATH_SSE
+
+} // namespace
+
+auto compose_transforms(ConstVectors3f32 const positions,
+                        ConstVectors3f32 const rotations,
+                        ConstVectors3f32 const scales,
+                        gsl::span<Matrix4x4f32> const out) -> void {
+  auto const count = out.size();
+  BASALT_ASSERT(positions.size() == count && rotations.size() == count &&
+                scales.size() == count);
+
+  auto i = uSize{0};
+
+#if BASALT_MATH_SSE
+  for (; i + 4 <= count; i += 4) {
+    auto [m11, m12, m13, m21, m22, m23, m31, m32, m33, m41, m42, m43] =
+      compose_lanes(positions, rotations, scales, i);
+    auto m14 = _mm_setzero_ps();
+    auto m24 = _mm_setzero_ps();
+    auto m34 = _mm_setzero_ps();
+    auto m44 = _mm_set1_ps(1.0f);
+
+    // to one register per row of every matrix
+    _MM_TRANSPOSE4_PS(m11, m12, m13, m14);
+    _MM_TRANSPOSE4_PS(m21, m22, m23, m24);
+    _MM_TRANSPOSE4_PS(m31, m32, m33, m34);
+    _MM_TRANSPOSE4_PS(m41, m42, m43, m44);
+
+    auto const store = [&](uSize const lane, __m128 const r1, __m128 const r2,
+                           __m128 const r3, __m128 const r4) {
+      auto* const m = &out[i + lane].m11();
+      _mm_storeu_ps(m, r1);
+      _mm_storeu_ps(m + 4, r2);
+      _mm_storeu_ps(m + 8, r3);
+      _mm_storeu_ps(m + 12, r4);
+    };
+    store(0, m11, m21, m31, m41);
+    store(1, m12, m22, m32, m42);
+    store(2, m13, m23, m33, m43);
+    store(3, m14, m24, m34, m44);
+  }
+#endif // BASALT_MATH_SSE
+
+  for (; i < count; ++i) {
+    out[i] = compose_transform(positions.x()[i], positions.y()[i],
+                               positions.z()[i], rotations.x()[i],
+                               rotations.y()[i], rotations.z()[i],
+                               scales.x()[i], scales.y()[i], scales.z()[i]);
+  }
+}
+
+auto compose_transforms(ConstVectors3f32 const positions,
+                        ConstVectors3f32 const rotations,
+                        ConstVectors3f32 const scales,
+                        gsl::span<Affine3x4f32> const out) -> void {
+  auto const count = out.size();
+  BASALT_ASSERT(positions.size() == count && rotations.size() == count &&
+                scales.size() == count);
+
+  auto i = uSize{0};
+
+#if BASALT_MATH_SSE
+  for (; i + 4 <= count; i += 4) {
+    auto [m11, m12, m13, m21, m22, m23, m31, m32, m33, m41, m42, m43] =
+      compose_lanes(positions, rotations, scales, i);
+
+    // to one register per stored column of every matrix. Unlike the 4x4
+    // matrix there is no padding to transpose
+    _MM_TRANSPOSE4_PS(m11, m21, m31, m41);
+    _MM_TRANSPOSE4_PS(m12, m22, m32, m42);
+    _MM_TRANSPOSE4_PS(m13, m23, m33, m43);
+
+    auto const store = [&](uSize const lane, __m128 const c1, __m128 const c2,
+                           __m128 const c3) {
+      auto* const m = out[i + lane].data();
+      _mm_storeu_ps(m, c1);
+      _mm_storeu_ps(m + 4, c2);
+      _mm_storeu_ps(m + 8, c3);
+    };
+    store(0, m11, m12, m13);
+    store(1, m21, m22, m23);
+    store(2, m31, m32, m33);
+    store(3, m41, m42, m43);
+  }
+#endif // BASALT_MATH_SSE
+
+  for (; i < count; ++i) {
+    out[i] = Affine3x4f32::from_matrix(compose_transform(
+      positions.x()[i], positions.y()[i], positions.z()[i], rotations.x()[i],
+      rotations.y()[i], rotations.z()[i], scales.x()[i], scales.y()[i],
+      scales.z()[i]));
+  }
+}
+
+auto multiply(gsl::span<Matrix4x4f32 const> const matrices,
+              Matrix4x4f32 const& parent, gsl::span<Matrix4x4f32> const out)
+  -> void {
+  BASALT_ASSERT(matrices.size() == out.size());
+
+#if BASALT_MATH_SSE
+  // the rows of the parent stay in registers
+  auto const* const p = &parent.m11();
+  auto const p1 = _mm_loadu_ps(p);
+  auto const p2 = _mm_loadu_ps(p + 4);
+  auto const p3 = _mm_loadu_ps(p + 8);
+  auto const p4 = _mm_loadu_ps(p + 12);
+
+  for (auto i = uSize{0}; i < matrices.size(); ++i) {
+    auto const* const m = &matrices[i].m11();
+    auto const row = [&](uSize const index) {
+      auto const* const l = m + 4 * index;
+      auto r = _mm_mul_ps(_mm_set1_ps(l[0]), p1);
+      r = _mm_add_ps(r, _mm_mul_ps(_mm_set1_ps(l[1]), p2));
+      r = _mm_add_ps(r, _mm_mul_ps(_mm_set1_ps(l[2]), p3));
+      return _mm_add_ps(r, _mm_mul_ps(_mm_set1_ps(l[3]), p4));
+    };
+    auto const r1 = row(0);
+    auto const r2 = row(1);
+    auto const r3 = row(2);
+    auto const r4 = row(3);
+
+    // stored after all rows are computed, because out may be matrices
+    auto* const result = &out[i].m11();
+    _mm_storeu_ps(result, r1);
+    _mm_storeu_ps(result + 4, r2);
+    _mm_storeu_ps(result + 8, r3);
+    _mm_storeu_ps(result + 12, r4);
+  }
+#else
+  for (auto i = uSize{0}; i < matrices.size(); ++i) {
+    out[i] = matrices[i] * parent;
+  }
+#endif // BASALT_MATH_SSE
+}
+
+auto multiply(gsl::span<Matrix4x4f32 const> const matrices,
+              gsl::span<Matrix4x4f32 const> const parents,
+              gsl::span<Matrix4x4f32> const out) -> void {
+  BASALT_ASSERT(matrices.size() == out.size() &&
+                parents.size() == out.size());
+
+  for (auto i = uSize{0}; i < matrices.size(); ++i) {
+    out[i] = matrices[i] * parents[i];
+  }
+}
+
+auto transform_points(ConstVectors3f32 const points, Matrix4x4f32 const& m,
+                      Vectors3f32 const out) -> void {
+  auto const count = points.size();
+  BASALT_ASSERT(out.size() == count);
+
+  auto i = uSize{0};
+
+#if BASALT_MATH_SSE
+  auto const m11 = _mm_set1_ps(m.m11());
+  auto const m12 = _mm_set1_ps(m.m12());
+  auto const m13 = _mm_set1_ps(m.m13());
+  auto const m21 = _mm_set1_ps(m.m21());
+  auto const m22 = _mm_set1_ps(m.m22());
+  auto const m23 = _mm_set1_ps(m.m23());
+  auto const m31 = _mm_set1_ps(m.m31());
+  auto const m32 = _mm_set1_ps(m.m32());
+  auto const m33 = _mm_set1_ps(m.m33());
+  auto const m41 = _mm_set1_ps(m.m41());
+  auto const m42 = _mm_set1_ps(m.m42());
+  auto const m43 = _mm_set1_ps(m.m43());
+
+  for (; i + 4 <= count; i += 4) {
+    auto const x = _mm_loadu_ps(&points.x()[i]);
+    auto const y = _mm_loadu_ps(&points.y()[i]);
+    auto const z = _mm_loadu_ps(&points.z()[i]);
+
+    auto const column = [&](__m128 const c1, __m128 const c2, __m128 const c3,
+                            __m128 const c4) {
+      return _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, c1),
+                                              _mm_mul_ps(y, c2)),
+                                   _mm_mul_ps(z, c3)),
+                        c4);
+    };
+    _mm_storeu_ps(&out.x()[i], column(m11, m21, m31, m41));
+    _mm_storeu_ps(&out.y()[i], column(m12, m22, m32, m42));
+    _mm_storeu_ps(&out.z()[i], column(m13, m23, m33, m43));
+  }
+#endif // BASALT_MATH_SSE
+
+  for (; i < count; ++i) {
+    auto const x = points.x()[i];
+    auto const y = points.y()[i];
+    auto const z = points.z()[i];
+    out.x()[i] = x * m.m11() + y * m.m21() + z * m.m31() + m.m41();
+    out.y()[i] = x * m.m12() + y * m.m22() + z * m.m32() + m.m42();
+    out.z()[i] = x * m.m13() + y * m.m23() + z * m.m33() + m.m43();
+  }
+}
+
+auto transform_boxes(gsl::span<Aabb const> const boxes,
+                     gsl::span<Matrix4x4f32 const> const matrices,
+                     gsl::span<Aabb> const out) -> void {
+  BASALT_ASSERT(boxes.size() == out.size() && matrices.size() == out.size());
+
+#if BASALT_MATH_SSE
+  // every box is transformed as one (x, y, z, w) vector. Same products and sums
+  // as Aabb::transformed
+  auto const absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+
+  for (auto i = uSize{0}; i < boxes.size(); ++i) {
+    auto const* const m = &matrices[i].m11();
+    auto const r1 = _mm_loadu_ps(m);
+    auto const r2 = _mm_loadu_ps(m + 4);
+    auto const r3 = _mm_loadu_ps(m + 8);
+    auto const r4 = _mm_loadu_ps(m + 12);
+
+    auto const c = boxes[i].center();
+    auto const e = boxes[i].half_extents();
+
+    auto center = _mm_mul_ps(_mm_set1_ps(c.x()), r1);
+    center = _mm_add_ps(center, _mm_mul_ps(_mm_set1_ps(c.y()), r2));
+    center = _mm_add_ps(center, _mm_mul_ps(_mm_set1_ps(c.z()), r3));
+    center = _mm_add_ps(center, r4);
+
+    auto extents = _mm_mul_ps(_mm_set1_ps(e.x()), _mm_and_ps(r1, absMask));
+    extents = _mm_add_ps(
+      extents, _mm_mul_ps(_mm_set1_ps(e.y()), _mm_and_ps(r2, absMask)));
+    extents = _mm_add_ps(
+      extents, _mm_mul_ps(_mm_set1_ps(e.z()), _mm_and_ps(r3, absMask)));
+
+    alignas(16) auto newCenter = std::array<f32, 4>{};
+    alignas(16) auto newExtents = std::array<f32, 4>{};
+    _mm_store_ps(newCenter.data(), center);
+    _mm_store_ps(newExtents.data(), extents);
+
+    out[i] = Aabb::from_center_half_extents(
+      Vector3f32{newCenter[0], newCenter[1], newCenter[2]},
+      Vector3f32{newExtents[0], newExtents[1], newExtents[2]});
+  }
+#else
+  for (auto i = uSize{0}; i < boxes.size(); ++i) {
+    out[i] = boxes[i].transformed(matrices[i]);
+  }
+#endif // BASALT_MATH_SSE
+}
+
+auto normalize(Vectors3f32 const vectors) -> void {
+  auto const count = vectors.size();
+  auto i = uSize{0};
+
+#if BASALT_MATH_SSE
+  for (; i + 4 <= count; i += 4) {
+    auto const x = _mm_loadu_ps(&vectors.x()[i]);
+    auto const y = _mm_loadu_ps(&vectors.y()[i]);
+    auto const z = _mm_loadu_ps(&vectors.z()[i]);
+
+    auto const length = _mm_sqrt_ps(
+      _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)),
+                 _mm_mul_ps(z, z)));
+    _mm_storeu_ps(&vectors.x()[i], _mm_div_ps(x, length));
+    _mm_storeu_ps(&vectors.y()[i], _mm_div_ps(y, length));
+    _mm_storeu_ps(&vectors.z()[i], _mm_div_ps(z, length));
+  }
+#endif // BASALT_MATH_SSE
+
+  for (; i < count; ++i) {
+    auto& x = vectors.x()[i];
+    auto& y = vectors.y()[i];
+    auto& z = vectors.z()[i];
+    auto const length = std::sqrt(x * x + y * y + z * z);
+    x /= length;
+    y /= length;
+    z /= length;
+  }
+}
+
+} // namespace basalt::batch
@@ -0,0 +1,106 @@
+#pragma once
+
+#include "types.h"
+
+#include <basalt/api/base/types.h>
+
+#include <gsl/span>
+
+#include <type_traits>
+
+// Math on many values at once. Vectors are passed as structure of arrays, one
+// array per coordinate, which lets the SSE kernels process four of them per
+// instruction. The generic loops remain for platforms without SSE2
+namespace basalt::batch {
+
+// N 3d vectors with their coordinates in three arrays of the same size
+template <typename T>
+class Vector3Span final {
+public:
+  constexpr Vector3Span(gsl::span<T> const x, gsl::span<T> const y,
+                        gsl::span<T> const z) noexcept
+    : mX{x}, mY{y}, mZ{z} {
+  }
+
+  // mutable to const
+  template <typename U,
+            std::enable_if_t<std::is_convertible_v<U (*)[], T (*)[]>, int> = 0>
+  constexpr Vector3Span(Vector3Span<U> const& o) noexcept
+    : mX{o.x()}, mY{o.y()}, mZ{o.z()} {
+  }
+
+  [[nodiscard]]
+  constexpr auto x() const noexcept -> gsl::span<T> {
+    return mX;
+  }
+
+  [[nodiscard]]
+  constexpr auto y() const noexcept -> gsl::span<T> {
+    return mY;
+  }
+
+  [[nodiscard]]
+  constexpr auto z() const noexcept -> gsl::span<T> {
+    return mZ;
+  }
+
+  [[nodiscard]]
+  constexpr auto size() const noexcept -> uSize {
+    return mX.size();
+  }
+
+  [[nodiscard]]
+  constexpr auto subspan(uSize const offset, uSize const count) const noexcept
+    -> Vector3Span {
+    return Vector3Span{mX.subspan(offset, count), mY.subspan(offset, count),
+                       mZ.subspan(offset, count)};
+  }
+
+private:
+  gsl::span<T> mX;
+  gsl::span<T> mY;
+  gsl::span<T> mZ;
+};
+
+using Vectors3f32 = Vector3Span<f32>;
+using ConstVectors3f32 = Vector3Span<f32 const>;
+
+// out[i] = scale(scales[i]) * rotation(rotations[i]) *
+//   translation(positions[i])
+// like Transform::to_matrix with RotationMode::Euler. The rotations are euler
+// angles in radians. The sines and cosines are computed with the polynomial of
+// Angle::sincos, four at a time
+auto compose_transforms(ConstVectors3f32 positions, ConstVectors3f32 rotations,
+                        ConstVectors3f32 scales, gsl::span<Matrix4x4f32> out)
+  -> void;
+
+// the same as affine matrices, which saves the fourth column of every matrix
+auto compose_transforms(ConstVectors3f32 positions, ConstVectors3f32 rotations,
+                        ConstVectors3f32 scales, gsl::span<Affine3x4f32> out)
+  -> void;
+
+// out[i] = matrices[i] * parent. out may be matrices
+auto multiply(gsl::span<Matrix4x4f32 const> matrices,
+              Matrix4x4f32 const& parent, gsl::span<Matrix4x4f32> out) -> void;
+
+// out[i] = matrices[i] * parents[i]. out may be matrices. Not batched: every
+// product uses the SSE kernel of Matrix4x4f32, because no operand is shared
+// between the products
+auto multiply(gsl::span<Matrix4x4f32 const> matrices,
+              gsl::span<Matrix4x4f32 const> parents,
+              gsl::span<Matrix4x4f32> out) -> void;
+
+// Transforms the points with w = 1 and ignores the last column of the matrix,
+// i.e. the matrix must be affine. out may be points
+auto transform_points(ConstVectors3f32 points, Matrix4x4f32 const&,
+                      Vectors3f32 out) -> void;
+
+// out[i] = boxes[i].transformed(matrices[i]). out may be boxes
+auto transform_boxes(gsl::span<Aabb const> boxes,
+                     gsl::span<Matrix4x4f32 const> matrices,
+                     gsl::span<Aabb> out) -> void;
+
+// the vectors must not be zero
+auto normalize(Vectors3f32 vectors) -> void;
+
+} // namespace basalt::batch
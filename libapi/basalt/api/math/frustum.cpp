@@ -0,0 +1,26 @@
+#include <basalt/api/math/frustum.h>
+
+#include <basalt/api/math/matrix4.h>
+
+namespace basalt {
+
+// with row vectors a point p is inside when -w <= x <= w, -w <= y <= w and
+// 0 <= z <= w with (x, y, z, w) = p * m. Each inequality is a plane made from
+// the columns of m
+auto Frustum::from_matrix(Matrix4x4f32 const& m) -> Frustum {
+  return Frustum{std::array{
+    Plane::from_general_form(m.m14() + m.m11(), m.m24() + m.m21(),
+                             m.m34() + m.m31(), m.m44() + m.m41()),
+    Plane::from_general_form(m.m14() - m.m11(), m.m24() - m.m21(),
+                             m.m34() - m.m31(), m.m44() - m.m41()),
+    Plane::from_general_form(m.m14() + m.m12(), m.m24() + m.m22(),
+                             m.m34() + m.m32(), m.m44() + m.m42()),
+    Plane::from_general_form(m.m14() - m.m12(), m.m24() - m.m22(),
+                             m.m34() - m.m32(), m.m44() - m.m42()),
+    Plane::from_general_form(m.m13(), m.m23(), m.m33(), m.m43()),
+    Plane::from_general_form(m.m14() - m.m13(), m.m24() - m.m23(),
+                             m.m34() - m.m33(), m.m44() - m.m43()),
+  }};
+}
+
+} // namespace basalt
@@ -0,0 +1,100 @@
+#pragma once
+
+#include "aabb.h"
+#include "plane.h"
+#include "types.h"
+#include "vector3.h"
+
+#include <basalt/api/base/types.h>
+
+#include <array>
+
+namespace basalt {
+
+// convex volume bounded by six planes with their normals pointing inwards
+class Frustum final {
+public:
+  enum class Containment : u8 {
+    Outside,
+    Intersects,
+    Inside,
+  };
+
+  // extracts the planes from a world to clip matrix with a clip space depth
+  // range of [0, 1] (Gribb & Hartmann)
+  [[nodiscard]]
+  static auto from_matrix(Matrix4x4f32 const& worldToClip) -> Frustum;
+
+  [[nodiscard]]
+  constexpr auto planes() const -> std::array<Plane, 6> const& {
+    return mPlanes;
+  }
+
+  [[nodiscard]]
+  constexpr auto contains(Vector3f32 const& p) const -> bool {
+    for (auto const& plane : mPlanes) {
+      if (plane.distance(p) < 0.0f) {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  // conservative: might report an intersection for boxes near the corners of
+  // the frustum
+  [[nodiscard]]
+  constexpr auto intersects(Aabb const& box) const -> bool {
+    return test(box) != Containment::Outside;
+  }
+
+  [[nodiscard]]
+  constexpr auto intersects_sphere(Vector3f32 const& center,
+                                   f32 const radius) const -> bool {
+    for (auto const& plane : mPlanes) {
+      if (plane.distance(center) < -radius) {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  [[nodiscard]]
+  constexpr auto test(Aabb const& box) const -> Containment {
+    auto result = Containment::Inside;
+
+    for (auto const& plane : mPlanes) {
+      auto const& n = plane.normal();
+      auto const& min = box.min();
+      auto const& max = box.max();
+
+      // the corners furthest along and against the normal
+      auto const positive = Vector3f32{n.x() >= 0.0f ? max.x() : min.x(),
+                                       n.y() >= 0.0f ? max.y() : min.y(),
+                                       n.z() >= 0.0f ? max.z() : min.z()};
+      if (plane.distance(positive) < 0.0f) {
+        return Containment::Outside;
+      }
+
+      auto const negative = Vector3f32{n.x() >= 0.0f ? min.x() : max.x(),
+                                       n.y() >= 0.0f ? min.y() : max.y(),
+                                       n.z() >= 0.0f ? min.z() : max.z()};
+      if (plane.distance(negative) < 0.0f) {
+        result = Containment::Intersects;
+      }
+    }
+
+    return result;
+  }
+
+private:
+  // left, right, bottom, top, near, far
+  std::array<Plane, 6> mPlanes;
+
+  explicit constexpr Frustum(std::array<Plane, 6> const& planes)
+    : mPlanes{planes} {
+  }
+};
+
+} // namespace basalt
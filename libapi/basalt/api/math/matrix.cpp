@@ -3,6 +3,7 @@
 #include "matrix4.h"
 
 #include "angle.h"
+#include "quaternion.h"
 #include "vector3.h"
 
 #include <cmath>
@@ -19,9 +20,51 @@ auto Matrix2x2f32::rotation(Angle const angle) -> Matrix2x2f32 {
   // clang-format on
 }
 
+// the product of the three rotations in closed form
 auto Matrix3x3f32::rotation(Angle const x, Angle const y, Angle const z)
   -> Matrix3x3f32 {
-  return rotation_y(y) * rotation_x(x) * rotation_z(z);
+  auto const [sinX, cosX] = x.sincos();
+  auto const [sinY, cosY] = y.sincos();
+  auto const [sinZ, cosZ] = z.sincos();
+  auto const sinYSinX = sinY * sinX;
+  auto const cosYSinX = cosY * sinX;
+
+  // clang-format off
+  return Matrix3x3f32{
+    cosY * cosZ - sinYSinX * sinZ,
+    cosY * sinZ + sinYSinX * cosZ,
+    -sinY * cosX,
+
+    -cosX * sinZ,
+    cosX * cosZ,
+    sinX,
+
+    sinY * cosZ + cosYSinX * sinZ,
+    sinY * sinZ - cosYSinX * cosZ,
+    cosY * cosX,
+  };
+  // clang-format on
+}
+
+auto Matrix3x3f32::rotation(Quaternion const& q) -> Matrix3x3f32 {
+  auto const x2 = q.x() + q.x();
+  auto const y2 = q.y() + q.y();
+  auto const z2 = q.z() + q.z();
+  auto const xx = q.x() * x2;
+  auto const yy = q.y() * y2;
+  auto const zz = q.z() * z2;
+  auto const xy = q.x() * y2;
+  auto const xz = q.x() * z2;
+  auto const yz = q.y() * z2;
+  auto const wx = q.w() * x2;
+  auto const wy = q.w() * y2;
+  auto const wz = q.w() * z2;
+
+  // clang-format off
+  return Matrix3x3f32{1.0f - yy - zz,        xy + wz,        xz - wy,
+                             xy - wz, 1.0f - xx - zz,        yz + wx,
+                             xz + wy,        yz - wx, 1.0f - xx - yy};
+  // clang-format on
 }
 
 auto Matrix3x3f32::rotation_x(Angle const angle) -> Matrix3x3f32 {
@@ -20,7 +20,10 @@ public:
     // clang-format on
   }
 
+  // rotation_y(y) * rotation_x(x) * rotation_z(z)
   static auto rotation(Angle x, Angle y, Angle z) -> Matrix3x3f32;
+  // q must be a unit quaternion
+  static auto rotation(Quaternion const& q) -> Matrix3x3f32;
   static auto rotation_x(Angle) -> Matrix3x3f32;
   static auto rotation_y(Angle) -> Matrix3x3f32;
   static auto rotation_z(Angle) -> Matrix3x3f32;
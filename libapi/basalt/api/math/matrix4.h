@@ -32,6 +32,58 @@ public:
   static auto perspective_projection(Angle fov, f32 aspectRatio, f32 nearPlaneZ,
                                      f32 farPlaneZ) -> Matrix4x4f32;
 
+  // m must be invertible
+  static constexpr auto inverse(Matrix4x4f32 const& m) -> Matrix4x4f32 {
+    auto result = Matrix4x4f32{};
+    if constexpr (detail::simd::HAS_4X4_F32) {
+      if (!detail::simd::is_constant_evaluated()) {
+        detail::simd::inverse_4x4(&m.m11(), &result.m11());
+
+        return result;
+      }
+    }
+
+    // 2x2 determinants of the upper and lower two rows
+    auto const s1 = m.m11() * m.m22() - m.m21() * m.m12();
+    auto const s2 = m.m11() * m.m23() - m.m21() * m.m13();
+    auto const s3 = m.m11() * m.m24() - m.m21() * m.m14();
+    auto const s4 = m.m12() * m.m23() - m.m22() * m.m13();
+    auto const s5 = m.m12() * m.m24() - m.m22() * m.m14();
+    auto const s6 = m.m13() * m.m24() - m.m23() * m.m14();
+    auto const c1 = m.m31() * m.m42() - m.m41() * m.m32();
+    auto const c2 = m.m31() * m.m43() - m.m41() * m.m33();
+    auto const c3 = m.m31() * m.m44() - m.m41() * m.m34();
+    auto const c4 = m.m32() * m.m43() - m.m42() * m.m33();
+    auto const c5 = m.m32() * m.m44() - m.m42() * m.m34();
+    auto const c6 = m.m33() * m.m44() - m.m43() * m.m34();
+
+    // clang-format off
+    result = Matrix4x4f32{
+       m.m22() * c6 - m.m23() * c5 + m.m24() * c4,
+      -m.m12() * c6 + m.m13() * c5 - m.m14() * c4,
+       m.m42() * s6 - m.m43() * s5 + m.m44() * s4,
+      -m.m32() * s6 + m.m33() * s5 - m.m34() * s4,
+
+      -m.m21() * c6 + m.m23() * c3 - m.m24() * c2,
+       m.m11() * c6 - m.m13() * c3 + m.m14() * c2,
+      -m.m41() * s6 + m.m43() * s3 - m.m44() * s2,
+       m.m31() * s6 - m.m33() * s3 + m.m34() * s2,
+
+       m.m21() * c5 - m.m22() * c3 + m.m24() * c1,
+      -m.m11() * c5 + m.m12() * c3 - m.m14() * c1,
+       m.m41() * s5 - m.m42() * s3 + m.m44() * s1,
+      -m.m31() * s5 + m.m32() * s3 - m.m34() * s1,
+
+      -m.m21() * c4 + m.m22() * c2 - m.m23() * c1,
+       m.m11() * c4 - m.m12() * c2 + m.m13() * c1,
+      -m.m41() * s4 + m.m42() * s2 - m.m43() * s1,
+       m.m31() * s4 - m.m32() * s2 + m.m33() * s1};
+    // clang-format on
+    result /= s1 * c6 - s2 * c5 + s3 * c4 + s4 * c3 - s5 * c2 + s6 * c1;
+
+    return result;
+  }
+
   static constexpr auto identity() -> Matrix4x4f32 {
     // clang-format off
     return Matrix4x4f32{1.0f, 0.0f, 0.0f, 0.0f,
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "simd_p.h"
 #include "vector_p.h"
 
 #include <basalt/api/base/types.h>
@@ -34,6 +35,14 @@ public:
   static constexpr auto
   transposed(Matrix<Other, T, NUM_COLUMNS, NUM_ROWS> const& m) -> Derived {
     auto transposedM = Derived{};
+    if constexpr (is_simd_4x4<NUM_ROWS, NUM_COLUMNS, NUM_ROWS>) {
+      if (!simd::is_constant_evaluated()) {
+        simd::transpose_4x4(m.mElements.data(), transposedM.mElements.data());
+
+        return transposedM;
+      }
+    }
+
     for (auto rowIdx = uSize{0}; rowIdx < NUM_ROWS; ++rowIdx) {
       for (auto columnIdx = uSize{0}; columnIdx < NUM_COLUMNS; ++columnIdx) {
         transposedM[{rowIdx, columnIdx}] = m[{columnIdx, rowIdx}];
@@ -70,9 +79,19 @@ public:
   friend constexpr auto operator*(Vector<DerivedVec, T, NUM_ROWS> const& v,
                                   Derived const& m) -> DerivedVec {
     auto result = DerivedVec{};
+    if constexpr (is_simd_4x4<NUM_ROWS, NUM_COLUMNS, NUM_ROWS>) {
+      if (!simd::is_constant_evaluated()) {
+        simd::transform_4(&v[0], m.mElements.data(), &result[0]);
+
+        return result;
+      }
+    }
+
+    // starting at the first product instead of zero keeps its sign when it's
+    // -0, like the SSE kernel
     for (auto columnIdx = uSize{0}; columnIdx < NUM_COLUMNS; ++columnIdx) {
-      auto element = T{};
-      for (auto i = uSize{0}; i < NUM_ROWS; ++i) {
+      auto element = v[0] * m.mElements[element_idx(0, columnIdx)];
+      for (auto i = uSize{1}; i < NUM_ROWS; ++i) {
         element += v[i] * m.mElements[element_idx(i, columnIdx)];
       }
 
@@ -87,10 +106,20 @@ public:
                                   Matrix<Rhs, T, N, NUM_COLUMNS> const& rhs)
     -> Derived {
     auto result = Derived{};
+    if constexpr (is_simd_4x4<NUM_ROWS, N, NUM_COLUMNS>) {
+      if (!simd::is_constant_evaluated()) {
+        simd::mul_4x4(lhs.mElements.data(), rhs.mElements.data(),
+                      result.mElements.data());
+
+        return result;
+      }
+    }
+
     for (auto rowIdx = uSize{0}; rowIdx < NUM_ROWS; ++rowIdx) {
       for (auto columnIdx = uSize{0}; columnIdx < NUM_COLUMNS; ++columnIdx) {
-        auto element = T{};
-        for (auto i = uSize{0}; i < N; ++i) {
+        auto element = lhs.mElements[element_idx(rowIdx, 0)] *
+                       rhs.mElements[element_idx(0, columnIdx)];
+        for (auto i = uSize{1}; i < N; ++i) {
           element += lhs.mElements[element_idx(rowIdx, i)] *
                      rhs.mElements[element_idx(i, columnIdx)];
         }
@@ -161,6 +190,11 @@ public:
   }
 
 protected:
+  // whether the operation on Rows x N and N x Columns matrices has a kernel
+  template <uSize R, uSize N, uSize C>
+  static constexpr bool is_simd_4x4 = std::is_same_v<T, f32> && R == 4 &&
+                                      N == 4 && C == 4 && simd::HAS_4X4_F32;
+
   constexpr auto self() const -> Derived const& {
     return static_cast<Derived const&>(*this);
   }
@@ -0,0 +1,62 @@
+#include "quaternion.h"
+
+#include "angle.h"
+
+#include <cmath>
+
+namespace basalt {
+
+auto Quaternion::from_axis_angle(Vector3f32 const& axis, Angle const angle)
+  -> Quaternion {
+  auto const [sin, cos] = Angle::radians(0.5f * angle.radians()).sincos();
+
+  return Quaternion{axis.x() * sin, axis.y() * sin, axis.z() * sin, cos};
+}
+
+auto Quaternion::from_euler(Angle const x, Angle const y, Angle const z)
+  -> Quaternion {
+  return from_axis_angle(Vector3f32::up(), y) *
+         from_axis_angle(Vector3f32::right(), x) *
+         from_axis_angle(Vector3f32::forward(), z);
+}
+
+auto Quaternion::normalized(Quaternion const& q) -> Quaternion {
+  auto const length = q.length();
+
+  return Quaternion{q.mX / length, q.mY / length, q.mZ / length,
+                    q.mW / length};
+}
+
+auto Quaternion::slerp(Quaternion const& from, Quaternion const& to,
+                       f32 const t) -> Quaternion {
+  // q and -q are the same rotation. Negate to take the shorter arc
+  auto cosTheta = from.dot(to);
+  auto const sign = cosTheta < 0.0f ? -1.0f : 1.0f;
+  cosTheta *= sign;
+
+  auto fromWeight = 1.0f - t;
+  auto toWeight = t;
+
+  // sin(theta) approaches zero. Fall back to lerp, which is exact enough
+  if (cosTheta < 0.9995f) {
+    auto const theta = std::acos(cosTheta);
+    auto const sinTheta = std::sin(theta);
+    fromWeight = std::sin(fromWeight * theta) / sinTheta;
+    toWeight = std::sin(toWeight * theta) / sinTheta;
+  }
+
+  toWeight *= sign;
+
+  return normalized(Quaternion{
+    fromWeight * from.mX + toWeight * to.mX,
+    fromWeight * from.mY + toWeight * to.mY,
+    fromWeight * from.mZ + toWeight * to.mZ,
+    fromWeight * from.mW + toWeight * to.mW,
+  });
+}
+
+auto Quaternion::length() const -> f32 {
+  return std::sqrt(dot(*this));
+}
+
+} // namespace basalt
@@ -0,0 +1,115 @@
+#pragma once
+
+#include "types.h"
+#include "vector3.h"
+
+#include <basalt/api/base/types.h>
+
+namespace basalt {
+
+// Rotation as unit quaternion (x, y, z, w). Like the matrices, a * b rotates
+// by a first and then by b
+class Quaternion final {
+public:
+  [[nodiscard]]
+  static constexpr auto identity() -> Quaternion {
+    return Quaternion{};
+  }
+
+  // axis must be a unit vector
+  [[nodiscard]]
+  static auto from_axis_angle(Vector3f32 const& axis, Angle) -> Quaternion;
+
+  // same rotation as Matrix3x3f32::rotation(x, y, z)
+  [[nodiscard]]
+  static auto from_euler(Angle x, Angle y, Angle z) -> Quaternion;
+
+  [[nodiscard]]
+  static auto normalized(Quaternion const&) -> Quaternion;
+
+  // the inverse rotation of a unit quaternion
+  [[nodiscard]]
+  static constexpr auto conjugate(Quaternion const& q) -> Quaternion {
+    return Quaternion{-q.mX, -q.mY, -q.mZ, q.mW};
+  }
+
+  // spherical linear interpolation along the shorter arc with t in [0, 1]
+  [[nodiscard]]
+  static auto slerp(Quaternion const& from, Quaternion const& to, f32 t)
+    -> Quaternion;
+
+  // identity
+  constexpr Quaternion() = default;
+
+  constexpr Quaternion(f32 const x, f32 const y, f32 const z, f32 const w)
+    : mX{x}, mY{y}, mZ{z}, mW{w} {
+  }
+
+  [[nodiscard]]
+  constexpr auto x() const -> f32 {
+    return mX;
+  }
+
+  [[nodiscard]]
+  constexpr auto y() const -> f32 {
+    return mY;
+  }
+
+  [[nodiscard]]
+  constexpr auto z() const -> f32 {
+    return mZ;
+  }
+
+  [[nodiscard]]
+  constexpr auto w() const -> f32 {
+    return mW;
+  }
+
+  [[nodiscard]]
+  constexpr auto dot(Quaternion const& r) const -> f32 {
+    return mX * r.mX + mY * r.mY + mZ * r.mZ + mW * r.mW;
+  }
+
+  [[nodiscard]]
+  auto length() const -> f32;
+
+  // v rotated by this quaternion
+  [[nodiscard]]
+  constexpr auto rotate(Vector3f32 const& v) const -> Vector3f32 {
+    // v + 2w (q x v) + 2 q x (q x v)
+    auto const q = Vector3f32{mX, mY, mZ};
+    auto const t = Vector3f32::cross(q, v) * 2.0f;
+
+    return v + t * mW + Vector3f32::cross(q, t);
+  }
+
+  [[nodiscard]]
+  friend constexpr auto operator*(Quaternion const& l, Quaternion const& r)
+    -> Quaternion {
+    // Hamilton product r l, which applies l first
+    return Quaternion{
+      r.mW * l.mX + r.mX * l.mW + r.mY * l.mZ - r.mZ * l.mY,
+      r.mW * l.mY - r.mX * l.mZ + r.mY * l.mW + r.mZ * l.mX,
+      r.mW * l.mZ + r.mX * l.mY - r.mY * l.mX + r.mZ * l.mW,
+      r.mW * l.mW - r.mX * l.mX - r.mY * l.mY - r.mZ * l.mZ,
+    };
+  }
+
+  [[nodiscard]]
+  constexpr auto operator==(Quaternion const& r) const -> bool {
+    return mX == r.mX && mY == r.mY && mZ == r.mZ && mW == r.mW;
+  }
+
+  [[nodiscard]]
+  constexpr auto operator!=(Quaternion const& r) const -> bool {
+    return !(*this == r);
+  }
+
+private:
+  f32 mX{};
+  f32 mY{};
+  f32 mZ{};
+  f32 mW{1.0f};
+};
+
+} // namespace basalt
@@ -0,0 +1,201 @@
+#pragma once
+
+#include <basalt/api/base/types.h>
+
+#if defined(__SSE2__) || defined(_M_X64) ||                                    \
+  (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BASALT_MATH_SSE 1
+#include <emmintrin.h>
+#else
+#define BASALT_MATH_SSE 0
+#endif
+
+// 4x4 f32 kernels of the matrix and vector types. The generic loops remain for
+// constant evaluation and platforms without SSE2. Multiplications sum up the
+// products in the same order as the generic loops, starting with the first
+// product. Both give bitwise identical results, including the sign of zeros,
+// unless the compiler fuses the multiplications and additions of the loops.
+// The inverse is computed blockwise instead of by cofactors, so its results
+// can differ from the generic one in the last bits
+namespace basalt::detail::simd {
+
+inline constexpr bool HAS_4X4_F32 = BASALT_MATH_SSE;
+
+constexpr auto is_constant_evaluated() noexcept -> bool {
+  return __builtin_is_constant_evaluated();
+}
+
+// all matrices are 16 floats in row-major order. out must not alias the inputs
+inline auto mul_4x4(f32 const* l, f32 const* r, f32* out) -> void;
+inline auto transform_4(f32 const* v, f32 const* m, f32* out) -> void;
+inline auto transpose_4x4(f32 const* m, f32* out) -> void;
+inline auto inverse_4x4(f32 const* m, f32* out) -> void;
+
+// affine matrices are 12 floats: the first three columns of the 4x4 matrix
+inline auto mul_affine_3x4(f32 const* l, f32 const* r, f32* out) -> void;
+inline auto affine_3x4_to_4x4(f32 const* a, f32* out) -> void;
+
+#if BASALT_MATH_SSE
+
+namespace sse {
+
+template <int X, int Y, int Z, int W>
+auto shuffle(__m128 const a, __m128 const b) -> __m128 {
+  return _mm_shuffle_ps(a, b, _MM_SHUFFLE(W, Z, Y, X));
+}
+
+template <int X, int Y, int Z, int W>
+auto swizzle(__m128 const v) -> __m128 {
+  return shuffle<X, Y, Z, W>(v, v);
+}
+
+// 2x2 matrices in one register: (m11, m12, m21, m22)
+inline auto mul_2x2(__m128 const l, __m128 const r) -> __m128 {
+  return _mm_add_ps(_mm_mul_ps(l, swizzle<0, 3, 0, 3>(r)),
+                    _mm_mul_ps(swizzle<1, 0, 3, 2>(l), swizzle<2, 1, 2, 1>(r)));
+}
+
+// adjugate(l) * r
+inline auto adj_mul_2x2(__m128 const l, __m128 const r) -> __m128 {
+  return _mm_sub_ps(_mm_mul_ps(swizzle<3, 3, 0, 0>(l), r),
+                    _mm_mul_ps(swizzle<1, 1, 2, 2>(l), swizzle<2, 3, 0, 1>(r)));
+}
+
+// l * adjugate(r)
+inline auto mul_adj_2x2(__m128 const l, __m128 const r) -> __m128 {
+  return _mm_sub_ps(_mm_mul_ps(l, swizzle<3, 0, 3, 0>(r)),
+                    _mm_mul_ps(swizzle<1, 0, 3, 2>(l), swizzle<2, 1, 2, 1>(r)));
+}
+
+} // namespace sse
+
+// every row of the result is the row of l times the rows of r
+inline auto mul_4x4(f32 const* const l, f32 const* const r, f32* const out)
+  -> void {
+  auto const r1 = _mm_loadu_ps(r);
+  auto const r2 = _mm_loadu_ps(r + 4);
+  auto const r3 = _mm_loadu_ps(r + 8);
+  auto const r4 = _mm_loadu_ps(r + 12);
+
+  for (auto i = 0; i < 16; i += 4) {
+    auto row = _mm_mul_ps(_mm_set1_ps(l[i]), r1);
+    row = _mm_add_ps(row, _mm_mul_ps(_mm_set1_ps(l[i + 1]), r2));
+    row = _mm_add_ps(row, _mm_mul_ps(_mm_set1_ps(l[i + 2]), r3));
+    row = _mm_add_ps(row, _mm_mul_ps(_mm_set1_ps(l[i + 3]), r4));
+    _mm_storeu_ps(out + i, row);
+  }
+}
+
+inline auto transform_4(f32 const* const v, f32 const* const m, f32* const out)
+  -> void {
+  auto result = _mm_mul_ps(_mm_set1_ps(v[0]), _mm_loadu_ps(m));
+  result =
+    _mm_add_ps(result, _mm_mul_ps(_mm_set1_ps(v[1]), _mm_loadu_ps(m + 4)));
+  result =
+    _mm_add_ps(result, _mm_mul_ps(_mm_set1_ps(v[2]), _mm_loadu_ps(m + 8)));
+  result =
+    _mm_add_ps(result, _mm_mul_ps(_mm_set1_ps(v[3]), _mm_loadu_ps(m + 12)));
+  _mm_storeu_ps(out, result);
+}
+
+inline auto transpose_4x4(f32 const* const m, f32* const out) -> void {
+  auto r1 = _mm_loadu_ps(m);
+  auto r2 = _mm_loadu_ps(m + 4);
+  auto r3 = _mm_loadu_ps(m + 8);
+  auto r4 = _mm_loadu_ps(m + 12);
+  _MM_TRANSPOSE4_PS(r1, r2, r3, r4);
+  _mm_storeu_ps(out, r1);
+  _mm_storeu_ps(out + 4, r2);
+  _mm_storeu_ps(out + 8, r3);
+  _mm_storeu_ps(out + 12, r4);
+}
+
+// Blockwise inversion of the 2x2 sub-matrices
+//   | A B |
+//   | C D |
+// using only 2x2 adjugates and determinants
+inline auto inverse_4x4(f32 const* const m, f32* const out) -> void {
+  using namespace sse;
+
+  auto const r1 = _mm_loadu_ps(m);
+  auto const r2 = _mm_loadu_ps(m + 4);
+  auto const r3 = _mm_loadu_ps(m + 8);
+  auto const r4 = _mm_loadu_ps(m + 12);
+
+  auto const a = _mm_movelh_ps(r1, r2);
+  auto const b = _mm_movehl_ps(r2, r1);
+  auto const c = _mm_movelh_ps(r3, r4);
+  auto const d = _mm_movehl_ps(r4, r3);
+
+  // (det A, det B, det C, det D)
+  auto const dets =
+    _mm_sub_ps(_mm_mul_ps(shuffle<0, 2, 0, 2>(r1, r3),
+                          shuffle<1, 3, 1, 3>(r2, r4)),
+               _mm_mul_ps(shuffle<1, 3, 1, 3>(r1, r3),
+                          shuffle<0, 2, 0, 2>(r2, r4)));
+  auto const detA = swizzle<0, 0, 0, 0>(dets);
+  auto const detB = swizzle<1, 1, 1, 1>(dets);
+  auto const detC = swizzle<2, 2, 2, 2>(dets);
+  auto const detD = swizzle<3, 3, 3, 3>(dets);
+
+  auto const adjDC = adj_mul_2x2(d, c);
+  auto const adjAB = adj_mul_2x2(a, b);
+
+  auto x = _mm_sub_ps(_mm_mul_ps(detD, a), mul_2x2(b, adjDC));
+  auto w = _mm_sub_ps(_mm_mul_ps(detA, d), mul_2x2(c, adjAB));
+  auto y = _mm_sub_ps(_mm_mul_ps(detB, c), mul_adj_2x2(d, adjAB));
+  auto z = _mm_sub_ps(_mm_mul_ps(detC, b), mul_adj_2x2(a, adjDC));
+
+  // det M = det A * det D + det B * det C - tr((A# B)(D# C))
+  auto trace = _mm_mul_ps(adjAB, swizzle<0, 2, 1, 3>(adjDC));
+  trace = _mm_add_ps(trace, swizzle<2, 3, 0, 1>(trace));
+  trace = _mm_add_ps(trace, swizzle<1, 0, 3, 2>(trace));
+  auto const det = _mm_sub_ps(
+    _mm_add_ps(_mm_mul_ps(detA, detD), _mm_mul_ps(detB, detC)), trace);
+
+  auto const rcpDet = _mm_div_ps(_mm_setr_ps(1.0f, -1.0f, -1.0f, 1.0f), det);
+  x = _mm_mul_ps(x, rcpDet);
+  y = _mm_mul_ps(y, rcpDet);
+  z = _mm_mul_ps(z, rcpDet);
+  w = _mm_mul_ps(w, rcpDet);
+
+  _mm_storeu_ps(out, shuffle<3, 1, 3, 1>(x, y));
+  _mm_storeu_ps(out + 4, shuffle<2, 0, 2, 0>(x, y));
+  _mm_storeu_ps(out + 8, shuffle<3, 1, 3, 1>(z, w));
+  _mm_storeu_ps(out + 12, shuffle<2, 0, 2, 0>(z, w));
+}
+
+// Column j of l * r is l times column j of r. The last row of r only adds
+// its translation, because the last column of l is (0, 0, 0, 1)
+inline auto mul_affine_3x4(f32 const* const l, f32 const* const r,
+                           f32* const out) -> void {
+  auto const c1 = _mm_loadu_ps(l);
+  auto const c2 = _mm_loadu_ps(l + 4);
+  auto const c3 = _mm_loadu_ps(l + 8);
+  auto const translationMask = _mm_castsi128_ps(_mm_setr_epi32(0, 0, 0, -1));
+
+  for (auto i = 0; i < 12; i += 4) {
+    auto const column = _mm_loadu_ps(r + i);
+    auto result = _mm_mul_ps(c1, _mm_set1_ps(r[i]));
+    result = _mm_add_ps(result, _mm_mul_ps(c2, _mm_set1_ps(r[i + 1])));
+    result = _mm_add_ps(result, _mm_mul_ps(c3, _mm_set1_ps(r[i + 2])));
+    result = _mm_add_ps(result, _mm_and_ps(column, translationMask));
+    _mm_storeu_ps(out + i, result);
+  }
+}
+
+inline auto affine_3x4_to_4x4(f32 const* const a, f32* const out) -> void {
+  auto r1 = _mm_loadu_ps(a);
+  auto r2 = _mm_loadu_ps(a + 4);
+  auto r3 = _mm_loadu_ps(a + 8);
+  auto r4 = _mm_setr_ps(0.0f, 0.0f, 0.0f, 1.0f);
+  _MM_TRANSPOSE4_PS(r1, r2, r3, r4);
+  _mm_storeu_ps(out, r1);
+  _mm_storeu_ps(out + 4, r2);
+  _mm_storeu_ps(out + 8, r3);
+  _mm_storeu_ps(out + 12, r4);
+}
+
+#endif // BASALT_MATH_SSE
+
+} // namespace basalt::detail::simd
@@ -4,14 +4,20 @@
 
 namespace basalt {
 
+class Aabb;
+class Affine3x4f32;
 class Angle;
 
+class Frustum;
+
 class Matrix2x2f32;
 class Matrix3x3f32;
 class Matrix4x4f32;
 
 class Plane;
 
+class Quaternion;
+
 template <typename T>
 class Rectangle;
 using RectangleI16 = Rectangle<i16>;
@@ -0,0 +1,323 @@
+#include <basalt/api/scene/aabb_tree.h>
+
+#include <basalt/api/base/asserts.h>
+
+#include <algorithm>
+
+namespace basalt {
+
+AabbTree::AabbTree(f32 const margin) : mMargin{margin} {
+}
+
+auto AabbTree::create_proxy(Aabb const& box, EntityId const entity)
+  -> ProxyId {
+  auto const id = allocate_node();
+  auto& node = mNodes[id];
+  node.box = box.expanded(mMargin);
+  node.entity = entity;
+  node.height = 0;
+
+  insert_leaf(id);
+  ++mNumProxies;
+
+  return id;
+}
+
+auto AabbTree::destroy_proxy(ProxyId const id) -> void {
+  BASALT_ASSERT(id < mNodes.size() && mNodes[id].is_leaf() &&
+                mNodes[id].height == 0);
+
+  remove_leaf(id);
+  free_node(id);
+  --mNumProxies;
+}
+
+auto AabbTree::move_proxy(ProxyId const id, Aabb const& box) -> bool {
+  BASALT_ASSERT(id < mNodes.size() && mNodes[id].height == 0);
+
+  if (auto const& fatBox = mNodes[id].box; fatBox.contains(box)) {
+    // also reinsert proxies which shrank a lot to keep queries tight
+    if (box.expanded(4.0f * mMargin).contains(fatBox)) {
+      return false;
+    }
+  }
+
+  remove_leaf(id);
+  mNodes[id].box = box.expanded(mMargin);
+  insert_leaf(id);
+
+  return true;
+}
+
+auto AabbTree::clear() -> void {
+  mNodes.clear();
+  mRoot = NULL_PROXY;
+  mFreeList = NULL_PROXY;
+  mNumProxies = 0;
+}
+
+auto AabbTree::entity(ProxyId const id) const -> EntityId {
+  BASALT_ASSERT(id < mNodes.size() && mNodes[id].height == 0);
+
+  return mNodes[id].entity;
+}
+
+auto AabbTree::fat_box(ProxyId const id) const -> Aabb const& {
+  BASALT_ASSERT(id < mNodes.size() && mNodes[id].height == 0);
+
+  return mNodes[id].box;
+}
+
+auto AabbTree::num_proxies() const -> uSize {
+  return mNumProxies;
+}
+
+auto AabbTree::height() const -> u32 {
+  return mRoot == NULL_PROXY ? 0 : static_cast<u32>(mNodes[mRoot].height);
+}
+
+auto AabbTree::allocate_node() -> ProxyId {
+  if (mFreeList == NULL_PROXY) {
+    mNodes.emplace_back();
+
+    auto& node = mNodes.back();
+    node.height = 0;
+
+    return static_cast<ProxyId>(mNodes.size() - 1);
+  }
+
+  auto const id = mFreeList;
+  auto& node = mNodes[id];
+  mFreeList = node.parent;
+
+  node.parent = NULL_PROXY;
+  node.child1 = NULL_PROXY;
+  node.child2 = NULL_PROXY;
+  node.height = 0;
+
+  return id;
+}
+
+auto AabbTree::free_node(ProxyId const id) -> void {
+  auto& node = mNodes[id];
+  node.entity = entt::null;
+  node.parent = mFreeList;
+  node.child1 = NULL_PROXY;
+  node.child2 = NULL_PROXY;
+  node.height = -1;
+
+  mFreeList = id;
+}
+
+// the sibling is chosen with the surface area heuristic. Descending into a
+// child is only worth it if that is cheaper than pairing with the node itself
+auto AabbTree::insert_leaf(ProxyId const leaf) -> void {
+  if (mRoot == NULL_PROXY) {
+    mRoot = leaf;
+    mNodes[leaf].parent = NULL_PROXY;
+
+    return;
+  }
+
+  auto const leafBox = mNodes[leaf].box;
+
+  auto sibling = mRoot;
+  while (!mNodes[sibling].is_leaf()) {
+    auto const& node = mNodes[sibling];
+
+    auto const area = node.box.surface_area();
+    auto const combinedArea = Aabb::merged(node.box, leafBox).surface_area();
+
+    // cost of creating a new parent for this node and the new leaf
+    auto const cost = 2.0f * combinedArea;
+    // minimum cost of pushing the leaf further down the tree
+    auto const inheritanceCost = 2.0f * (combinedArea - area);
+
+    auto const descendCost = [&](ProxyId const childId) {
+      auto const& child = mNodes[childId];
+      auto const mergedArea = Aabb::merged(leafBox, child.box).surface_area();
+
+      if (child.is_leaf()) {
+        return mergedArea + inheritanceCost;
+      }
+
+      return mergedArea - child.box.surface_area() + inheritanceCost;
+    };
+
+    auto const cost1 = descendCost(node.child1);
+    auto const cost2 = descendCost(node.child2);
+
+    if (cost < cost1 && cost < cost2) {
+      break;
+    }
+
+    sibling = cost1 < cost2 ? node.child1 : node.child2;
+  }
+
+  auto const newParent = allocate_node();
+  auto const oldParent = mNodes[sibling].parent;
+
+  auto& parent = mNodes[newParent];
+  parent.parent = oldParent;
+  parent.box = Aabb::merged(leafBox, mNodes[sibling].box);
+  parent.height = mNodes[sibling].height + 1;
+  parent.child1 = sibling;
+  parent.child2 = leaf;
+
+  if (oldParent == NULL_PROXY) {
+    mRoot = newParent;
+  } else if (mNodes[oldParent].child1 == sibling) {
+    mNodes[oldParent].child1 = newParent;
+  } else {
+    mNodes[oldParent].child2 = newParent;
+  }
+
+  mNodes[sibling].parent = newParent;
+  mNodes[leaf].parent = newParent;
+
+  fix_upwards(newParent);
+}
+
+auto AabbTree::remove_leaf(ProxyId const leaf) -> void {
+  if (leaf == mRoot) {
+    mRoot = NULL_PROXY;
+
+    return;
+  }
+
+  auto const parent = mNodes[leaf].parent;
+  auto const grandParent = mNodes[parent].parent;
+  auto const sibling = mNodes[parent].child1 == leaf ? mNodes[parent].child2
+                                                     : mNodes[parent].child1;
+
+  // the sibling takes the place of the parent
+  mNodes[sibling].parent = grandParent;
+  free_node(parent);
+
+  if (grandParent == NULL_PROXY) {
+    mRoot = sibling;
+
+    return;
+  }
+
+  if (mNodes[grandParent].child1 == parent) {
+    mNodes[grandParent].child1 = sibling;
+  } else {
+    mNodes[grandParent].child2 = sibling;
+  }
+
+  fix_upwards(grandParent);
+}
+
+auto AabbTree::fix_upwards(ProxyId id) -> void {
+  while (id != NULL_PROXY) {
+    id = balance(id);
+
+    auto& node = mNodes[id];
+    auto const& child1 = mNodes[node.child1];
+    auto const& child2 = mNodes[node.child2];
+    node.height = 1 + std::max(child1.height, child2.height);
+    node.box = Aabb::merged(child1.box, child2.box);
+
+    id = node.parent;
+  }
+}
+
+// Performs a left or right rotation if the subtree rooted at A is imbalanced.
+// If C is the taller child of A, C takes the place of A and A becomes the
+// child of C. A keeps B and takes the shorter child of C, while C keeps its
+// taller child (and vice versa for B)
+auto AabbTree::balance(ProxyId const idA) -> ProxyId {
+  auto& a = mNodes[idA];
+  if (a.is_leaf() || a.height < 2) {
+    return idA;
+  }
+
+  auto const idB = a.child1;
+  auto const idC = a.child2;
+  auto& b = mNodes[idB];
+  auto& c = mNodes[idC];
+
+  auto const replaceInParent = [&](ProxyId const newChild) {
+    auto const parent = mNodes[newChild].parent;
+    if (parent == NULL_PROXY) {
+      mRoot = newChild;
+    } else if (mNodes[parent].child1 == idA) {
+      mNodes[parent].child1 = newChild;
+    } else {
+      mNodes[parent].child2 = newChild;
+    }
+  };
+
+  auto const imbalance = c.height - b.height;
+
+  // rotate C up
+  if (imbalance > 1) {
+    auto const idF = c.child1;
+    auto const idG = c.child2;
+    auto& f = mNodes[idF];
+    auto& g = mNodes[idG];
+
+    c.child1 = idA;
+    c.parent = a.parent;
+    a.parent = idC;
+    replaceInParent(idC);
+
+    if (f.height > g.height) {
+      c.child2 = idF;
+      a.child2 = idG;
+      g.parent = idA;
+      a.box = Aabb::merged(b.box, g.box);
+      c.box = Aabb::merged(a.box, f.box);
+      a.height = 1 + std::max(b.height, g.height);
+      c.height = 1 + std::max(a.height, f.height);
+    } else {
+      c.child2 = idG;
+      a.child2 = idF;
+      f.parent = idA;
+      a.box = Aabb::merged(b.box, f.box);
+      c.box = Aabb::merged(a.box, g.box);
+      a.height = 1 + std::max(b.height, f.height);
+      c.height = 1 + std::max(a.height, g.height);
+    }
+
+    return idC;
+  }
+
+  // rotate B up
+  if (imbalance < -1) {
+    auto const idD = b.child1;
+    auto const idE = b.child2;
+    auto& d = mNodes[idD];
+    auto& e = mNodes[idE];
+
+    b.child1 = idA;
+    b.parent = a.parent;
+    a.parent = idB;
+    replaceInParent(idB);
+
+    if (d.height > e.height) {
+      b.child2 = idD;
+      a.child1 = idE;
+      e.parent = idA;
+      a.box = Aabb::merged(c.box, e.box);
+      b.box = Aabb::merged(a.box, d.box);
+      a.height = 1 + std::max(c.height, e.height);
+      b.height = 1 + std::max(a.height, d.height);
+    } else {
+      b.child2 = idE;
+      a.child1 = idD;
+      d.parent = idA;
+      a.box = Aabb::merged(c.box, d.box);
+      b.box = Aabb::merged(a.box, e.box);
+      a.height = 1 + std::max(c.height, d.height);
+      b.height = 1 + std::max(a.height, e.height);
+    }
+
+    return idB;
+  }
+
+  return idA;
+}
+
+} // namespace basalt
@@ -0,0 +1,376 @@
+#pragma once
+
+#include <basalt/api/scene/types.h>
+
+#include <basalt/api/math/aabb.h>
+#include <basalt/api/math/frustum.h>
+#include <basalt/api/math/vector3.h>
+
+#include <basalt/api/base/asserts.h>
+#include <basalt/api/base/types.h>
+
+#include <entt/entity/entity.hpp>
+#include <gsl/span>
+
+#include <algorithm>
+#include <array>
+#include <utility>
+#include <vector>
+
+namespace basalt {
+
+// Dynamic bounding volume hierarchy of entity bounds. Leaves store fat boxes,
+// which are enlarged by a margin so that small movements don't require
+// updating the tree. Inserting and removing leaves keeps the tree balanced
+// with tree rotations. All queries report the entities of the leaves whose
+// fat boxes pass the test
+class AabbTree final {
+public:
+  using ProxyId = u32;
+
+  static constexpr auto NULL_PROXY = ProxyId{~u32{0}};
+
+  explicit AabbTree(f32 margin = 0.1f);
+
+  // box is in world space
+  [[nodiscard]]
+  auto create_proxy(Aabb const& box, EntityId) -> ProxyId;
+
+  auto destroy_proxy(ProxyId) -> void;
+
+  // returns true if the proxy had to be reinserted into the tree
+  auto move_proxy(ProxyId, Aabb const& box) -> bool;
+
+  auto clear() -> void;
+
+  [[nodiscard]]
+  auto entity(ProxyId) const -> EntityId;
+
+  [[nodiscard]]
+  auto fat_box(ProxyId) const -> Aabb const&;
+
+  [[nodiscard]]
+  auto num_proxies() const -> uSize;
+
+  // 0 for an empty tree or a single leaf
+  [[nodiscard]]
+  auto height() const -> u32;
+
+  // callback(EntityId)
+  template <typename Callback>
+  auto query(Aabb const& box, Callback&& callback) const -> void {
+    traverse([&](Node const& node) { return node.box.intersects(box); },
+             [&](Node const& leaf) { callback(leaf.entity); });
+  }
+
+  // callback(EntityId)
+  template <typename Callback>
+  auto query(Frustum const& frustum, Callback&& callback) const -> void {
+    if (mRoot == NULL_PROXY) {
+      return;
+    }
+
+    auto stack = Stack{};
+    auto size = uSize{0};
+    stack[size++] = mRoot;
+
+    while (size > 0) {
+      auto const& node = mNodes[stack[--size]];
+
+      auto const containment = frustum.test(node.box);
+      if (containment == Frustum::Containment::Outside) {
+        continue;
+      }
+
+      // every leaf of a fully contained subtree is visible
+      if (containment == Frustum::Containment::Inside) {
+        for_each_leaf(node, [&](Node const& leaf) { callback(leaf.entity); });
+
+        continue;
+      }
+
+      if (node.is_leaf()) {
+        callback(node.entity);
+
+        continue;
+      }
+
+      BASALT_ASSERT(size + 2 <= stack.size());
+      stack[size++] = node.child1;
+      stack[size++] = node.child2;
+    }
+  }
+
+  // callback(EntityId)
+  template <typename Callback>
+  auto query_sphere(Vector3f32 const& center, f32 const radius,
+                    Callback&& callback) const -> void {
+    auto const radiusSquared = radius * radius;
+
+    traverse(
+      [&](Node const& node) {
+        return distance_squared(node.box, center) <= radiusSquared;
+      },
+      [&](Node const& leaf) { callback(leaf.entity); });
+  }
+
+  // direction doesn't need to be normalized. Distances are measured in
+  // multiples of its length.
+  // callback(EntityId, f32 distance) -> f32 returns the new max distance:
+  // return the hit distance to only look for closer hits, 0 to stop or
+  // maxDistance to continue unchanged. Leaves are not visited in order
+  template <typename Callback>
+  auto raycast(Vector3f32 const& origin, Vector3f32 const& direction,
+               f32 maxDistance, Callback&& callback) const -> void {
+    auto const invDirection =
+      Vector3f32{inverse(direction.x()), inverse(direction.y()),
+                 inverse(direction.z())};
+
+    traverse(
+      [&](Node const& node) {
+        return ray_distance(node.box, origin, direction, invDirection,
+                            maxDistance) >= 0.0f;
+      },
+      [&](Node const& leaf) {
+        auto const distance = ray_distance(leaf.box, origin, direction,
+                                           invDirection, maxDistance);
+        maxDistance = callback(leaf.entity, distance);
+      },
+      [&] { return maxDistance > 0.0f; });
+  }
+
+  // Runs all box queries with a single traversal of the tree. Nodes are only
+  // tested against the queries which overlap their parent.
+  // callback(uSize queryIndex, EntityId)
+  template <typename Callback>
+  auto query(gsl::span<Aabb const> const boxes, Callback&& callback) const
+    -> void {
+    if (mRoot == NULL_PROXY || boxes.empty()) {
+      return;
+    }
+
+    // ranges into the list of active query indices
+    struct Entry final {
+      ProxyId node;
+      uSize begin;
+      uSize end;
+    };
+
+    auto stack = std::array<Entry, MAX_STACK_SIZE>{};
+    auto size = uSize{0};
+
+    auto activeQueries = std::vector<u32>(boxes.size());
+    for (auto i = uSize{0}; i < boxes.size(); ++i) {
+      activeQueries[i] = static_cast<u32>(i);
+    }
+    stack[size++] = Entry{mRoot, 0, activeQueries.size()};
+
+    while (size > 0) {
+      auto const entry = stack[--size];
+      // everything after the range of this entry belongs to subtrees which
+      // are already done
+      activeQueries.resize(entry.end);
+
+      auto const& node = mNodes[entry.node];
+      auto const begin = activeQueries.size();
+      for (auto i = entry.begin; i < entry.end; ++i) {
+        auto const queryIdx = activeQueries[i];
+        if (node.box.intersects(boxes[queryIdx])) {
+          activeQueries.push_back(queryIdx);
+        }
+      }
+      auto const end = activeQueries.size();
+
+      if (begin == end) {
+        continue;
+      }
+
+      if (node.is_leaf()) {
+        for (auto i = begin; i < end; ++i) {
+          callback(uSize{activeQueries[i]}, node.entity);
+        }
+
+        continue;
+      }
+
+      BASALT_ASSERT(size + 2 <= stack.size());
+      stack[size++] = Entry{node.child1, begin, end};
+      stack[size++] = Entry{node.child2, begin, end};
+    }
+  }
+
+private:
+  // the height of a balanced tree with 2^32 leaves is well below that
+  static constexpr auto MAX_STACK_SIZE = uSize{128};
+  // keeps the slab distances finite for any direction
+  static constexpr auto MAX_INV_DIRECTION = 1e30f;
+
+  using Stack = std::array<ProxyId, MAX_STACK_SIZE>;
+
+  struct Node final {
+    // fat box for leaves
+    Aabb box;
+    EntityId entity{entt::null};
+    // next free node when in the free list
+    ProxyId parent{NULL_PROXY};
+    ProxyId child1{NULL_PROXY};
+    ProxyId child2{NULL_PROXY};
+    // 0 for leaves, -1 for free nodes
+    i32 height{-1};
+
+    [[nodiscard]]
+    constexpr auto is_leaf() const -> bool {
+      return child1 == NULL_PROXY;
+    }
+  };
+
+  std::vector<Node> mNodes;
+  ProxyId mRoot{NULL_PROXY};
+  ProxyId mFreeList{NULL_PROXY};
+  uSize mNumProxies{0};
+  f32 mMargin;
+
+  [[nodiscard]]
+  static constexpr auto distance_squared(Aabb const& box,
+                                         Vector3f32 const& p) -> f32 {
+    auto const dx =
+      std::max({box.min().x() - p.x(), 0.0f, p.x() - box.max().x()});
+    auto const dy =
+      std::max({box.min().y() - p.y(), 0.0f, p.y() - box.max().y()});
+    auto const dz =
+      std::max({box.min().z() - p.z(), 0.0f, p.z() - box.max().z()});
+
+    return dx * dx + dy * dy + dz * dz;
+  }
+
+  // Reciprocal of a direction component. Tiny components are clamped to a
+  // finite reciprocal, so that a ray starting on a slab plane doesn't compute
+  // 0 * inf. Zero components are handled by clip_slab
+  [[nodiscard]]
+  static constexpr auto inverse(f32 const direction) -> f32 {
+    if (direction == 0.0f) {
+      return 0.0f;
+    }
+
+    return std::clamp(1.0f / direction, -MAX_INV_DIRECTION, MAX_INV_DIRECTION);
+  }
+
+  // narrows [tMin, tMax] to the distances at which the ray is inside the slab
+  // [min, max] of one axis
+  static constexpr auto clip_slab(f32 const min, f32 const max,
+                                  f32 const origin, f32 const direction,
+                                  f32 const invDirection, f32& tMin, f32& tMax)
+    -> void {
+    // parallel to the slab: inside at every distance or at none
+    if (direction == 0.0f) {
+      if (origin < min || origin > max) {
+        tMax = -1.0f;
+      }
+
+      return;
+    }
+
+    auto const t0 = (min - origin) * invDirection;
+    auto const t1 = (max - origin) * invDirection;
+    tMin = std::max(tMin, std::min(t0, t1));
+    tMax = std::min(tMax, std::max(t0, t1));
+  }
+
+  // slab test. Returns the entry distance or -1 if the box is missed
+  [[nodiscard]]
+  static constexpr auto ray_distance(Aabb const& box, Vector3f32 const& origin,
+                                     Vector3f32 const& direction,
+                                     Vector3f32 const& invDirection,
+                                     f32 const maxDistance) -> f32 {
+    auto tMin = 0.0f;
+    auto tMax = maxDistance;
+    clip_slab(box.min().x(), box.max().x(), origin.x(), direction.x(),
+              invDirection.x(), tMin, tMax);
+    clip_slab(box.min().y(), box.max().y(), origin.y(), direction.y(),
+              invDirection.y(), tMin, tMax);
+    clip_slab(box.min().z(), box.max().z(), origin.z(), direction.z(),
+              invDirection.z(), tMin, tMax);
+
+    return tMin <= tMax ? tMin : -1.0f;
+  }
+
+  template <typename Visitor>
+  auto for_each_leaf(Node const& subtree, Visitor&& visitor) const -> void {
+    if (subtree.is_leaf()) {
+      visitor(subtree);
+
+      return;
+    }
+
+    auto stack = Stack{};
+    auto size = uSize{0};
+    stack[size++] = subtree.child1;
+    stack[size++] = subtree.child2;
+
+    while (size > 0) {
+      auto const& node = mNodes[stack[--size]];
+      if (node.is_leaf()) {
+        visitor(node);
+
+        continue;
+      }
+
+      BASALT_ASSERT(size + 2 <= stack.size());
+      stack[size++] = node.child1;
+      stack[size++] = node.child2;
+    }
+  }
+
+  template <typename Test, typename Visitor>
+  auto traverse(Test&& test, Visitor&& visitor) const -> void {
+    traverse(std::forward<Test>(test), std::forward<Visitor>(visitor),
+             [] { return true; });
+  }
+
+  template <typename Test, typename Visitor, typename Continue>
+  auto traverse(Test&& test, Visitor&& visitor,
+                Continue&& shouldContinue) const -> void {
+    if (mRoot == NULL_PROXY) {
+      return;
+    }
+
+    auto stack = Stack{};
+    auto size = uSize{0};
+    stack[size++] = mRoot;
+
+    while (size > 0 && shouldContinue()) {
+      auto const& node = mNodes[stack[--size]];
+      if (!test(node)) {
+        continue;
+      }
+
+      if (node.is_leaf()) {
+        visitor(node);
+
+        continue;
+      }
+
+      BASALT_ASSERT(size + 2 <= stack.size());
+      stack[size++] = node.child1;
+      stack[size++] = node.child2;
+    }
+  }
+
+  [[nodiscard]]
+  auto allocate_node() -> ProxyId;
+
+  auto free_node(ProxyId) -> void;
+
+  auto insert_leaf(ProxyId) -> void;
+
+  auto remove_leaf(ProxyId) -> void;
+
+  // walks up to the root, rebalancing and refitting every ancestor
+  auto fix_upwards(ProxyId) -> void;
+
+  // returns the new root of the subtree
+  [[nodiscard]]
+  auto balance(ProxyId) -> ProxyId;
+};
+
+} // namespace basalt
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <basalt/api/scene/types.h>
+
+#include <basalt/api/math/aabb.h>
+
+#include <basalt/api/base/types.h>
+
+namespace basalt {
+
+// bounding box of the entity in its local space. It is transformed into world
+// space with the LocalToWorld matrix of the entity
+struct LocalBounds final {
+  Aabb box;
+};
+
+// proxy of the entity in the spatial index of the scene. Added and removed by
+// the BoundsSystem
+struct SpatialIndexProxy final {
+  u32 id;
+};
+
+// access token of the spatial index of the scene, which isn't a component.
+// Systems list it in their Reads when they query Scene::spatial_index(), so
+// that they are ordered against the BoundsSystem which writes it
+struct SpatialIndex final {};
+
+} // namespace basalt
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <basalt/api/scene/system.h>
+
+#include <basalt/api/scene/types.h>
+
+namespace basalt {
+
+// keeps the spatial index of the scene in sync with the world space bounds of
+// entities with LocalBounds. Only the entities in the LocalToWorldChanges are
+// refit, so replacing the LocalBounds of an entity takes effect once it moves
+class BoundsSystem final : public System {
+public:
+  using UpdateAfter = TransformSystem;
+  using Reads = entt::type_list<LocalToWorld, LocalBounds, LocalToWorldChanges,
+                                Inactive>;
+  using Writes = entt::type_list<SpatialIndexProxy, SpatialIndex>;
+
+  BoundsSystem() noexcept = default;
+
+  auto on_update(UpdateContext const&) -> void override;
+};
+
+} // namespace basalt
@@ -0,0 +1,162 @@
+#include <basalt/api/scene/command_buffer.h>
+
+#include <basalt/api/base/asserts.h>
+#include <basalt/api/base/job_system.h>
+
+#include <algorithm>
+
+namespace basalt {
+
+EntityReserve::EntityReserve(EntityRegistry& entities) : mEntities{entities} {
+  // take must not create the storage while other threads use the registry
+  mEntities.storage<ReservedEntity>();
+  refill();
+}
+
+auto EntityReserve::take() -> EntityId {
+  auto const index = mNumTaken.fetch_add(1, std::memory_order_relaxed);
+  if (index >= mIds.size()) {
+    BASALT_CRASH("entity reserve ran out. Use EntityReserve::reserve");
+  }
+
+  return mIds[index];
+}
+
+auto EntityReserve::refill() -> void {
+  auto const numTaken = mNumTaken.exchange(0, std::memory_order_relaxed);
+  auto const numReserved = static_cast<u32>(mIds.size());
+
+  mIds.erase(mIds.begin(), mIds.begin() + std::min(numTaken, numReserved));
+  if (numTaken > 0) {
+    mCapacity = std::max({mCapacity, MIN_CAPACITY, 2 * numTaken});
+  }
+
+  while (mIds.size() < mCapacity) {
+    auto const entity = mEntities.create();
+    mEntities.emplace<ReservedEntity>(entity);
+    mIds.push_back(entity);
+  }
+}
+
+auto EntityReserve::reserve(u32 const count) -> void {
+  // ids are taken from the front, so appending keeps the taken ones in place
+  auto const numTaken = uSize{mNumTaken.load(std::memory_order_relaxed)};
+  while (mIds.size() < numTaken + count) {
+    auto const entity = mEntities.create();
+    mEntities.emplace<ReservedEntity>(entity);
+    mIds.push_back(entity);
+  }
+
+  mCapacity = std::max(mCapacity, count);
+}
+
+EntityCommandBuffer::EntityCommandBuffer(EntityRegistry& entities,
+                                         EntityReserve& reserve)
+  : mEntities{entities}
+  , mReserve{reserve}
+  , mStreams(JobSystem::global().num_threads()) {
+}
+
+EntityCommandBuffer::~EntityCommandBuffer() noexcept {
+  for (auto& stream : mStreams) {
+    stream.clear();
+  }
+}
+
+auto EntityCommandBuffer::set_sort_key(u32 const sortKey) -> void {
+  current_stream().sortKey = sortKey;
+}
+
+auto EntityCommandBuffer::create() -> EntityId {
+  auto const entity = mReserve.take();
+  record<Create>(entity);
+
+  return entity;
+}
+
+auto EntityCommandBuffer::destroy(EntityId const entity) -> void {
+  record<Destroy>(entity);
+}
+
+auto EntityCommandBuffer::play_back() -> void {
+  mSortedCommands.clear();
+  for (auto const& stream : mStreams) {
+    for (auto const& command : stream.commands) {
+      mSortedCommands.push_back(&command);
+    }
+  }
+
+  std::stable_sort(mSortedCommands.begin(), mSortedCommands.end(),
+                   [](Command const* l, Command const* r) {
+                     return l->sortKey < r->sortKey;
+                   });
+
+  for (auto const* command : mSortedCommands) {
+    command->apply(mEntities, command->payload);
+  }
+
+  for (auto& stream : mStreams) {
+    stream.clear();
+  }
+}
+
+auto EntityCommandBuffer::is_empty() const -> bool {
+  return std::all_of(mStreams.begin(), mStreams.end(),
+                     [](Stream const& stream) {
+                       return stream.commands.empty();
+                     });
+}
+
+auto EntityCommandBuffer::current_stream() -> Stream& {
+  return mStreams[JobSystem::global().thread_index()];
+}
+
+auto EntityCommandBuffer::Stream::allocate(uSize const size,
+                                           uSize const alignment) -> void* {
+  // new std::byte[] is aligned for every fundamental type
+  BASALT_ASSERT(alignment <= alignof(std::max_align_t));
+
+  if (size > BLOCK_SIZE) {
+    return largePayloads.emplace_back(new std::byte[size]).get();
+  }
+
+  offset = (offset + alignment - 1) & ~(alignment - 1);
+  if (blocks.empty() || offset + size > BLOCK_SIZE) {
+    if (!blocks.empty()) {
+      ++currentBlock;
+    }
+    if (currentBlock == blocks.size()) {
+      blocks.emplace_back(new std::byte[BLOCK_SIZE]);
+    }
+
+    offset = 0;
+  }
+
+  auto* const memory = blocks[currentBlock].get() + offset;
+  offset += size;
+
+  return memory;
+}
+
+// keeps the blocks to reuse them. The next recording starts at sort key 0
+auto EntityCommandBuffer::Stream::clear() -> void {
+  for (auto const& command : commands) {
+    command.destroy(command.payload);
+  }
+
+  commands.clear();
+  largePayloads.clear();
+  currentBlock = 0;
+  offset = 0;
+  sortKey = 0;
+}
+
+auto EntityCommandBuffer::Create::apply(EntityRegistry& entities) -> void {
+  entities.remove<ReservedEntity>(entity);
+}
+
+auto EntityCommandBuffer::Destroy::apply(EntityRegistry& entities) -> void {
+  entities.destroy(entity);
+}
+
+} // namespace basalt
@@ -0,0 +1,214 @@
+#pragma once
+
+#include <basalt/api/scene/ecs.h>
+#include <basalt/api/scene/types.h>
+
+#include <basalt/api/base/types.h>
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace basalt {
+
+// tags the entities of an EntityReserve which weren't created by a command yet
+struct ReservedEntity final {};
+
+// Entities created ahead of time to hand out their ids on any thread. They
+// have no components apart from the ReservedEntity tag. refill tops the
+// reserve up to twice the peak demand of any wave so far. take never touches
+// the registry, because other systems of the wave use it concurrently, so
+// running out of entities is fatal. Announce bursts of creations with reserve
+class EntityReserve final {
+public:
+  explicit EntityReserve(EntityRegistry&);
+
+  EntityReserve(EntityReserve const&) = delete;
+  EntityReserve(EntityReserve&&) = delete;
+
+  ~EntityReserve() noexcept = default;
+
+  auto operator=(EntityReserve const&) -> EntityReserve& = delete;
+  auto operator=(EntityReserve&&) -> EntityReserve& = delete;
+
+  // thread safe. Crashes if the reserve ran out
+  [[nodiscard]]
+  auto take() -> EntityId;
+
+  // not thread safe
+  auto refill() -> void;
+
+  // Makes sure that at least count entities can be taken until the next
+  // refill. Not thread safe, so call it while no systems run concurrently
+  auto reserve(u32 count) -> void;
+
+private:
+  static constexpr auto MIN_CAPACITY = u32{64};
+
+  EntityRegistry& mEntities;
+  std::vector<EntityId> mIds;
+  std::atomic<u32> mNumTaken{};
+  u32 mCapacity{MIN_CAPACITY};
+};
+
+// Records structural changes to the registry to apply them later at a point
+// where no system runs, e.g. from systems updated concurrently or from within
+// parallel_each. Recording is thread safe: every thread of the JobSystem
+// records into its own stream, whose commands are stored in a reused arena.
+//
+// Playback applies the commands ordered by sort key, and commands with the
+// same key in recording order. Use a key which is unique per thread, e.g.
+// the index of the entity in parallel_each, to get the same order in every
+// run. Commands on entities which were destroyed in the meantime are skipped
+class EntityCommandBuffer final {
+public:
+  EntityCommandBuffer(EntityRegistry&, EntityReserve&);
+
+  EntityCommandBuffer(EntityCommandBuffer const&) = delete;
+  EntityCommandBuffer(EntityCommandBuffer&&) = delete;
+
+  ~EntityCommandBuffer() noexcept;
+
+  auto operator=(EntityCommandBuffer const&) -> EntityCommandBuffer& = delete;
+  auto operator=(EntityCommandBuffer&&) -> EntityCommandBuffer& = delete;
+
+  // the key of the following commands of the calling thread
+  auto set_sort_key(u32) -> void;
+
+  // The id is reserved immediately and can be stored in components of other
+  // commands. The entity gets its components on playback
+  [[nodiscard]]
+  auto create() -> EntityId;
+
+  auto destroy(EntityId) -> void;
+
+  // adds or replaces the component
+  template <typename T, typename... Args>
+  auto emplace(EntityId const entity, Args&&... args) -> void {
+    record<Emplace<T>>(entity, make<T>(std::forward<Args>(args)...));
+  }
+
+  // replaces the component, which triggers the update signals
+  template <typename T, typename... Args>
+  auto replace(EntityId const entity, Args&&... args) -> void {
+    record<Replace<T>>(entity, make<T>(std::forward<Args>(args)...));
+  }
+
+  template <typename T>
+  auto remove(EntityId const entity) -> void {
+    record<Remove<T>>(entity);
+  }
+
+  // not thread safe
+  auto play_back() -> void;
+
+  [[nodiscard]]
+  auto is_empty() const -> bool;
+
+private:
+  static constexpr auto BLOCK_SIZE = uSize{16 * 1024};
+
+  struct Command final {
+    void (*apply)(EntityRegistry&, void* payload);
+    void (*destroy)(void* payload);
+    void* payload;
+    u32 sortKey;
+  };
+
+  // commands of one thread. Aligned to not share cache lines
+  struct alignas(64) Stream final {
+    std::vector<std::unique_ptr<std::byte[]>> blocks;
+    // payloads larger than a block. Freed on playback
+    std::vector<std::unique_ptr<std::byte[]>> largePayloads;
+    uSize currentBlock{};
+    uSize offset{};
+    std::vector<Command> commands;
+    u32 sortKey{};
+
+    auto allocate(uSize size, uSize alignment) -> void*;
+    auto clear() -> void;
+  };
+
+  struct Create final {
+    EntityId entity;
+
+    auto apply(EntityRegistry&) -> void;
+  };
+
+  struct Destroy final {
+    EntityId entity;
+
+    auto apply(EntityRegistry&) -> void;
+  };
+
+  template <typename T>
+  struct Emplace final {
+    EntityId entity;
+    T component;
+
+    auto apply(EntityRegistry& entities) -> void {
+      entities.emplace_or_replace<T>(entity, std::move(component));
+    }
+  };
+
+  template <typename T>
+  struct Replace final {
+    EntityId entity;
+    T component;
+
+    auto apply(EntityRegistry& entities) -> void {
+      entities.replace<T>(entity, std::move(component));
+    }
+  };
+
+  template <typename T>
+  struct Remove final {
+    EntityId entity;
+
+    auto apply(EntityRegistry& entities) -> void {
+      entities.remove<T>(entity);
+    }
+  };
+
+  EntityRegistry& mEntities;
+  EntityReserve& mReserve;
+  // indexed by the thread index of the JobSystem
+  std::vector<Stream> mStreams;
+  // reused by play_back
+  std::vector<Command const*> mSortedCommands;
+
+  template <typename T, typename... Args>
+  static auto make(Args&&... args) -> T {
+    if constexpr (std::is_aggregate_v<T>) {
+      return T{std::forward<Args>(args)...};
+    } else {
+      return T(std::forward<Args>(args)...);
+    }
+  }
+
+  template <typename Payload, typename... Args>
+  auto record(Args&&... args) -> void {
+    auto& stream = current_stream();
+    auto* const memory = stream.allocate(sizeof(Payload), alignof(Payload));
+    auto* const payload = new (memory) Payload{std::forward<Args>(args)...};
+
+    stream.commands.push_back(Command{
+      [](EntityRegistry& entities, void* const p) {
+        auto& command = *static_cast<Payload*>(p);
+        if (entities.valid(command.entity)) {
+          command.apply(entities);
+        }
+      },
+      [](void* const p) { static_cast<Payload*>(p)->~Payload(); }, payload,
+      stream.sortKey});
+  }
+
+  [[nodiscard]]
+  auto current_stream() -> Stream&;
+};
+
+} // namespace basalt
@@ -0,0 +1,67 @@
+#include <basalt/api/scene/entity_pool.h>
+
+#include <basalt/api/scene/ecs.h>
+#include <basalt/api/scene/scene.h>
+
+#include <basalt/api/base/asserts.h>
+
+#include <algorithm>
+#include <utility>
+
+namespace basalt {
+
+EntityPool::EntityPool(Scene& scene, Prefab prefab, u32 const capacity)
+  : mScene{scene}, mPrefab{std::move(prefab)} {
+  grow(capacity);
+}
+
+auto EntityPool::acquire() -> EntityId {
+  if (mInactive.empty()) {
+    grow(std::max(mNumEntities, MIN_GROWTH));
+  }
+
+  auto const entity = mInactive.back();
+  mInactive.pop_back();
+  mScene.entity_registry().remove<Inactive>(entity);
+
+  auto const numActive = mNumEntities - static_cast<u32>(mInactive.size());
+  mPeakActive = std::max(mPeakActive, numActive);
+
+  return entity;
+}
+
+auto EntityPool::release(EntityId const entity) -> void {
+  auto& entities = mScene.entity_registry();
+  BASALT_ASSERT(entities.valid(entity) && !entities.all_of<Inactive>(entity),
+                "entity isn't active");
+
+  entities.emplace<Inactive>(entity);
+  mInactive.push_back(entity);
+}
+
+auto EntityPool::release(gsl::span<EntityId const> const ids) -> void {
+  auto& entities = mScene.entity_registry();
+  for (auto const entity : ids) {
+    BASALT_ASSERT(entities.valid(entity) && !entities.all_of<Inactive>(entity),
+                  "entity isn't active");
+  }
+
+  entities.insert<Inactive>(ids.begin(), ids.end());
+  mInactive.insert(mInactive.end(), ids.begin(), ids.end());
+}
+
+auto EntityPool::occupancy() const -> Occupancy {
+  auto const numInactive = static_cast<u32>(mInactive.size());
+
+  return Occupancy{mNumEntities - numInactive, numInactive, mPeakActive};
+}
+
+auto EntityPool::grow(u32 const count) -> void {
+  auto const ids = mScene.create_entities(count, mPrefab);
+  mScene.entity_registry().insert<Inactive>(ids.begin(), ids.end());
+
+  mInactive.insert(mInactive.end(), ids.begin(), ids.end());
+  mNumEntities += count;
+}
+
+} // namespace basalt
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <basalt/api/scene/prefab.h>
+#include <basalt/api/scene/types.h>
+
+#include <basalt/api/base/types.h>
+
+#include <gsl/span>
+
+#include <vector>
+
+namespace basalt {
+
+// Recycles the instances of a prefab instead of creating and destroying them,
+// e.g. for projectiles or effects. Released entities keep their components and
+// are only tagged as Inactive, so acquiring one just removes the tag, which
+// moves it back into the groups of the systems in constant time. The pool
+// grows in bulk when it runs dry.
+//
+// Components which were added after acquiring an entity are kept as well
+class EntityPool final {
+public:
+  struct Occupancy final {
+    u32 numActive{};
+    u32 numInactive{};
+    // the most entities acquired at once
+    u32 peakActive{};
+  };
+
+  // creates capacity inactive instances up front
+  EntityPool(Scene&, Prefab, u32 capacity);
+
+  EntityPool(EntityPool const&) = delete;
+  EntityPool(EntityPool&&) = delete;
+
+  ~EntityPool() noexcept = default;
+
+  auto operator=(EntityPool const&) -> EntityPool& = delete;
+  auto operator=(EntityPool&&) -> EntityPool& = delete;
+
+  // The components keep the values they had when the entity was released, so
+  // set the ones which matter, e.g. the Transform
+  [[nodiscard]]
+  auto acquire() -> EntityId;
+
+  // the entity must have been acquired from this pool
+  auto release(EntityId) -> void;
+
+  // the entities must have been acquired from this pool
+  auto release(gsl::span<EntityId const>) -> void;
+
+  [[nodiscard]]
+  auto occupancy() const -> Occupancy;
+
+private:
+  static constexpr auto MIN_GROWTH = u32{64};
+
+  Scene& mScene;
+  Prefab mPrefab;
+  std::vector<EntityId> mInactive;
+  u32 mNumEntities{};
+  u32 mPeakActive{};
+
+  auto grow(u32 count) -> void;
+};
+
+} // namespace basalt
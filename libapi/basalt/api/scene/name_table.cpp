@@ -0,0 +1,45 @@
+#include <basalt/api/scene/name_table.h>
+
+#include <basalt/api/base/asserts.h>
+
+#include <fmt/format.h>
+
+namespace basalt {
+
+auto NameTable::intern(std::string_view const name) -> NameId {
+  if (auto const it = mIndex.find(name); it != mIndex.end()) {
+    return it->second;
+  }
+
+  auto const id = NameId{static_cast<NameId::ValueType>(mNames.size())};
+  auto const& stored = mNames.emplace_back(name);
+  mIndex.emplace(stored, id);
+
+  return id;
+}
+
+auto NameTable::find(std::string_view const name) const -> NameId {
+  auto const it = mIndex.find(name);
+
+  return it != mIndex.end() ? it->second : NameId{};
+}
+
+auto NameTable::get(NameId const id) const -> std::string_view {
+  BASALT_ASSERT(id && id.value() < mNames.size(), "invalid name id");
+
+  return mNames[id.value()];
+}
+
+auto NameTable::format(EntityName const& name) const -> std::string {
+  if (name.number == 0) {
+    return std::string{get(name.base)};
+  }
+
+  return fmt::format(FMT_STRING("{} {}"), get(name.base), name.number);
+}
+
+auto NameTable::size() const -> uSize {
+  return mNames.size();
+}
+
+} // namespace basalt
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <basalt/api/scene/types.h>
+
+#include <basalt/api/base/types.h>
+
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace basalt {
+
+// Stores every distinct name once and hands out stable ids for them. Interning
+// the same name again returns the same id
+class NameTable final {
+public:
+  // returns the id of an equal name if there is one
+  auto intern(std::string_view) -> NameId;
+
+  // null if the name was never interned
+  [[nodiscard]]
+  auto find(std::string_view) const -> NameId;
+
+  [[nodiscard]]
+  auto get(NameId) const -> std::string_view;
+
+  // the base name followed by the number, unless it's 0
+  [[nodiscard]]
+  auto format(EntityName const&) const -> std::string;
+
+  [[nodiscard]]
+  auto size() const -> uSize;
+
+private:
+  // a deque never moves its elements, so the keys of the index stay valid
+  std::deque<std::string> mNames;
+  std::unordered_map<std::string_view, NameId> mIndex;
+};
+
+} // namespace basalt
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <basalt/api/scene/ecs.h>
+#include <basalt/api/scene/types.h>
+
+#include <basalt/api/base/job_system.h>
+#include <basalt/api/base/types.h>
+
+#include <gsl/span>
+
+#include <algorithm>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace basalt {
+
+// number of entities of a view processed by one job at least
+inline constexpr auto DEFAULT_GRAIN_SIZE = u32{1024};
+
+namespace detail {
+
+// calls function(entity, components...) or function(components...) like
+// view.each for the entity at index i of the leading storage of the view
+template <typename View, typename F>
+auto invoke_at(View const& view, uSize const i, F const& function)
+  -> decltype(auto) {
+  auto const entity = view.handle()->data()[i];
+
+  return std::apply(
+    [&](auto&&... components) -> decltype(auto) {
+      if constexpr (std::is_invocable_v<F const&, EntityId,
+                                        decltype(components)...>) {
+        return function(entity,
+                        std::forward<decltype(components)>(components)...);
+      } else {
+        return function(std::forward<decltype(components)>(components)...);
+      }
+    },
+    view.get(entity));
+}
+
+template <typename View>
+auto leading_size(View const& view) -> u32 {
+  auto const* leading = view.handle();
+
+  return leading ? static_cast<u32>(leading->size()) : 0;
+}
+
+} // namespace detail
+
+// Like view.each, but splits the leading storage of the view into contiguous
+// ranges which are processed on the threads of the JobSystem. The function may
+// write to the components it's called with, but must not touch the components
+// of other entities or create/destroy entities and components. The order in
+// which entities are visited is unspecified
+template <typename View, typename F>
+auto parallel_each(View const& view, F const& function,
+                   u32 const grainSize = DEFAULT_GRAIN_SIZE) -> void {
+  JobSystem::global().parallel_for(
+    detail::leading_size(view), grainSize,
+    [&](u32 const begin, u32 const end) {
+      for (auto i = begin; i < end; ++i) {
+        if (view.contains(view.handle()->data()[i])) {
+          detail::invoke_at(view, i, function);
+        }
+      }
+    });
+}
+
+// Calls function(index, components...) for every entity of ids on the threads
+// of the JobSystem, with index being its position in ids. Every entity must
+// have all Components, e.g. the instances returned by Scene::create_entities.
+// The storages are looked up once before the jobs start. The same restrictions
+// as for parallel_each apply
+template <typename... Components, typename F>
+auto parallel_for_entities(EntityRegistry& entities,
+                           gsl::span<EntityId const> const ids,
+                           F const& function,
+                           u32 const grainSize = DEFAULT_GRAIN_SIZE) -> void {
+  auto const storages = std::forward_as_tuple(
+    entities.storage<std::remove_const_t<Components>>()...);
+
+  JobSystem::global().parallel_for(
+    static_cast<u32>(ids.size()), grainSize,
+    [&](u32 const begin, u32 const end) {
+      for (auto i = begin; i < end; ++i) {
+        std::apply(
+          [&](auto&... storage) { function(i, storage.get(ids[i])...); },
+          storages);
+      }
+    });
+}
+
+// Maps every entity of the view to a T and combines the results, starting
+// with identity. The entities are reduced in chunks of grainSize, which are
+// combined in order after all of them are done. The chunks don't depend on the
+// number of threads or how the work was distributed, so the result is the same
+// in every run, even for non-associative operations like adding floats.
+//
+// map is called like the function of parallel_each and combine(T, T) -> T
+template <typename T, typename View, typename Map, typename Combine>
+auto parallel_reduce(View const& view, T identity, Map const& map,
+                     Combine const& combine,
+                     u32 const grainSize = DEFAULT_GRAIN_SIZE) -> T {
+  auto const size = detail::leading_size(view);
+  auto const chunkSize = std::max(grainSize, 1u);
+  auto const numChunks = (size + chunkSize - 1) / chunkSize;
+
+  auto chunkResults = std::vector<T>(numChunks, identity);
+
+  JobSystem::global().parallel_for(
+    numChunks, 1, [&](u32 const firstChunk, u32 const lastChunk) {
+      for (auto chunk = firstChunk; chunk < lastChunk; ++chunk) {
+        auto& result = chunkResults[chunk];
+        auto const end = std::min((chunk + 1) * chunkSize, size);
+
+        for (auto i = chunk * chunkSize; i < end; ++i) {
+          if (view.contains(view.handle()->data()[i])) {
+            result = combine(std::move(result),
+                             detail::invoke_at(view, i, map));
+          }
+        }
+      }
+    });
+
+  for (auto& chunkResult : chunkResults) {
+    identity = combine(std::move(identity), std::move(chunkResult));
+  }
+
+  return identity;
+}
+
+} // namespace basalt
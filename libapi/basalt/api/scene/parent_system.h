@@ -2,13 +2,53 @@
 
 #include <basalt/api/scene/system.h>
 
+#include <basalt/api/scene/types.h>
+
 namespace basalt {
 
+// Maintains the Children of the parents and the ChildLinks of their children
+// from the construct, update and destroy signals of Parent. Nothing is done
+// per frame. Modify Parent with replace or patch to notify the system. The
+// children of a destroyed parent lose their Parent.
+//
+// A child leaves the list of its parent when its ChildLinks are destroyed, not
+// its Parent. Destroying an entity removes its components in the reverse order
+// in which their storages were created, so its ChildLinks may already be gone
+// when Parent is removed
 class ParentSystem final : public System {
 public:
-  ParentSystem() noexcept = default;
+  // the hierarchy is updated by the signals of whoever modifies Parent
+  using Reads = entt::type_list<>;
+  using Writes = entt::type_list<>;
+
+  explicit ParentSystem(EntityRegistry&);
+
+  ParentSystem(ParentSystem const&) = delete;
+  ParentSystem(ParentSystem&&) = delete;
+
+  ~ParentSystem() noexcept override;
+
+  auto operator=(ParentSystem const&) -> ParentSystem& = delete;
+  auto operator=(ParentSystem&&) -> ParentSystem& = delete;
 
   auto on_update(UpdateContext const&) -> void override;
+
+private:
+  EntityRegistry& mEntities;
+
+  auto on_parent_construct(EntityRegistry&, EntityId) -> void;
+  auto on_parent_update(EntityRegistry&, EntityId) -> void;
+  auto on_parent_destroy(EntityRegistry&, EntityId) -> void;
+  auto on_children_destroy(EntityRegistry&, EntityId) -> void;
+  auto on_child_links_destroy(EntityRegistry&, EntityId) -> void;
+
+  auto link(EntityId child, EntityId parent) -> void;
+  auto unlink(EntityId child) -> void;
+
+#if BASALT_IS_DEV_BUILD
+  // asserts that the list of children of the parent is consistent
+  auto validate_children(EntityId parent) const -> void;
+#endif
 };
 
 } // namespace basalt
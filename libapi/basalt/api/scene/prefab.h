@@ -0,0 +1,63 @@
+#pragma once
+
+#include <basalt/api/scene/ecs.h>
+#include <basalt/api/scene/transform.h>
+#include <basalt/api/scene/types.h>
+
+#include <gsl/span>
+
+#include <functional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace basalt {
+
+// Template of the entities created by Scene::create_entities. Every instance
+// gets a copy of each added component plus the transform and a LocalToWorld
+class Prefab final {
+public:
+  Transform transform;
+
+  template <typename T>
+  auto add(T component) -> Prefab& {
+    static_assert(!std::is_same_v<T, Transform> &&
+                    !std::is_same_v<T, LocalToWorld>,
+                  "set the transform member instead");
+
+    mInserters.emplace_back(
+      [component = std::move(component)](
+        EntityRegistry& entities, gsl::span<EntityId const> const ids) {
+        auto& storage = entities.storage<T>();
+        storage.reserve(storage.size() + ids.size());
+        entities.insert<T>(ids.begin(), ids.end(), component);
+      });
+
+    return *this;
+  }
+
+  // adds the components to the entities, which must not have any of them.
+  // Every storage grows at most once
+  auto instantiate(EntityRegistry& entities,
+                   gsl::span<EntityId const> const ids) const -> void {
+    auto& localToWorlds = entities.storage<LocalToWorld>();
+    localToWorlds.reserve(localToWorlds.size() + ids.size());
+    entities.insert<LocalToWorld>(ids.begin(), ids.end());
+
+    auto& transforms = entities.storage<Transform>();
+    transforms.reserve(transforms.size() + ids.size());
+    entities.insert<Transform>(ids.begin(), ids.end(), transform);
+
+    for (auto const& insert : mInserters) {
+      insert(entities, ids);
+    }
+  }
+
+private:
+  using Inserter =
+    std::function<void(EntityRegistry&, gsl::span<EntityId const>)>;
+
+  std::vector<Inserter> mInserters;
+};
+
+} // namespace basalt
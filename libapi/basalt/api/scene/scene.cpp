@@ -1,19 +1,25 @@
 #include "scene.h"
 
+#include "bounds.h"
+#include "bounds_system.h"
 #include "parent_system.h"
+#include "prefab.h"
 #include "transform.h"
 #include "transform_system.h"
 
 #include "basalt/api/base/asserts.h"
+#include "basalt/api/base/job_system.h"
 #include "basalt/api/base/types.h"
 
 #include <entt/graph/adjacency_matrix.hpp>
 
 #include <algorithm>
-#include <cmath>
+#include <charconv>
 #include <forward_list>
 #include <iterator>
 #include <memory>
+#include <string>
+#include <string_view>
 #include <utility>
 
 using entt::adjacency_matrix;
@@ -59,12 +65,18 @@ auto depth_first_search(uSize const vertex, AdjacencyMatrix const& adj,
 
 auto Scene::create() -> ScenePtr {
   auto scene = std::make_shared<Scene>();
-  scene->create_system<ParentSystem>();
-  scene->create_system<TransformSystem>();
+  scene->create_system<ParentSystem>(scene->entity_registry());
+  scene->create_system<TransformSystem>(scene->entity_registry());
+  scene->create_system<BoundsSystem>();
 
   return scene;
 }
 
+Scene::Scene() {
+  mEntityRegistry.on_destroy<SpatialIndexProxy>()
+    .connect<&Scene::on_spatial_index_proxy_destroy>(*this);
+}
+
 auto Scene::entity_registry() const -> EntityRegistry const& {
   return mEntityRegistry;
 }
@@ -73,11 +85,28 @@ auto Scene::entity_registry() -> EntityRegistry& {
   return mEntityRegistry;
 }
 
-auto Scene::create_entity(std::string name, Vector3f32 const& position,
+auto Scene::spatial_index() const -> AabbTree const& {
+  return mSpatialIndex;
+}
+
+auto Scene::spatial_index() -> AabbTree& {
+  return mSpatialIndex;
+}
+
+auto Scene::entity_reserve() -> EntityReserve& {
+  return mEntityReserve;
+}
+
+auto Scene::names() const -> NameTable const& {
+  return mNames;
+}
+
+auto Scene::create_entity(std::string_view const name,
+                          Vector3f32 const& position,
                           Vector3f32 const& rotation, Vector3f32 const& scale)
   -> Entity {
   auto entity = create_entity(position, rotation, scale);
-  entity.emplace<EntityName>(std::move(name));
+  set_entity_name(entity.entity(), name);
 
   return entity;
 }
@@ -92,27 +121,143 @@ auto Scene::create_entity(Vector3f32 const& position,
   return Entity{mEntityRegistry, id};
 }
 
+auto Scene::create_entities(uSize const count, Prefab const& prefab)
+  -> std::vector<EntityId> {
+  auto ids = std::vector<EntityId>(count);
+  mEntityRegistry.create(ids.begin(), ids.end());
+  prefab.instantiate(mEntityRegistry, ids);
+
+  return ids;
+}
+
+auto Scene::create_entities(uSize const count, Prefab const& prefab,
+                            std::string_view const baseName)
+  -> std::vector<EntityId> {
+  auto ids = create_entities(count, prefab);
+
+#if BASALT_STRIP_ENTITY_NAMES
+  static_cast<void>(baseName);
+#else
+  auto const base = mNames.intern(baseName);
+  auto names = std::vector<EntityName>(count);
+  for (auto i = uSize{0}; i < count; ++i) {
+    names[i] = EntityName{base, static_cast<u32>(i + 1)};
+  }
+
+  mEntityRegistry.insert<EntityName>(ids.begin(), ids.end(), names.begin());
+#endif
+
+  return ids;
+}
+
+auto Scene::destroy_entities(gsl::span<EntityId const> const ids) -> void {
+  mEntityRegistry.destroy(ids.begin(), ids.end());
+}
+
 auto Scene::get_handle(EntityId const entity) -> Entity {
   return Entity{mEntityRegistry, entity};
 }
 
+auto Scene::set_entity_name(EntityId const entity,
+                            std::string_view const baseName, u32 const number)
+  -> void {
+#if BASALT_STRIP_ENTITY_NAMES
+  static_cast<void>(entity);
+  static_cast<void>(baseName);
+  static_cast<void>(number);
+#else
+  mEntityRegistry.emplace_or_replace<EntityName>(
+    entity, mNames.intern(baseName), number);
+#endif
+}
+
+auto Scene::entity_name(EntityId const entity) const -> std::string {
+  auto const* name = mEntityRegistry.try_get<EntityName const>(entity);
+
+  return name ? mNames.format(*name) : std::string{};
+}
+
+auto Scene::find_entity(std::string_view const name) const -> EntityId {
+  auto const findWith = [&](NameId const base, u32 const number) {
+    for (auto const [entity, entityName] :
+         mEntityRegistry.view<EntityName const>().each()) {
+      if (entityName.base == base && entityName.number == number) {
+        return entity;
+      }
+    }
+
+    return EntityId{entt::null};
+  };
+
+  if (auto const base = mNames.find(name)) {
+    if (auto const entity = findWith(base, 0); entity != entt::null) {
+      return entity;
+    }
+  }
+
+  // "base number"
+  auto const space = name.rfind(' ');
+  if (space == std::string_view::npos) {
+    return entt::null;
+  }
+
+  auto number = u32{};
+  auto const* const last = name.data() + name.size();
+  auto const [end, error] =
+    std::from_chars(name.data() + space + 1, last, number);
+  if (error != std::errc{} || end != last || number == 0) {
+    return entt::null;
+  }
+
+  auto const base = mNames.find(name.substr(0, space));
+
+  return base ? findWith(base, number) : EntityId{entt::null};
+}
+
 auto Scene::destroy_system(SystemId const id) -> void {
   auto const typeId = mSystemIdToSystemType[id];
   mSystemTypes.at(typeId).id = nullhdl;
   mSystemIdToSystemType.erase(id);
   mSystems.destroy(id);
+  mCommandBuffers.erase(id);
 
   mUpdateOrder.erase(std::remove(mUpdateOrder.begin(), mUpdateOrder.end(), id),
                      mUpdateOrder.end());
+  mUpdateWaves = compute_update_waves();
 }
 
 auto Scene::on_update(UpdateContext const& ctx) -> void {
   mTime += ctx.deltaTime;
 
-  for (auto const systemId : mUpdateOrder) {
-    auto const systemCtx = System::UpdateContext{ctx.deltaTime, mTime, *this};
+  auto const update = [&](SystemId const id) {
+    mSystems[id]->on_update(System::UpdateContext{
+      ctx.deltaTime, mTime, *this, *mCommandBuffers.at(id)});
+  };
+
+  auto& jobSystem = JobSystem::global();
+
+  for (auto const& wave : mUpdateWaves) {
+    if (wave.size() == 1) {
+      update(wave.front());
+    } else {
+      auto& waveJob = jobSystem.create_job([] {});
+      for (auto i = uSize{1}; i < wave.size(); ++i) {
+        jobSystem.run(jobSystem.create_child_job(
+          waveJob, [&update, id = wave[i]] { update(id); }));
+      }
+      jobSystem.run(waveJob);
+
+      update(wave.front());
+
+      jobSystem.wait(waveJob);
+    }
 
-    mSystems[systemId]->on_update(systemCtx);
+    // sync point: in update order to play back the commands deterministically
+    for (auto const id : wave) {
+      mCommandBuffers.at(id)->play_back();
+    }
+
+    mEntityReserve.refill();
   }
 }
 
@@ -127,13 +272,26 @@ auto Scene::add_system(SystemPtr system, SystemInfo const& info) -> SystemId {
 
   auto const id = mSystems.emplace(std::move(system));
   mSystemIdToSystemType[id] = info.typeId;
-  mSystemTypes[info.typeId].id = id;
+  mCommandBuffers[id] =
+    std::make_unique<EntityCommandBuffer>(mEntityRegistry, mEntityReserve);
+
+  auto& typeInfo = mSystemTypes[info.typeId];
+  typeInfo.id = id;
+  typeInfo.declaresAccess = info.declaresAccess;
+  typeInfo.reads = info.reads;
+  typeInfo.writes = info.writes;
 
   mUpdateOrder = compute_update_order();
+  mUpdateWaves = compute_update_waves();
 
   return id;
 }
 
+auto Scene::on_spatial_index_proxy_destroy(EntityRegistry& entities,
+                                           EntityId const entity) -> void {
+  mSpatialIndex.destroy_proxy(entities.get<SpatialIndexProxy const>(entity).id);
+}
+
 // this topologically sorts the systems + their dependencies as a DAG
 auto Scene::compute_update_order() const -> vector<SystemId> {
   auto const allSystems = vector(mSystems.begin(), mSystems.end());
@@ -151,8 +309,7 @@ auto Scene::compute_update_order() const -> vector<SystemId> {
     return map;
   }();
 
-  auto const numSystems = static_cast<uSize>(
-    std::abs(std::distance(mSystems.begin(), mSystems.end())));
+  auto const numSystems = mSystems.size();
   // lhs -> rhs means lhs updates before rhs
   auto systemUpdateDag = adjacency_matrix<directed_tag>{numSystems};
 
@@ -195,4 +352,58 @@ auto Scene::compute_update_order() const -> vector<SystemId> {
   return updateOrder;
 }
 
+// Assigns every system to the first wave after all the systems before it in
+// the update order which it depends on or conflicts with. The explicit order
+// of the systems is kept, because dependencies are always earlier in the
+// update order
+auto Scene::compute_update_waves() const -> vector<vector<SystemId>> {
+  auto const typeInfo = [&](SystemId const id) -> SystemTypeInfo const& {
+    return mSystemTypes.at(mSystemIdToSystemType.at(id));
+  };
+
+  auto const intersects = [](vector<entt::id_type> const& l,
+                             vector<entt::id_type> const& r) {
+    return std::any_of(l.begin(), l.end(), [&](entt::id_type const type) {
+      return std::find(r.begin(), r.end(), type) != r.end();
+    });
+  };
+
+  auto const conflict = [&](SystemTypeInfo const& l, SystemTypeInfo const& r) {
+    if (!l.declaresAccess || !r.declaresAccess) {
+      return true;
+    }
+
+    return intersects(l.writes, r.writes) || intersects(l.writes, r.reads) ||
+           intersects(l.reads, r.writes);
+  };
+
+  auto waves = vector<vector<SystemId>>{};
+  auto waveOf = vector<uSize>(mUpdateOrder.size());
+
+  for (auto i = uSize{0}; i < mUpdateOrder.size(); ++i) {
+    auto const systemType = mSystemIdToSystemType.at(mUpdateOrder[i]);
+    auto const& info = typeInfo(mUpdateOrder[i]);
+
+    auto wave = uSize{0};
+    for (auto j = uSize{0}; j < i; ++j) {
+      auto const& earlier = typeInfo(mUpdateOrder[j]);
+      auto const& after = earlier.updatedAfter;
+      auto const isDependency =
+        std::find(after.begin(), after.end(), systemType) != after.end();
+
+      if (isDependency || conflict(earlier, info)) {
+        wave = std::max(wave, waveOf[j] + 1);
+      }
+    }
+
+    waveOf[i] = wave;
+    if (wave == waves.size()) {
+      waves.emplace_back();
+    }
+    waves[wave].push_back(mUpdateOrder[i]);
+  }
+
+  return waves;
+}
+
 } // namespace basalt
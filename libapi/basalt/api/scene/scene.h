@@ -1,6 +1,9 @@
 #pragma once
 
+#include <basalt/api/scene/aabb_tree.h>
+#include <basalt/api/scene/command_buffer.h>
 #include <basalt/api/scene/ecs.h>
+#include <basalt/api/scene/name_table.h>
 #include <basalt/api/scene/system.h>
 #include <basalt/api/scene/types.h>
 
@@ -9,11 +12,16 @@
 
 #include <basalt/api/math/vector3.h>
 
+#include <basalt/api/base/types.h>
+
 #include <entt/core/fwd.hpp>
 #include <entt/core/type_info.hpp>
+#include <entt/core/type_traits.hpp>
+#include <gsl/span>
 
 #include <memory>
 #include <string>
+#include <string_view>
 #include <type_traits>
 #include <unordered_map>
 #include <utility>
@@ -21,11 +29,39 @@
 
 namespace basalt {
 
+namespace detail {
+
+// List is void if the system didn't declare its access
+template <typename List>
+struct ComponentAccess final {
+  static auto type_ids() -> std::vector<entt::id_type> {
+    return {};
+  }
+
+  static auto assure_storage(EntityRegistry&) -> void {
+  }
+};
+
+template <typename... Components>
+struct ComponentAccess<entt::type_list<Components...>> final {
+  static auto type_ids() -> std::vector<entt::id_type> {
+    return {entt::type_hash<std::remove_const_t<Components>>::value()...};
+  }
+
+  // creating the storage of a component isn't thread safe, so it's done
+  // before systems are updated concurrently
+  static auto assure_storage(EntityRegistry& entities) -> void {
+    (entities.storage<std::remove_const_t<Components>>(), ...);
+  }
+};
+
+} // namespace detail
+
 class Scene final {
 public:
   static auto create() -> ScenePtr;
 
-  Scene() = default;
+  Scene();
 
   Scene(Scene const&) = delete;
   Scene(Scene&&) = delete;
@@ -41,8 +77,25 @@ public:
   [[nodiscard]]
   auto entity_registry() -> EntityRegistry&;
 
+  // world space bounds of the entities with LocalBounds. Updated by the
+  // BoundsSystem. Systems accessing it declare SpatialIndex
   [[nodiscard]]
-  auto create_entity(std::string name,
+  auto spatial_index() const -> AabbTree const&;
+
+  [[nodiscard]]
+  auto spatial_index() -> AabbTree&;
+
+  // hands out the ids of the entities created by EntityCommandBuffers.
+  // Refilled after every wave of systems
+  [[nodiscard]]
+  auto entity_reserve() -> EntityReserve&;
+
+  // the names of the entities. Empty if names are stripped
+  [[nodiscard]]
+  auto names() const -> NameTable const&;
+
+  [[nodiscard]]
+  auto create_entity(std::string_view name,
                      Vector3f32 const& position = Vector3f32{},
                      Vector3f32 const& rotation = Vector3f32{},
                      Vector3f32 const& scale = Vector3f32{1.0f}) -> Entity;
@@ -52,8 +105,38 @@ public:
                      Vector3f32 const& rotation = Vector3f32{},
                      Vector3f32 const& scale = Vector3f32{1.0f}) -> Entity;
 
+  // Creates count instances of the prefab in bulk. The ids are created at
+  // once and every component storage grows at most once, which is much faster
+  // than creating the entities one by one. The instances have no EntityName.
+  // Use parallel_for_entities to initialize their components
+  [[nodiscard]]
+  auto create_entities(uSize count, Prefab const&) -> std::vector<EntityId>;
+
+  // names the instances "baseName 1" to "baseName count"
+  [[nodiscard]]
+  auto create_entities(uSize count, Prefab const&, std::string_view baseName)
+    -> std::vector<EntityId>;
+
+  // destroys the entities in bulk. Every storage removes the whole range at
+  // once instead of being visited for every entity
+  auto destroy_entities(gsl::span<EntityId const>) -> void;
+
   [[nodiscard]] auto get_handle(EntityId) -> Entity;
 
+  // replaces the EntityName. Does nothing if names are stripped
+  auto set_entity_name(EntityId, std::string_view baseName, u32 number = 0)
+    -> void;
+
+  // empty if the entity has no name
+  [[nodiscard]]
+  auto entity_name(EntityId) const -> std::string;
+
+  // the entity with the formatted name, e.g. "Cube 1234". The name is looked
+  // up in the NameTable, but the entities with names are searched linearly.
+  // Returns entt::null if there's no such entity
+  [[nodiscard]]
+  auto find_entity(std::string_view name) const -> EntityId;
+
   template <typename T, typename... Args>
   auto create_system(Args&&... args) -> SystemId {
     static_assert(std::is_base_of_v<System, T>);
@@ -66,10 +149,17 @@ public:
     auto constexpr updateBefore = entt::type_hash<UpdateBefore>::value();
     auto constexpr updateAfter = entt::type_hash<UpdateAfter>::value();
 
+    using Reads = detail::ComponentAccess<typename SystemTraits<T>::Reads>;
+    using Writes = detail::ComponentAccess<typename SystemTraits<T>::Writes>;
+    Reads::assure_storage(mEntityRegistry);
+    Writes::assure_storage(mEntityRegistry);
+
     auto system = std::make_unique<T>(std::forward<Args>(args)...);
 
     return add_system(std::move(system),
-                      SystemInfo{typeId, updateBefore, updateAfter});
+                      SystemInfo{typeId, updateBefore, updateAfter,
+                                 SystemTraits<T>::declaresAccess,
+                                 Reads::type_ids(), Writes::type_ids()});
   }
 
   auto destroy_system(SystemId) -> void;
@@ -88,6 +178,9 @@ private:
     SystemTypeId typeId;
     SystemTypeId updateBeforeTypeId;
     SystemTypeId updateAfterTypeId;
+    bool declaresAccess;
+    std::vector<entt::id_type> reads;
+    std::vector<entt::id_type> writes;
   };
 
   struct SystemTypeInfo final {
@@ -95,11 +188,23 @@ private:
     std::vector<SystemTypeId> updatedAfter;
     // might be SystemId::null() if there is no System of this type
     SystemId id;
+    bool declaresAccess{};
+    std::vector<entt::id_type> reads;
+    std::vector<entt::id_type> writes;
   };
 
+  // declared before the registry to outlive it
+  AabbTree mSpatialIndex;
+  NameTable mNames;
   EntityRegistry mEntityRegistry;
+  EntityReserve mEntityReserve{mEntityRegistry};
   HandlePool<SystemPtr, SystemId> mSystems;
+  // the commands of a system are played back after its wave
+  std::unordered_map<SystemId, std::unique_ptr<EntityCommandBuffer>>
+    mCommandBuffers;
   std::vector<SystemId> mUpdateOrder;
+  // the systems of a wave are updated concurrently. Waves are updated in order
+  std::vector<std::vector<SystemId>> mUpdateWaves;
   std::unordered_map<SystemId, SystemTypeId> mSystemIdToSystemType;
   std::unordered_map<SystemTypeId, SystemTypeInfo> mSystemTypes;
 
@@ -108,8 +213,13 @@ private:
   [[nodiscard]]
   auto add_system(SystemPtr, SystemInfo const&) -> SystemId;
 
+  auto on_spatial_index_proxy_destroy(EntityRegistry&, EntityId) -> void;
+
   [[nodiscard]]
   auto compute_update_order() const -> std::vector<SystemId>;
+
+  [[nodiscard]]
+  auto compute_update_waves() const -> std::vector<std::vector<SystemId>>;
 };
 
 } // namespace basalt
@@ -0,0 +1,224 @@
+#include <basalt/api/scene/spatial_hash_grid.h>
+
+#include <basalt/api/base/asserts.h>
+#include <basalt/api/base/job_system.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace basalt {
+
+namespace {
+
+// entries per job of the parallel passes of build. The results of the chunks
+// are combined in order, so the grid doesn't depend on how the work was
+// distributed
+constexpr auto CHUNK_SIZE = u32{1024};
+
+auto next_power_of_two(u32 const v) -> u32 {
+  auto result = u32{1};
+  while (result < v) {
+    result <<= 1;
+  }
+
+  return result;
+}
+
+} // namespace
+
+SpatialHashGrid::SpatialHashGrid(f32 const cellSize) : mCellSize{cellSize} {
+  BASALT_ASSERT(cellSize > 0.0f);
+}
+
+auto SpatialHashGrid::build(gsl::span<Entry const> const entries) -> void {
+  clear();
+
+  if (entries.empty()) {
+    return;
+  }
+
+  auto const numEntries = static_cast<u32>(entries.size());
+  mKeys.resize(numEntries);
+  mCells.resize(numEntries);
+
+  auto const numChunks = (numEntries + CHUNK_SIZE - 1) / CHUNK_SIZE;
+  mChunks.assign(numChunks, Chunk{});
+
+  auto& jobSystem = JobSystem::global();
+
+  // the keys hold the level of the entries until the buckets are known
+  jobSystem.parallel_for(
+    numChunks, 1, [&](u32 const firstChunk, u32 const lastChunk) {
+      for (auto c = firstChunk; c < lastChunk; ++c) {
+        auto& chunk = mChunks[c];
+        auto const begin = c * CHUNK_SIZE;
+        auto const end = std::min(begin + CHUNK_SIZE, numEntries);
+
+        chunk.boundsMin = entries[begin].position;
+        chunk.boundsMax = entries[begin].position;
+
+        for (auto i = begin; i < end; ++i) {
+          auto const& entry = entries[i];
+          mKeys[i] = level_of(entry.radius);
+
+          chunk.numEntries[mKeys[i]]++;
+          chunk.maxRadius[mKeys[i]] =
+            std::max(chunk.maxRadius[mKeys[i]], entry.radius);
+
+          auto const& p = entry.position;
+          chunk.boundsMin = Vector3f32{std::min(chunk.boundsMin.x(), p.x()),
+                                       std::min(chunk.boundsMin.y(), p.y()),
+                                       std::min(chunk.boundsMin.z(), p.z())};
+          chunk.boundsMax = Vector3f32{std::max(chunk.boundsMax.x(), p.x()),
+                                       std::max(chunk.boundsMax.y(), p.y()),
+                                       std::max(chunk.boundsMax.z(), p.z())};
+        }
+      }
+    });
+
+  mBoundsMin = mChunks[0].boundsMin;
+  mBoundsMax = mChunks[0].boundsMax;
+
+  for (auto const& chunk : mChunks) {
+    for (auto i = u32{0}; i < NUM_LEVELS; ++i) {
+      mLevels[i].numEntries += chunk.numEntries[i];
+      mLevels[i].maxRadius = std::max(mLevels[i].maxRadius, chunk.maxRadius[i]);
+    }
+
+    mBoundsMin = Vector3f32{std::min(mBoundsMin.x(), chunk.boundsMin.x()),
+                            std::min(mBoundsMin.y(), chunk.boundsMin.y()),
+                            std::min(mBoundsMin.z(), chunk.boundsMin.z())};
+    mBoundsMax = Vector3f32{std::max(mBoundsMax.x(), chunk.boundsMax.x()),
+                            std::max(mBoundsMax.y(), chunk.boundsMax.y()),
+                            std::max(mBoundsMax.z(), chunk.boundsMax.z())};
+  }
+
+  // at most one entry per bucket on average
+  auto numBuckets = u32{0};
+  for (auto i = u32{0}; i < NUM_LEVELS; ++i) {
+    auto& level = mLevels[i];
+    level.cellSize = mCellSize * static_cast<f32>(1u << i);
+    level.invCellSize = 1.0f / level.cellSize;
+    level.firstBucket = numBuckets;
+
+    if (level.numEntries > 0) {
+      auto const levelBuckets = next_power_of_two(level.numEntries);
+      level.mask = levelBuckets - 1;
+      numBuckets += levelBuckets;
+    }
+  }
+
+  jobSystem.parallel_for(
+    numEntries, CHUNK_SIZE, [&](u32 const begin, u32 const end) {
+      for (auto i = begin; i < end; ++i) {
+        auto const& level = mLevels[mKeys[i]];
+        auto const cell = cell_of(entries[i].position, level);
+
+        mCells[i] = cell;
+        mKeys[i] = level.firstBucket + (hash(cell) & level.mask);
+      }
+    });
+
+  // Counting sort by bucket. Counting and scattering stay serial: they're a
+  // single increment or copy per entry, while histograms per chunk would cost
+  // a pass over all buckets per chunk, and the scatter must keep the order of
+  // the entries stable
+  mBucketStarts.assign(uSize{numBuckets} + 1, 0);
+  for (auto const key : mKeys) {
+    mBucketStarts[key + 1]++;
+  }
+
+  for (auto bucket = uSize{0}; bucket < numBuckets; ++bucket) {
+    mBucketStarts[bucket + 1] += mBucketStarts[bucket];
+  }
+
+  mEntries.resize(numEntries);
+  mEntryCells.resize(numEntries);
+
+  mCursors.assign(mBucketStarts.begin(), mBucketStarts.end() - 1);
+  for (auto i = u32{0}; i < numEntries; ++i) {
+    auto const target = mCursors[mKeys[i]]++;
+    mEntries[target] = entries[i];
+    mEntryCells[target] = mCells[i];
+  }
+}
+
+auto SpatialHashGrid::clear() -> void {
+  mLevels = {};
+  mBucketStarts.clear();
+  mEntries.clear();
+  mEntryCells.clear();
+}
+
+auto SpatialHashGrid::cell_size() const -> f32 {
+  return mCellSize;
+}
+
+auto SpatialHashGrid::num_entries() const -> uSize {
+  return mEntries.size();
+}
+
+// Searches with a doubling radius until at least k entries are inside of it
+// or it contains all entries
+auto SpatialHashGrid::query_nearest(Vector3f32 const& center, uSize const k,
+                                    std::vector<Neighbor>& result,
+                                    f32 const maxDistance) const -> void {
+  result.clear();
+
+  if (k == 0 || mEntries.empty()) {
+    return;
+  }
+
+  // distance to the furthest corner of the bounds of all entries
+  auto const coverAll = [&] {
+    auto const dx = std::max(std::abs(center.x() - mBoundsMin.x()),
+                             std::abs(center.x() - mBoundsMax.x()));
+    auto const dy = std::max(std::abs(center.y() - mBoundsMin.y()),
+                             std::abs(center.y() - mBoundsMax.y()));
+    auto const dz = std::max(std::abs(center.z() - mBoundsMin.z()),
+                             std::abs(center.z() - mBoundsMax.z()));
+
+    return std::sqrt(dx * dx + dy * dy + dz * dz);
+  }();
+  auto const searchLimit = std::min(maxDistance, coverAll);
+
+  auto radius = std::min(mCellSize, searchLimit);
+  for (;;) {
+    result.clear();
+
+    auto const radiusSquared = radius * radius;
+    query_radius(center, radius, [&](Entry const& entry) {
+      auto const distanceSquared = (entry.position - center).length_squared();
+      if (distanceSquared <= radiusSquared) {
+        result.push_back(Neighbor{entry.entity, distanceSquared});
+      }
+    });
+
+    if (result.size() >= k || radius >= searchLimit) {
+      break;
+    }
+
+    radius = std::min(2.0f * radius, searchLimit);
+  }
+
+  auto const numResults = std::min(k, result.size());
+  std::partial_sort(result.begin(), result.begin() + numResults, result.end(),
+                    [](Neighbor const& l, Neighbor const& r) {
+                      return l.distanceSquared < r.distanceSquared;
+                    });
+  result.resize(numResults);
+}
+
+auto SpatialHashGrid::level_of(f32 const radius) const -> u32 {
+  auto const diameter = 2.0f * radius;
+  if (diameter <= mCellSize) {
+    return 0;
+  }
+
+  auto const level =
+    static_cast<u32>(std::ceil(std::log2(diameter / mCellSize)));
+
+  return std::min(level, NUM_LEVELS - 1);
+}
+
+} // namespace basalt
@@ -0,0 +1,204 @@
+#pragma once
+
+#include <basalt/api/scene/types.h>
+
+#include <basalt/api/math/vector3.h>
+
+#include <basalt/api/base/types.h>
+
+#include <entt/entity/entity.hpp>
+#include <gsl/span>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace basalt {
+
+// adds the entity to the SpatialHashGrid of its scene
+struct SpatialHashed final {
+  f32 radius{};
+};
+
+// Multi-level spatial hash grid of spheres. The cell size doubles with every
+// level and each entry is stored in the first level whose cells are at least
+// as large as its diameter. The entries of a level are sorted by hash bucket
+// (counting sort), so the entries of a cell are contiguous in memory.
+// Meant to be rebuilt every frame. The levels, cells and hashes of the entries
+// are computed in parallel on the JobSystem
+class SpatialHashGrid final {
+public:
+  static constexpr auto NUM_LEVELS = u32{8};
+
+  struct Entry final {
+    Vector3f32 position;
+    f32 radius{};
+    EntityId entity{entt::null};
+  };
+
+  struct Neighbor final {
+    EntityId entity{entt::null};
+    f32 distanceSquared{};
+  };
+
+  // cell size of the first level
+  explicit SpatialHashGrid(f32 cellSize = 1.0f);
+
+  auto build(gsl::span<Entry const>) -> void;
+
+  auto clear() -> void;
+
+  [[nodiscard]]
+  auto cell_size() const -> f32;
+
+  [[nodiscard]]
+  auto num_entries() const -> uSize;
+
+  // callback(Entry const&) for every entry overlapping the sphere
+  template <typename Callback>
+  auto query_radius(Vector3f32 const& center, f32 const radius,
+                    Callback&& callback) const -> void {
+    for (auto const& level : mLevels) {
+      if (level.numEntries == 0) {
+        continue;
+      }
+
+      auto const isOverlapping = [&](Entry const& entry) {
+        auto const maxDistance = radius + entry.radius;
+
+        return (entry.position - center).length_squared() <=
+               maxDistance * maxDistance;
+      };
+
+      auto const reach = radius + level.maxRadius;
+      auto const min = cell_of(center - Vector3f32{reach}, level);
+      auto const max = cell_of(center + Vector3f32{reach}, level);
+
+      auto const extent = [](i32 const lo, i32 const hi) {
+        return static_cast<f64>(hi) - static_cast<f64>(lo) + 1.0;
+      };
+      auto const numCells =
+        extent(min.x, max.x) * extent(min.y, max.y) * extent(min.z, max.z);
+
+      // scanning the whole level is cheaper than looking up all the cells
+      if (numCells >= level.numEntries) {
+        auto const begin = mBucketStarts[level.firstBucket];
+        for (auto i = begin; i < begin + level.numEntries; ++i) {
+          if (isOverlapping(mEntries[i])) {
+            callback(mEntries[i]);
+          }
+        }
+
+        continue;
+      }
+
+      for (auto z = min.z; z <= max.z; ++z) {
+        for (auto y = min.y; y <= max.y; ++y) {
+          for (auto x = min.x; x <= max.x; ++x) {
+            auto const cell = Cell{x, y, z};
+            auto const bucket = level.firstBucket + (hash(cell) & level.mask);
+
+            for (auto i = mBucketStarts[bucket]; i < mBucketStarts[bucket + 1];
+                 ++i) {
+              // different cells can share a bucket
+              if (mEntryCells[i] != cell) {
+                continue;
+              }
+
+              if (isOverlapping(mEntries[i])) {
+                callback(mEntries[i]);
+              }
+            }
+          }
+        }
+      }
+    }
+  }
+
+  // k entries with the nearest positions, nearest first. The result is
+  // cleared first
+  auto query_nearest(Vector3f32 const& center, uSize k,
+                     std::vector<Neighbor>& result,
+                     f32 maxDistance = std::numeric_limits<f32>::infinity())
+    const -> void;
+
+private:
+  struct Cell final {
+    i32 x{};
+    i32 y{};
+    i32 z{};
+
+    [[nodiscard]]
+    constexpr auto operator==(Cell const& rhs) const -> bool {
+      return x == rhs.x && y == rhs.y && z == rhs.z;
+    }
+
+    [[nodiscard]]
+    constexpr auto operator!=(Cell const& rhs) const -> bool {
+      return !(*this == rhs);
+    }
+  };
+
+  struct Level final {
+    f32 cellSize{};
+    f32 invCellSize{};
+    f32 maxRadius{};
+    // number of buckets - 1. The number of buckets is a power of two
+    u32 mask{};
+    u32 firstBucket{};
+    u32 numEntries{};
+  };
+
+  // per level statistics and bounds of a contiguous range of entries
+  struct Chunk final {
+    std::array<u32, NUM_LEVELS> numEntries{};
+    std::array<f32, NUM_LEVELS> maxRadius{};
+    Vector3f32 boundsMin;
+    Vector3f32 boundsMax;
+  };
+
+  f32 mCellSize;
+  std::array<Level, NUM_LEVELS> mLevels{};
+  // first entry of every bucket of every level + one past the last entry
+  std::vector<u32> mBucketStarts;
+  std::vector<Entry> mEntries;
+  std::vector<Cell> mEntryCells;
+  // of the positions of all entries
+  Vector3f32 mBoundsMin;
+  Vector3f32 mBoundsMax;
+
+  // reused between builds
+  std::vector<u32> mKeys;
+  std::vector<Cell> mCells;
+  std::vector<u32> mCursors;
+  std::vector<Chunk> mChunks;
+
+  [[nodiscard]]
+  static constexpr auto hash(Cell const& cell) -> u32 {
+    // Teschner et al., "Optimized Spatial Hashing for Collision Detection of
+    // Deformable Objects" (2003)
+    return (static_cast<u32>(cell.x) * 73856093u) ^
+           (static_cast<u32>(cell.y) * 19349663u) ^
+           (static_cast<u32>(cell.z) * 83492791u);
+  }
+
+  // clamped to stay representable for huge queries
+  [[nodiscard]]
+  static auto cell_of(Vector3f32 const& p, Level const& level) -> Cell {
+    auto const toCell = [&](f32 const v) {
+      constexpr auto limit = f32{1 << 30};
+
+      return static_cast<i32>(
+        std::clamp(std::floor(v * level.invCellSize), -limit, limit));
+    };
+
+    return Cell{toCell(p.x()), toCell(p.y()), toCell(p.z())};
+  }
+
+  [[nodiscard]]
+  auto level_of(f32 radius) const -> u32;
+};
+
+} // namespace basalt
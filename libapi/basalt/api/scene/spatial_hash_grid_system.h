@@ -0,0 +1,29 @@
+#pragma once
+
+#include <basalt/api/scene/spatial_hash_grid.h>
+#include <basalt/api/scene/system.h>
+#include <basalt/api/scene/types.h>
+
+#include <basalt/api/base/types.h>
+
+#include <vector>
+
+namespace basalt {
+
+// Rebuilds the SpatialHashGrid in the context of the entity registry every
+// frame from the world space positions of the entities with SpatialHashed.
+// The grid is added to the context by the first update
+class SpatialHashGridSystem final : public System {
+public:
+  using UpdateAfter = TransformSystem;
+
+  explicit SpatialHashGridSystem(f32 cellSize = 1.0f) noexcept;
+
+  auto on_update(UpdateContext const&) -> void override;
+
+private:
+  f32 mCellSize;
+  std::vector<SpatialHashGrid::Entry> mEntries;
+};
+
+} // namespace basalt
@@ -0,0 +1,124 @@
+#include <basalt/api/scene/spatial_sort.h>
+
+#include <basalt/api/base/asserts.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace basalt {
+
+namespace {
+
+constexpr auto BITS_PER_AXIS = u32{21};
+constexpr auto MAX_CELL = f32{(1u << BITS_PER_AXIS) - 1};
+constexpr auto CELL_OFFSET = f32{1u << (BITS_PER_AXIS - 1)};
+
+// inserts two zeros after each of the lower 21 bits
+auto spread_bits(u64 v) -> u64 {
+  v &= 0x1f'ffff;
+  v = (v | v << 32) & 0x1f'0000'0000'ffff;
+  v = (v | v << 16) & 0x1f'0000'ff00'00ff;
+  v = (v | v << 8) & 0x100f'00f0'0f00'f00f;
+  v = (v | v << 4) & 0x10c3'0c30'c30c'30c3;
+  v = (v | v << 2) & 0x1249'2492'4924'9249;
+
+  return v;
+}
+
+auto quantize(f32 const coordinate, f32 const invCellSize) -> u64 {
+  auto const cell = std::floor(coordinate * invCellSize) + CELL_OFFSET;
+
+  return static_cast<u64>(std::clamp(cell, 0.0f, MAX_CELL));
+}
+
+} // namespace
+
+auto morton_code(Vector3f32 const& position, f32 const cellSize) -> u64 {
+  BASALT_ASSERT(cellSize > 0.0f);
+
+  auto const invCellSize = 1.0f / cellSize;
+
+  return spread_bits(quantize(position.x(), invCellSize)) |
+         spread_bits(quantize(position.y(), invCellSize)) << 1 |
+         spread_bits(quantize(position.z(), invCellSize)) << 2;
+}
+
+IncrementalSort::IncrementalSort(u32 const windowSize) noexcept
+  : mWindowSize{std::max(windowSize, u32{1})} {
+}
+
+auto IncrementalSort::end_collect_step(uSize const runBegin, uSize const end,
+                                       uSize const count) -> void {
+  std::sort(mEntries.begin() + runBegin, mEntries.end(),
+            [](Entry const& l, Entry const& r) { return l.key < r.key; });
+
+  mCursor = end;
+  if (mCursor >= count) {
+    mPhase = Phase::Merge;
+    mRunSize = mWindowSize;
+    mCursor = 0;
+  }
+}
+
+auto IncrementalSort::continue_pass(
+  gsl::span<entt::sparse_set* const> const storages, uSize const count)
+  -> void {
+  auto const size = mEntries.size();
+
+  if (mPhase == Phase::Merge) {
+    // the cursor is at the first of the two runs
+    if (mCursor + mRunSize < size) {
+      auto const first = mEntries.begin() + mCursor;
+      auto const middle = first + mRunSize;
+      auto const last =
+        mEntries.begin() + std::min(mCursor + 2 * mRunSize, size);
+      std::inplace_merge(
+        first, middle, last,
+        [](Entry const& l, Entry const& r) { return l.key < r.key; });
+    }
+
+    mCursor += 2 * mRunSize;
+    if (mCursor + mRunSize >= size) {
+      mCursor = 0;
+      mRunSize *= 2;
+
+      if (mRunSize >= size) {
+        mPhase = Phase::Apply;
+      }
+    }
+
+    return;
+  }
+
+  // every swap moves one entity to its sorted position. Entities which left
+  // the range or were already passed are skipped
+  auto& storage = *storages[0];
+  auto const end = std::min({mCursor + mWindowSize, size, count});
+  for (auto i = mCursor; i < end; ++i) {
+    auto const wanted = mEntries[i].entity;
+    if (!storage.contains(wanted)) {
+      continue;
+    }
+
+    auto const index = storage.index(wanted);
+    if (index <= i || index >= count) {
+      continue;
+    }
+
+    auto const current = storage.data()[i];
+    for (auto* const s : storages) {
+      BASALT_ASSERT(s->data()[i] == current && s->data()[index] == wanted,
+                    "storages must be in the same order");
+      s->swap_elements(current, wanted);
+    }
+  }
+
+  mCursor = end;
+  if (mCursor >= std::min(size, count)) {
+    mPhase = Phase::Collect;
+    mCursor = 0;
+    mEntries.clear();
+  }
+}
+
+} // namespace basalt
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <basalt/api/scene/types.h>
+
+#include <basalt/api/math/vector3.h>
+
+#include <basalt/api/base/types.h>
+
+#include <entt/entity/sparse_set.hpp>
+#include <gsl/span>
+
+#include <algorithm>
+#include <vector>
+
+namespace basalt {
+
+// 63 bit Morton code (z-order) of the grid cell containing the position.
+// Positions with close codes are close in space. Covers 2^21 cells per axis
+// centered around the origin. Positions outside are clamped to the border
+[[nodiscard]]
+auto morton_code(Vector3f32 const& position, f32 cellSize) -> u64;
+
+// Sorts a range of entities over many updates with a bounded amount of work
+// per step. A pass first collects the keys of one window of entities per step
+// and sorts them as a run. Then one pair of runs is merged per step until a
+// single sorted run remains. Finally, the entities of one window are swapped
+// to their sorted positions per step. A pass takes about three steps per
+// window. Only the last merges touch more than two windows, and they do so in
+// linear time.
+//
+// The entities are swapped in all storages, so the storages must keep the
+// range in the same order, e.g. the storages owned by one group. Entities
+// which are created or destroyed during a pass are only placed by the next
+// pass
+class IncrementalSort final {
+public:
+  explicit IncrementalSort(u32 windowSize = 1024) noexcept;
+
+  // continues sorting the first count entities of storages[0] by
+  // key(EntityId) -> u64
+  template <typename Key>
+  auto step(gsl::span<entt::sparse_set* const> const storages,
+            uSize const count, Key const& key) -> void {
+    if (storages.empty()) {
+      return;
+    }
+
+    if (mPhase != Phase::Collect) {
+      continue_pass(storages, count);
+
+      return;
+    }
+
+    auto const* const entities = storages[0]->data();
+    auto const runBegin = mEntries.size();
+    auto const end = std::min(mCursor + mWindowSize, count);
+    for (auto i = mCursor; i < end; ++i) {
+      mEntries.push_back(Entry{key(entities[i]), entities[i]});
+    }
+
+    end_collect_step(runBegin, end, count);
+  }
+
+private:
+  enum class Phase : u8 {
+    Collect,
+    Merge,
+    Apply,
+  };
+
+  struct Entry final {
+    u64 key{};
+    EntityId entity{};
+  };
+
+  u32 mWindowSize;
+  Phase mPhase{Phase::Collect};
+  // next entity to collect or to place
+  uSize mCursor{};
+  // runs of this size are merged in pairs
+  uSize mRunSize{};
+  std::vector<Entry> mEntries;
+
+  auto end_collect_step(uSize runBegin, uSize end, uSize count) -> void;
+  auto continue_pass(gsl::span<entt::sparse_set* const>, uSize count) -> void;
+};
+
+} // namespace basalt
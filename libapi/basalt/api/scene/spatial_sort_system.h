@@ -0,0 +1,35 @@
+#pragma once
+
+#include <basalt/api/scene/spatial_sort.h>
+#include <basalt/api/scene/system.h>
+#include <basalt/api/scene/types.h>
+
+#include <basalt/api/base/types.h>
+
+namespace basalt {
+
+// Reorders the storages of Transform, LocalToWorld and PreviousTransform by
+// the Morton code of the world space positions, so that entities which are
+// close in space are also close in memory. Only one window of entities is
+// sorted per update (see IncrementalSort), which amortizes the cost over many
+// frames. The order follows moving entities with a delay.
+//
+// Requires the group of the TransformSystem. Don't keep references to these
+// components across updates
+class SpatialSortSystem final : public System {
+public:
+  using UpdateAfter = TransformSystem;
+  // reordering the storages is a write
+  using Writes = entt::type_list<Transform, LocalToWorld, PreviousTransform>;
+
+  explicit SpatialSortSystem(f32 cellSize = 1.0f,
+                             u32 windowSize = 1024) noexcept;
+
+  auto on_update(UpdateContext const&) -> void override;
+
+private:
+  f32 mCellSize;
+  IncrementalSort mSort;
+};
+
+} // namespace basalt
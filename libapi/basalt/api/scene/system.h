@@ -4,6 +4,10 @@
 
 #include <basalt/api/shared/types.h>
 
+#include <entt/core/type_traits.hpp>
+
+#include <type_traits>
+
 namespace basalt {
 
 class System {
@@ -20,6 +24,9 @@ public:
     SecondsF32 deltaTime{};
     SecondsF32 time{};
     Scene& scene;
+    // played back by the scene after the system and the ones updated
+    // concurrently with it
+    EntityCommandBuffer& commands;
   };
 
   virtual auto on_update(UpdateContext const&) -> void = 0;
@@ -50,6 +57,26 @@ struct GetUpdateAfter<S, std::void_t<typename S::UpdateAfter>> final {
   using Type = typename S::UpdateAfter;
 };
 
+template <typename S, typename = void>
+struct GetReads final {
+  using Type = void;
+};
+
+template <typename S>
+struct GetReads<S, std::void_t<typename S::Reads>> final {
+  using Type = typename S::Reads;
+};
+
+template <typename S, typename = void>
+struct GetWrites final {
+  using Type = void;
+};
+
+template <typename S>
+struct GetWrites<S, std::void_t<typename S::Writes>> final {
+  using Type = typename S::Writes;
+};
+
 } // namespace detail
 
 template <typename S>
@@ -58,6 +85,20 @@ struct SystemTraits final {
 
   using UpdateBefore = typename detail::GetUpdateBefore<S>::Type;
   using UpdateAfter = typename detail::GetUpdateAfter<S>::Type;
+
+  // The components a system accesses, declared as entt::type_list. Context
+  // variables can be listed as well. Components added or removed by a system
+  // are written, including the ones touched by the signals this triggers.
+  // Systems which declare their access may be updated concurrently with
+  // systems they don't conflict with. They must not create or destroy entities
+  // or add or remove context variables, but can record these changes into the
+  // command buffer of their UpdateContext. Systems which declare neither are
+  // always updated alone
+  using Reads = typename detail::GetReads<S>::Type;
+  using Writes = typename detail::GetWrites<S>::Type;
+
+  static constexpr bool declaresAccess =
+    !std::is_void_v<Reads> || !std::is_void_v<Writes>;
 };
 
 } // namespace basalt
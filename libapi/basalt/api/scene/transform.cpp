@@ -12,6 +12,14 @@ auto Transform::move(f32 const offsetX, f32 const offsetY,
 
 auto Transform::rotate(Angle const offsetX, Angle const offsetY,
                        Angle const offsetZ) noexcept -> void {
+  if (rotationMode == RotationMode::Quaternion) {
+    // renormalized against the drift of repeated rotations
+    orientation = Quaternion::normalized(
+      orientation * Quaternion::from_euler(offsetX, offsetY, offsetZ));
+
+    return;
+  }
+
   rotation +=
     Vector3f32{offsetX.radians(), offsetY.radians(), offsetZ.radians()};
 
@@ -33,12 +41,51 @@ auto Transform::rotate_z(Angle offset) noexcept -> void {
   rotate(0_rad, 0_rad, offset);
 }
 
+auto Transform::set_orientation(Quaternion const& q) noexcept -> void {
+  orientation = q;
+  rotationMode = RotationMode::Quaternion;
+}
+
+auto Transform::rotation_quaternion() const -> Quaternion {
+  if (rotationMode == RotationMode::Quaternion) {
+    return orientation;
+  }
+
+  return Quaternion::from_euler(Angle::radians(rotation.x()),
+                                Angle::radians(rotation.y()),
+                                Angle::radians(rotation.z()));
+}
+
 auto Transform::to_matrix() const -> Matrix4x4f32 {
-  return Matrix4x4f32{Matrix3x3f32::scale(scale.x(), scale.y(), scale.z()) *
-                      Matrix3x3f32::rotation(Angle::radians(rotation.x()),
-                                             Angle::radians(rotation.y()),
-                                             Angle::radians(rotation.z()))} *
-         Matrix4x4f32::translation(position);
+  return to_affine().to_matrix();
+}
+
+auto Transform::to_affine() const -> Affine3x4f32 {
+  auto const r = rotationMode == RotationMode::Quaternion
+                   ? Matrix3x3f32::rotation(orientation)
+                   : Matrix3x3f32::rotation(Angle::radians(rotation.x()),
+                                            Angle::radians(rotation.y()),
+                                            Angle::radians(rotation.z()));
+
+  // the rows of the rotation scaled by scale.x, y and z. The translation is
+  // the last row
+  // clang-format off
+  return Affine3x4f32{
+    scale.x() * r.m11(), scale.x() * r.m12(), scale.x() * r.m13(),
+    scale.y() * r.m21(), scale.y() * r.m22(), scale.y() * r.m23(),
+    scale.z() * r.m31(), scale.z() * r.m32(), scale.z() * r.m33(),
+           position.x(),        position.y(),        position.z()};
+  // clang-format on
+}
+
+auto Transform::operator==(Transform const& rhs) const noexcept -> bool {
+  return position == rhs.position && rotation == rhs.rotation &&
+         scale == rhs.scale && orientation == rhs.orientation &&
+         rotationMode == rhs.rotationMode;
+}
+
+auto Transform::operator!=(Transform const& rhs) const noexcept -> bool {
+  return !(*this == rhs);
 }
 
 } // namespace basalt
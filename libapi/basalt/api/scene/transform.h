@@ -2,42 +2,92 @@
 
 #include <basalt/api/scene/types.h>
 
+#include <basalt/api/math/affine3x4.h>
 #include <basalt/api/math/matrix4.h>
+#include <basalt/api/math/quaternion.h>
 #include <basalt/api/math/types.h>
 #include <basalt/api/math/vector3.h>
 
 #include <basalt/api/base/types.h>
 
+#include <entt/entity/entity.hpp>
+
+#include <optional>
 #include <vector>
 
 namespace basalt {
 
 struct Transform final {
+  enum class RotationMode : u8 {
+    // euler angles in radians in rotation
+    Euler,
+    // unit quaternion in orientation, which can be interpolated with slerp
+    Quaternion,
+  };
+
   Vector3f32 position;
   Vector3f32 rotation;
   Vector3f32 scale{1.0f};
+  Quaternion orientation;
+  RotationMode rotationMode{RotationMode::Euler};
 
   // TODO: wrap vectors in Position/Rotation/Scale class?
   auto move(f32 offsetX, f32 offsetY, f32 offsetZ) noexcept -> void;
+  // in RotationMode::Quaternion the offsets are applied after the orientation
   auto rotate(Angle offsetX, Angle offsetY, Angle offsetZ) noexcept -> void;
   auto rotate_x(Angle) noexcept -> void;
   auto rotate_y(Angle) noexcept -> void;
   auto rotate_z(Angle) noexcept -> void;
 
+  // switches to RotationMode::Quaternion
+  auto set_orientation(Quaternion const&) noexcept -> void;
+
+  // the rotation of either mode
+  [[nodiscard]] auto rotation_quaternion() const -> Quaternion;
+
+  // scale, then rotate, then translate. Composed in closed form
   [[nodiscard]] auto to_matrix() const -> Matrix4x4f32;
+  [[nodiscard]] auto to_affine() const -> Affine3x4f32;
+
+  [[nodiscard]] auto operator==(Transform const&) const noexcept -> bool;
+  [[nodiscard]] auto operator!=(Transform const&) const noexcept -> bool;
 };
 
+// affine, so the last column isn't stored. Use matrix.to_matrix() where a full
+// 4x4 matrix is needed
 struct LocalToWorld final {
-  Matrix4x4f32 matrix{Matrix4x4f32::identity()};
+  Affine3x4f32 matrix{Affine3x4f32::identity()};
 };
 
 struct Parent final {
   EntityId id{};
 };
 
-// don't add manually. Use Parent instead
+// don't add manually. Use Parent instead. The children form a doubly linked
+// list through their ChildLinks, starting at first
 struct Children final {
-  std::vector<EntityId> ids;
+  EntityId first{entt::null};
+  u32 count{};
+};
+
+// don't add manually. Use Parent instead
+struct ChildLinks final {
+  // the parent whose list of children contains this entity
+  EntityId parent{entt::null};
+  EntityId previous{entt::null};
+  EntityId next{entt::null};
+};
+
+// don't add manually. The Transform used for the current LocalToWorld. Lets
+// the TransformSystem skip entities which didn't move
+struct PreviousTransform final {
+  std::optional<Transform> transform;
+};
+
+// entities whose LocalToWorld changed in the current frame. Kept in the
+// context of the entity registry by the TransformSystem
+struct LocalToWorldChanges final {
+  std::vector<EntityId> entities;
 };
 
 } // namespace basalt
@@ -4,15 +4,77 @@
 
 #include <basalt/api/scene/types.h>
 
+#include <basalt/api/math/affine3x4.h>
+
+#include <basalt/api/base/types.h>
+
+#include <vector>
+
 namespace basalt {
 
+// Computes the LocalToWorld matrices from the Transforms. Entities outside of
+// a hierarchy are computed in one linear pass. Hierarchies are cached as a flat
+// array of nodes sorted by depth, where the parent of a node always precedes
+// it. Each depth is then a linear pass over the nodes, which is split across
+// the JobSystem for large levels. The array is only rebuilt after the hierarchy
+// changed. Modify Parent with replace or patch to notify the system. The
+// matrices of the changed Transforms are composed in batches of structure of
+// arrays (see batch::compose_transforms).
+//
+// Only entities whose Transform differs from their PreviousTransform and their
+// descendants are recomputed. They are listed in the LocalToWorldChanges of
+// the registry context until the next update. The root of a hierarchy may have
+// a LocalToWorld without Transform, which is then used as is
+//
+// The system creates an owning group of Transform, LocalToWorld and
+// PreviousTransform, which keeps the three storages packed in the same order.
+// No other group may own one of them. Inactive entities and their descendants
+// are excluded from the group and the hierarchies. Adding or removing Inactive
+// rebuilds the hierarchies and recomputes the LocalToWorld of the entity
 class TransformSystem final : public System {
 public:
   using UpdateAfter = ParentSystem;
+  using Reads = entt::type_list<Parent, Children, ChildLinks, Inactive>;
+  // Transform is only read, but adding PreviousTransform to new entities moves
+  // them into the owning group, which swaps Transforms in their storage
+  using Writes = entt::type_list<Transform, LocalToWorld, PreviousTransform,
+                                 LocalToWorldChanges>;
+
+  explicit TransformSystem(EntityRegistry&);
+
+  TransformSystem(TransformSystem const&) = delete;
+  TransformSystem(TransformSystem&&) = delete;
+
+  ~TransformSystem() noexcept override;
 
-  TransformSystem() noexcept = default;
+  auto operator=(TransformSystem const&) -> TransformSystem& = delete;
+  auto operator=(TransformSystem&&) -> TransformSystem& = delete;
 
   auto on_update(UpdateContext const&) -> void override;
+
+private:
+  static constexpr auto NO_PARENT = ~u32{0};
+
+  struct Node final {
+    EntityId entity;
+    // index into mNodes
+    u32 parent{NO_PARENT};
+  };
+
+  EntityRegistry& mEntities;
+  // the roots of the hierarchy come first, followed by their children, etc.
+  std::vector<Node> mNodes;
+  // index of the first node of every depth + one past the last node
+  std::vector<u32> mLevelStarts;
+  // LocalToWorld of the nodes to look up the parents linearly
+  std::vector<Affine3x4f32> mMatrices;
+  // u8 instead of bool to allow concurrent writes
+  std::vector<u8> mIsNodeChanged;
+  bool mIsDirty{true};
+
+  auto on_local_to_world_invalidated(EntityRegistry&, EntityId) -> void;
+
+  auto rebuild_hierarchy() -> void;
 };
 
 } // namespace basalt
@@ -5,7 +5,6 @@
 #include <entt/entity/fwd.hpp>
 
 #include <memory>
-#include <string>
 
 namespace basalt {
 
@@ -13,10 +12,22 @@ using Entity = entt::handle;
 using EntityId = entt::entity;
 using EntityRegistry = entt::registry;
 
+BASALT_DEFINE_HANDLE(NameId);
+class NameTable;
+
+// A name interned in the NameTable of the scene and a number, which is
+// appended when the name is formatted, e.g. "Cube 1234". Generated entities
+// share their base name, so their names are only formatted when displayed
 struct EntityName {
-  std::string value;
+  NameId base;
+  // not appended if 0
+  u32 number{};
 };
 
+// tags parked entities, e.g. the ones of an EntityPool. The systems of the
+// engine skip them: they aren't transformed, drawn or in the spatial index
+struct Inactive final {};
+
 class Scene;
 using ScenePtr = std::shared_ptr<Scene>;
 
@@ -26,8 +37,27 @@ class System;
 BASALT_DEFINE_HANDLE(SystemId);
 using SystemPtr = std::unique_ptr<System>;
 
+class EntityCommandBuffer;
+class EntityReserve;
+class Prefab;
+class EntityPool;
+
 struct Transform;
 struct LocalToWorld;
+struct LocalToWorldChanges;
+struct PreviousTransform;
+struct Parent;
+struct Children;
+struct ChildLinks;
+struct LocalBounds;
+struct SpatialIndexProxy;
+struct SpatialIndex;
+struct SpatialHashed;
+class AabbTree;
+class SpatialHashGrid;
+class BoundsSystem;
+class SpatialHashGridSystem;
+class SpatialSortSystem;
 class TransformSystem;
 class ParentSystem;
 
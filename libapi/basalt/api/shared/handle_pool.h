@@ -5,50 +5,83 @@
 #include "basalt/api/base/asserts.h"
 #include "basalt/api/base/types.h"
 
-#include <algorithm>
-#include <limits>
-#include <memory>
-#include <memory_resource>
+#include <gsl/span>
+
+#include <atomic>
+#include <cstddef>
 #include <type_traits>
 #include <utility>
 #include <vector>
 
 namespace basalt {
 
+// Slot map of values addressed by handles. The values are stored densely in
+// one array, so iterating over them is a linear walk. The handle holds the
+// index of a slot, which locates the value in the dense array, and the
+// generation of the slot. Emplacing, destroying and looking up a value are
+// O(1).
+//
+// Destroying a value bumps the generation of its slot. A slot is retired
+// instead of wrapping its generation, so a stale handle never becomes valid
+// again. Free slots are reused in the order they were freed and only once more
+// than MIN_FREE_SLOTS are free, which spreads the generations of frequently
+// reused slots. emplace_at takes the generation from the hint instead, so a
+// mirrored pool is only as safe as the pool it mirrors
+//
+// Destroying a value moves the last one into its place. References to values
+// are therefore invalidated by emplace and destroy.
+//
+// A slot can be reserved to hand out its handle before the value exists (see
+// HandleReserve). The handle is invalid until the value is emplaced with it.
+// reserve_concurrent is the only member which may be called concurrently
 template <typename T, typename Handle>
 class HandlePool {
   static_assert(std::is_base_of_v<detail::HandleBase, Handle>);
 
-  using ActiveSlotsList = std::vector<Handle>;
+  using HandleList = std::vector<Handle>;
   using IndexType = typename Handle::ValueType;
 
-  using Allocator = std::pmr::polymorphic_allocator<T>;
-  using AllocatorTraits = std::allocator_traits<Allocator>;
-  using Pointer = typename AllocatorTraits::pointer;
-
 public:
-  using iterator = typename ActiveSlotsList::iterator;
-  using const_iterator = typename ActiveSlotsList::const_iterator;
+  using iterator = typename HandleList::const_iterator;
+  using const_iterator = typename HandleList::const_iterator;
+
+  static constexpr auto MIN_FREE_SLOTS = uSize{1024};
 
   HandlePool() = default;
 
   HandlePool(HandlePool const&) = delete;
-  HandlePool(HandlePool&&) noexcept = default;
 
-  ~HandlePool() noexcept {
-    for (auto const& handle : mActiveSlots) {
-      AllocatorTraits::destroy(mAllocator, mSlots[handle.value()]);
-    }
+  HandlePool(HandlePool&& other) noexcept
+    : mValues{std::move(other.mValues)}
+    , mHandles{std::move(other.mHandles)}
+    , mSlots{std::move(other.mSlots)}
+    , mFreeList{std::move(other.mFreeList)}
+    , mFreeListHead{other.mFreeListHead}
+    , mNumSlots{other.mNumSlots.load(std::memory_order_relaxed)} {
   }
 
+  ~HandlePool() noexcept = default;
+
   auto operator=(HandlePool const&) -> HandlePool& = delete;
-  auto operator=(HandlePool&&) noexcept -> HandlePool& = default;
+
+  auto operator=(HandlePool&& other) noexcept -> HandlePool& {
+    mValues = std::move(other.mValues);
+    mHandles = std::move(other.mHandles);
+    mSlots = std::move(other.mSlots);
+    mFreeList = std::move(other.mFreeList);
+    mFreeListHead = other.mFreeListHead;
+    mNumSlots.store(other.mNumSlots.load(std::memory_order_relaxed),
+                    std::memory_order_relaxed);
+
+    return *this;
+  }
 
   [[nodiscard]]
   auto is_valid(Handle const handle) const noexcept -> bool {
-    auto const idx = to_index(handle);
+    auto const index = to_index(handle);
 
-    return is_allocated(idx) && is_active(idx);
+    return index < mSlots.size() && mSlots[index].dense < RETIRED &&
+           mSlots[index].generation == to_generation(handle);
   }
 
   // handle must be valid
@@ -56,7 +89,7 @@ public:
   auto operator[](Handle const handle) const noexcept -> T const& {
     BASALT_ASSERT(is_valid(handle));
 
-    return *mSlots[to_index(handle)];
+    return mValues[mSlots[to_index(handle)].dense];
   }
 
   // handle must be valid
@@ -64,64 +97,82 @@ public:
   auto operator[](Handle const handle) noexcept -> T& {
     BASALT_ASSERT(is_valid(handle));
 
-    return *mSlots[to_index(handle)];
+    return mValues[mSlots[to_index(handle)].dense];
   }
 
   template <typename... Args>
   [[nodiscard]]
   auto emplace(Args&&... args) -> Handle {
-    auto* data = AllocatorTraits::allocate(mAllocator, 1);
-    AllocatorTraits::construct(mAllocator, data, std::forward<Args>(args)...);
+    auto const index = acquire_slot();
+    auto const handle = to_handle(index, mSlots[index].generation);
+    push_value(index, handle, std::forward<Args>(args)...);
 
-    if (!mFreeList.empty()) {
-      auto const handle = mFreeList.back();
-      mFreeList.pop_back();
-      mSlots[to_index(handle)] = data;
-      mActiveSlots.push_back(handle);
+    return handle;
+  }
 
-      return handle;
-    }
+  [[nodiscard]]
+  auto reserve() -> Handle {
+    auto const index = acquire_slot();
+    mSlots[index].dense = RESERVED;
 
-    auto const handle = [&] {
-      auto const index = mSlots.size();
-      BASALT_ASSERT(index < std::numeric_limits<IndexType>::max());
+    return to_handle(index, mSlots[index].generation);
+  }
 
-      return Handle{static_cast<IndexType>(index)};
-    }();
+  // Thread safe with every other member. Reserves a new slot without touching
+  // the free list. The slot is added to the pool by emplace_reserved or the
+  // next slot the pool adds itself
+  [[nodiscard]]
+  auto reserve_concurrent() -> Handle {
+    auto const index = mNumSlots.fetch_add(1, std::memory_order_relaxed);
+    BASALT_ASSERT(index <= MAX_INDEX, "handle pool is full");
 
-    mSlots.push_back(data);
-    mActiveSlots.push_back(handle);
+    return to_handle(index, 0);
+  }
 
-    return handle;
+  // handle must be reserved and not emplaced yet
+  template <typename... Args>
+  auto emplace_reserved(Handle const handle, Args&&... args) -> void {
+    auto const index = to_index(handle);
+    if (index < mNumSlots.load(std::memory_order_relaxed)) {
+      add_slots(index + 1);
+    }
+    BASALT_ASSERT(index < mSlots.size() && mSlots[index].dense == RESERVED &&
+                    mSlots[index].generation == to_generation(handle),
+                  "handle isn't reserved");
+
+    push_value(index, handle, std::forward<Args>(args)...);
   }
 
+  // Emplaces the value with exactly this handle, e.g. to mirror the handles
+  // of another pool. Falls back to emplace if the slot is in use or retired
   template <typename... Args>
   [[nodiscard]]
   auto emplace_at(Handle const hint, Args&&... args) -> Handle {
-    if (is_valid(hint)) {
-      return emplace(std::forward<Args>(args)...);
+    auto const index = to_index(hint);
+    auto numSlots = mNumSlots.load(std::memory_order_relaxed);
+    while (index >= numSlots &&
+           !mNumSlots.compare_exchange_weak(numSlots, index + 1,
+                                            std::memory_order_relaxed)) {
     }
 
-    auto const index = to_index(hint);
-    if (!is_allocated(index)) {
-      auto const oldSize = mSlots.size();
-      mSlots.resize(index + 1);
-
-      // add new unused slots to the free list
-      auto const newSize = mSlots.size();
-      for (auto i = oldSize; i < newSize - 1; i++) {
-        mFreeList.push_back(Handle{static_cast<IndexType>(i)});
+    if (index < numSlots) {
+      add_slots(index + 1);
+      if (mSlots[index].dense != FREE) {
+        return emplace(std::forward<Args>(args)...);
       }
     } else {
-      mFreeList.erase(std::remove(mFreeList.begin(), mFreeList.end(), hint),
-                      mFreeList.end());
+      // new slots before the hinted one are free. The free list may keep the
+      // hinted slot, which is skipped when it comes up
+      add_slots(numSlots);
+      for (auto i = numSlots; i < index; ++i) {
+        mSlots.push_back(Slot{});
+        mFreeList.push_back(i);
+      }
+      mSlots.push_back(Slot{});
     }
 
-    auto* data = AllocatorTraits::allocate(mAllocator, 1);
-    AllocatorTraits::construct(mAllocator, data, std::forward<Args>(args)...);
-
-    mSlots[index] = data;
-    mActiveSlots.push_back(hint);
+    mSlots[index].generation = to_generation(hint);
+    push_value(index, hint, std::forward<Args>(args)...);
 
     return hint;
   }
@@ -131,67 +182,144 @@ public:
       return;
     }
 
-    mActiveSlots.erase(
-      std::remove(mActiveSlots.begin(), mActiveSlots.end(), handle),
-      mActiveSlots.end());
+    auto& slot = mSlots[to_index(handle)];
+    auto const dense = slot.dense;
+    auto const last = static_cast<IndexType>(mValues.size() - 1);
+    if (dense != last) {
+      mValues[dense] = std::move(mValues[last]);
+      mHandles[dense] = mHandles[last];
+      mSlots[to_index(mHandles[dense])].dense = dense;
+    }
 
-    auto const index = to_index(handle);
-    auto* data = mSlots[index];
+    mValues.pop_back();
+    mHandles.pop_back();
 
-    AllocatorTraits::destroy(mAllocator, data);
-    AllocatorTraits::deallocate(mAllocator, data, 1);
+    if (slot.generation == GENERATION_MASK) {
+      slot.dense = RETIRED;
 
-    // don't add to freelist if last element is de-allocated
-    if (index == mSlots.size() - 1) {
-      mSlots.pop_back();
-    } else {
-      mSlots[index] = nullptr;
-      mFreeList.push_back(handle);
+      return;
     }
+
+    slot.dense = FREE;
+    ++slot.generation;
+    mFreeList.push_back(to_index(handle));
+  }
+
+  [[nodiscard]]
+  auto size() const noexcept -> uSize {
+    return mValues.size();
   }
 
+  // the values in the same order as the handles
   [[nodiscard]]
-  auto begin() -> iterator {
-    return mActiveSlots.begin();
+  auto values() const noexcept -> gsl::span<T const> {
+    return mValues;
   }
 
   [[nodiscard]]
-  auto begin() const -> const_iterator {
-    return mActiveSlots.begin();
+  auto values() noexcept -> gsl::span<T> {
+    return mValues;
   }
 
+  // iterate over the handles of the values
   [[nodiscard]]
-  auto end() -> iterator {
-    return mActiveSlots.end();
+  auto begin() const noexcept -> const_iterator {
+    return mHandles.begin();
   }
 
   [[nodiscard]]
-  auto end() const -> const_iterator {
-    return mActiveSlots.end();
+  auto end() const noexcept -> const_iterator {
+    return mHandles.end();
   }
 
 private:
-  using MemoryResource = std::pmr::unsynchronized_pool_resource;
+  // the upper bits of a handle hold the generation of the slot
+  static constexpr auto INDEX_BITS = IndexType{24};
+  static constexpr auto INDEX_MASK = (IndexType{1} << INDEX_BITS) - 1;
+  static constexpr auto GENERATION_MASK = ~IndexType{0} >> INDEX_BITS;
+  // the highest index would collide with the null handle
+  static constexpr auto MAX_INDEX = INDEX_MASK - 1;
+  static constexpr auto FREE = ~IndexType{0};
+  static constexpr auto RESERVED = FREE - 1;
+  // used up all generations
+  static constexpr auto RETIRED = FREE - 2;
+
+  struct Slot final {
+    // index into the dense arrays, FREE, RESERVED or RETIRED
+    IndexType dense{FREE};
+    IndexType generation{};
+  };
+
+  std::vector<T> mValues;
+  HandleList mHandles;
+  std::vector<Slot> mSlots;
+  // queue of the free slots in [mFreeListHead, size). May contain slots which
+  // emplace_at took, which are skipped when they come up
+  std::vector<IndexType> mFreeList;
+  uSize mFreeListHead{};
+  // including the ones taken by reserve_concurrent, which mSlots lacks until
+  // add_slots
+  std::atomic<IndexType> mNumSlots{};
+
+  auto acquire_slot() -> IndexType {
+    auto const isFull = mNumSlots.load(std::memory_order_relaxed) > MAX_INDEX;
+    while (mFreeList.size() - mFreeListHead > (isFull ? 0 : MIN_FREE_SLOTS)) {
+      auto const index = pop_free_list();
+
+      // emplace_at might have taken it
+      if (mSlots[index].dense == FREE) {
+        return index;
+      }
+    }
 
-  std::unique_ptr<MemoryResource> mMemory{
-    std::make_unique<MemoryResource>(std::pmr::pool_options{0, sizeof(T)})};
-  std::pmr::polymorphic_allocator<T> mAllocator{mMemory.get()};
-  std::vector<T*> mSlots;
-  ActiveSlotsList mActiveSlots;
-  std::vector<Handle> mFreeList;
+    auto const index = mNumSlots.fetch_add(1, std::memory_order_relaxed);
+    BASALT_ASSERT(index <= MAX_INDEX, "handle pool is full");
+    add_slots(index + 1);
 
-  [[nodiscard]]
-  auto is_allocated(uSize const idx) const noexcept -> bool {
-    return idx < mSlots.size();
+    return index;
   }
 
-  [[nodiscard]]
-  auto is_active(uSize const idx) const noexcept -> bool {
-    return mSlots[idx] != nullptr;
+  // the slots missing in mSlots were taken by reserve_concurrent
+  auto add_slots(IndexType const count) -> void {
+    if (mSlots.size() < count) {
+      mSlots.resize(count, Slot{RESERVED, 0});
+    }
+  }
+
+  // amortized O(1): the popped part is erased once it is the larger half
+  auto pop_free_list() -> IndexType {
+    auto const index = mFreeList[mFreeListHead++];
+    if (mFreeListHead > mFreeList.size() / 2) {
+      mFreeList.erase(mFreeList.begin(),
+                      mFreeList.begin() +
+                        static_cast<std::ptrdiff_t>(mFreeListHead));
+      mFreeListHead = 0;
+    }
+
+    return index;
+  }
+
+  template <typename... Args>
+  auto push_value(IndexType const index, Handle const handle, Args&&... args)
+    -> void {
+    mValues.emplace_back(std::forward<Args>(args)...);
+    mHandles.push_back(handle);
+    mSlots[index].dense = static_cast<IndexType>(mValues.size() - 1);
+  }
+
+  static constexpr auto to_index(Handle const handle) noexcept -> IndexType {
+    return handle.value() & INDEX_MASK;
+  }
+
+  static constexpr auto to_generation(Handle const handle) noexcept
+    -> IndexType {
+    return handle.value() >> INDEX_BITS;
   }
 
-  static constexpr auto to_index(Handle const handle) noexcept -> uSize {
-    return handle.value();
+  static constexpr auto to_handle(IndexType const index,
+                                  IndexType const generation) noexcept
+    -> Handle {
+    return Handle{generation << INDEX_BITS | index};
   }
 };
 
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "handle_pool.h"
+
+#include "basalt/api/base/asserts.h"
+#include "basalt/api/base/types.h"
+
+#include <atomic>
+#include <memory>
+
+namespace basalt {
+
+// Hands out handles reserved in a HandlePool on any thread without locking.
+// The handles are kept in a ring buffer, which one thread tops up from the
+// pool at a sync point, e.g. once per frame, while any number of threads take
+// from it. Once the reserve is empty until the next refill, take reserves new
+// slots of the pool instead of reusing free ones
+template <typename Handle>
+class HandleReserve final {
+public:
+  explicit HandleReserve(u32 const capacity)
+    : mHandles{std::make_unique<std::atomic<u32>[]>(capacity)}
+    , mCapacity{capacity} {
+    BASALT_ASSERT(capacity > 0);
+  }
+
+  HandleReserve(HandleReserve const&) = delete;
+  HandleReserve(HandleReserve&&) = delete;
+
+  ~HandleReserve() noexcept = default;
+
+  auto operator=(HandleReserve const&) -> HandleReserve& = delete;
+  auto operator=(HandleReserve&&) -> HandleReserve& = delete;
+
+  // thread safe, also with the refill. Never blocks
+  template <typename T>
+  [[nodiscard]]
+  auto take(HandlePool<T, Handle>& pool) -> Handle {
+    auto head = mHead.load(std::memory_order_acquire);
+    for (;;) {
+      if (head == mTail.load(std::memory_order_acquire)) {
+        return pool.reserve_concurrent();
+      }
+
+      // read before claiming the slot. If the slot was refilled in between,
+      // the head moved on and the exchange fails
+      auto const value =
+        mHandles[head % mCapacity].load(std::memory_order_relaxed);
+      if (mHead.compare_exchange_weak(head, head + 1,
+                                      std::memory_order_acq_rel,
+                                      std::memory_order_acquire)) {
+        return Handle{value};
+      }
+    }
+  }
+
+  // not thread safe with other refills or with other uses of the pool
+  template <typename T>
+  auto refill(HandlePool<T, Handle>& pool) -> void {
+    auto const head = mHead.load(std::memory_order_acquire);
+    auto tail = mTail.load(std::memory_order_relaxed);
+    for (; tail - head < mCapacity; ++tail) {
+      mHandles[tail % mCapacity].store(pool.reserve().value(),
+                                       std::memory_order_relaxed);
+    }
+
+    mTail.store(tail, std::memory_order_release);
+  }
+
+private:
+  std::unique_ptr<std::atomic<u32>[]> mHandles;
+  u32 mCapacity;
+  // the handles in [head, tail) are available
+  std::atomic<u64> mHead{};
+  std::atomic<u64> mTail{};
+};
+
+} // namespace basalt
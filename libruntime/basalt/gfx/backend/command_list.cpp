@@ -91,6 +91,12 @@ auto CommandList::set_transform(TransformState const transformState,
   CommandListP::add<CommandSetTransform>(*this, transformState, transform);
 }
 
+auto CommandList::set_transform(TransformState const transformState,
+                                Affine3x4f32 const& transform) -> void {
+  CommandListP::add<CommandSetAffineTransform>(*this, transformState,
+                                               transform);
+}
+
 auto CommandList::set_ambient_light(Color const& ambientColor) -> void {
   CommandListP::add<CommandSetAmbientLight>(*this, ambientColor);
 }
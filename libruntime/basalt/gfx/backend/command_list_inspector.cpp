@@ -46,6 +46,7 @@ constexpr auto enumerator_to_string(CommandType const type) noexcept
     ENUMERATOR_TO_STRING(CommandType, SetBlendConstant);
     ENUMERATOR_TO_STRING(CommandType, SetLights);
     ENUMERATOR_TO_STRING(CommandType, SetTransform);
+    ENUMERATOR_TO_STRING(CommandType, SetAffineTransform);
     ENUMERATOR_TO_STRING(CommandType, SetAmbientLight);
     ENUMERATOR_TO_STRING(CommandType, SetMaterial);
     ENUMERATOR_TO_STRING(CommandType, SetFogParameters);
@@ -314,6 +315,11 @@ auto display(CommandSetTransform const& cmd) -> void {
   DebugUi::display_matrix4x4("##transform", cmd.transform);
 }
 
+auto display(CommandSetAffineTransform const& cmd) -> void {
+  ImGui::Text("transformState = %s", to_string(cmd.transformState));
+  DebugUi::display_matrix4x4("##transform", cmd.transform.to_matrix());
+}
+
 auto display(CommandSetMaterial const& cmd) -> void {
   display_color4("diffuse", cmd.diffuse);
   display_color4("ambient", cmd.ambient);
@@ -12,6 +12,7 @@ static_assert(sizeof(CommandBindSampler) == 8);
 static_assert(sizeof(CommandBindTexture) == 8);
 static_assert(sizeof(CommandSetBlendConstant) == 20);
 static_assert(sizeof(CommandSetTransform) == 68);
+static_assert(sizeof(CommandSetAffineTransform) == 52);
 static_assert(sizeof(CommandSetAmbientLight) == 20);
 static_assert(sizeof(CommandSetLights) == 24);
 static_assert(sizeof(CommandSetMaterial) == 72);
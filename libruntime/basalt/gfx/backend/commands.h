@@ -3,6 +3,7 @@
 #include <basalt/api/gfx/backend/types.h>
 #include <basalt/api/gfx/backend/ext/types.h>
 
+#include <basalt/api/math/affine3x4.h>
 #include <basalt/api/math/matrix4.h>
 
 #include <basalt/api/shared/color.h>
@@ -30,6 +31,7 @@ enum class CommandType : u8 {
 
   // fixed function only
   SetTransform,
+  SetAffineTransform,
   SetAmbientLight,
   SetLights,
   SetMaterial,
@@ -210,6 +212,19 @@ struct CommandSetTransform final : CommandT<CommandType::SetTransform> {
   }
 };
 
+// the last column is (0, 0, 0, 1) and isn't stored
+struct CommandSetAffineTransform final
+  : CommandT<CommandType::SetAffineTransform> {
+  TransformState transformState;
+  Affine3x4f32 transform;
+
+  constexpr CommandSetAffineTransform(TransformState const aTransformState,
+                                      Affine3x4f32 const& aTransform) noexcept
+    : transformState{aTransformState}
+    , transform{aTransform} {
+  }
+};
+
 struct CommandSetAmbientLight final : CommandT<CommandType::SetAmbientLight> {
   Color ambient;
 
@@ -311,6 +326,7 @@ auto visit(Command const& cmd, Visitor&& visitor) -> void {
     VISIT(CommandSetStencilWriteMask);
     VISIT(CommandSetBlendConstant);
     VISIT(CommandSetTransform);
+    VISIT(CommandSetAffineTransform);
     VISIT(CommandSetAmbientLight);
     VISIT(CommandSetLights);
     VISIT(CommandSetMaterial);
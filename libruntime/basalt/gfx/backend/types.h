@@ -31,6 +31,7 @@ struct CommandSetStencilReadMask;
 struct CommandSetStencilWriteMask;
 struct CommandSetBlendConstant;
 struct CommandSetTransform;
+struct CommandSetAffineTransform;
 struct CommandSetAmbientLight;
 struct CommandSetLights;
 struct CommandSetMaterial;
@@ -338,6 +338,11 @@ auto ValidatingDevice::validate(CommandSetTransform const& cmd) -> void {
   }
 }
 
+auto ValidatingDevice::validate(CommandSetAffineTransform const& cmd) -> void {
+  check("projection matrices aren't affine",
+        cmd.transformState != TransformState::ViewToClip);
+}
+
 auto ValidatingDevice::validate(CommandSetAmbientLight const&) -> void {
 }
 
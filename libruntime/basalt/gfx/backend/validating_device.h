@@ -119,6 +119,7 @@ private:
   auto validate(CommandBindSampler const&) -> void;
   auto validate(CommandBindTexture const&) -> void;
   auto validate(CommandSetTransform const&) -> void;
+  auto validate(CommandSetAffineTransform const&) -> void;
   auto validate(CommandSetAmbientLight const&) -> void;
   auto validate(CommandSetLights const&) -> void;
   auto validate(CommandSetMaterial const&) -> void;
@@ -39,6 +39,50 @@ using std::nullopt;
 using std::optional;
 using std::filesystem::path;
 
+namespace {
+
+// properties without an initial value get a default value
+auto make_material(MaterialClassHandle const clazzHandle,
+                   MaterialClass const& clazz,
+                   span<MaterialProperty const> const initialValues)
+  -> Material {
+  auto material = Material{clazzHandle, clazz.pipeline(), clazz.features(),
+                           clazz.layout()};
+
+  for (auto const& propertyInfo : clazz.properties()) {
+    auto const it =
+      std::find_if(initialValues.begin(), initialValues.end(),
+                   [&](MaterialProperty const& initialValue) {
+                     return initialValue.id == propertyInfo.id;
+                   });
+    if (it != initialValues.end()) {
+      material.set_value(it->id, it->value);
+      continue;
+    }
+
+    auto const defaultValue = [&]() -> MaterialPropertyValue {
+      switch (propertyInfo.type) {
+      case MaterialPropertyType::UniformColors:
+        return UniformColors{};
+      case MaterialPropertyType::FogParameters:
+        return FogParameters{};
+      case MaterialPropertyType::SampledTexture:
+        return SampledTexture{};
+      case MaterialPropertyType::Matrix4x4F32:
+        return Matrix4x4f32::identity();
+      default:
+        BASALT_CRASH("invalid MaterialPropertyType");
+      }
+    }();
+
+    material.set_value(propertyInfo.id, defaultValue);
+  }
+
+  return material;
+}
+
+} // namespace
+
 auto Context::create(DevicePtr device, ext::DeviceExtensions deviceExtensions,
                      SwapChainPtr swapChain, Info info) -> ContextPtr {
   return std::make_shared<Context>(std::move(device),
@@ -51,10 +95,15 @@ Context::Context(DevicePtr device, ext::DeviceExtensions deviceExtensions,
   : mDevice{std::move(device)}
   , mDeviceExtensions{std::move(deviceExtensions)}
   , mSwapChain{std::move(swapChain)}
-  , mInfo{std::move(info)} {
+  , mInfo{std::move(info)}
+  , mReservedMaterials{HANDLE_RESERVE_SIZE}
+  , mReservedMeshes{HANDLE_RESERVE_SIZE} {
   BASALT_ASSERT(mDevice);
   BASALT_ASSERT(mSwapChain);
 
+  mReservedMaterials.refill(mMaterials);
+  mReservedMeshes.refill(mMeshes);
+
 #if BASALT_IS_DEV_BUILD
   auto wrappedDevice = ValidatingDevice::wrap(std::move(mDevice));
   mDevice = wrappedDevice;
@@ -84,46 +133,21 @@ auto Context::create_resource_cache() -> ResourceCachePtr {
 
 auto Context::create_material(MaterialCreateInfo const& info)
   -> UniqueMaterial {
-  auto const& clazz = get(info.clazz);
-  auto properties = std::vector<MaterialProperty>{};
-  properties.reserve(clazz.properties().size());
-
-  // preserve indices of properties
-  for (auto const& propertyInfo : clazz.properties()) {
-    auto const it =
-      std::find_if(info.initialValues.begin(), info.initialValues.end(),
-                   [&](MaterialProperty const& initialValue) {
-                     return initialValue.id == propertyInfo.id;
-                   });
-    if (it != info.initialValues.end()) {
-      properties.push_back(*it);
-      continue;
-    }
-
-    auto const defaultValue = [&]() -> MaterialPropertyValue {
-      switch (propertyInfo.type) {
-      case MaterialPropertyType::UniformColors:
-        return UniformColors{};
-      case MaterialPropertyType::FogParameters:
-        return FogParameters{};
-      case MaterialPropertyType::SampledTexture:
-        return SampledTexture{};
-      case MaterialPropertyType::Matrix4x4F32:
-        return Matrix4x4f32::identity();
-      default:
-        BASALT_CRASH("invalid MaterialPropertyType");
-      }
-    }();
-
-    properties.push_back(MaterialProperty{propertyInfo.id, defaultValue});
-  }
-
   auto const handle = mMaterials.emplace(
-    info.clazz, clazz.pipeline(), clazz.features(), std::move(properties));
+    make_material(info.clazz, get(info.clazz), info.initialValues));
 
   return UniqueMaterial{handle, make_deleter()};
 }
 
+auto Context::create_material(MaterialHandle const reserved,
+                              MaterialCreateInfo const& info)
+  -> UniqueMaterial {
+  mMaterials.emplace_reserved(
+    reserved, make_material(info.clazz, get(info.clazz), info.initialValues));
+
+  return UniqueMaterial{reserved, make_deleter()};
+}
+
 auto Context::destroy(MaterialHandle const handle) noexcept -> void {
   mMaterials.destroy(handle);
 }
@@ -136,6 +160,10 @@ auto Context::get(MaterialHandle const handle) -> Material& {
   return mMaterials[handle];
 }
 
+auto Context::is_valid(MaterialHandle const handle) const noexcept -> bool {
+  return mMaterials.is_valid(handle);
+}
+
 auto Context::create_material_class(MaterialClassCreateInfo const& info)
   -> UniqueMaterialClass {
   auto const features = collect_material_features(info);
@@ -164,6 +192,16 @@ auto Context::create_mesh(MeshCreateInfo const& createInfo) -> UniqueMesh {
   return UniqueMesh{meshHandle, make_deleter()};
 }
 
+auto Context::create_mesh(MeshHandle const reserved,
+                          MeshCreateInfo const& createInfo) -> UniqueMesh {
+  mMeshes.emplace_reserved(
+    reserved, Mesh{createInfo.vertexBuffer, createInfo.vertexStart,
+                   createInfo.vertexCount, createInfo.indexBuffer,
+                   createInfo.indexCount});
+
+  return UniqueMesh{reserved, make_deleter()};
+}
+
 auto Context::destroy(MeshHandle const meshHandle) noexcept -> void {
   mMeshes.destroy(meshHandle);
 }
@@ -172,6 +210,10 @@ auto Context::get(MeshHandle const meshHandle) const -> Mesh const& {
   return mMeshes[meshHandle];
 }
 
+auto Context::is_valid(MeshHandle const meshHandle) const noexcept -> bool {
+  return mMeshes.is_valid(meshHandle);
+}
+
 auto Context::create_pipeline(PipelineCreateInfo const& createInfo)
   -> Pipeline {
   return Pipeline{mDevice->create_pipeline(createInfo), make_deleter()};
@@ -290,9 +332,20 @@ auto Context::destroy(ext::XMeshHandle handle) noexcept -> void {
   modelExt->destroy(handle);
 }
 
+auto Context::reserve_mesh() -> MeshHandle {
+  return mReservedMeshes.take(mMeshes);
+}
+
+auto Context::reserve_material() -> MaterialHandle {
+  return mReservedMaterials.take(mMaterials);
+}
+
 auto Context::submit(span<CommandList> const cmdLists) -> void {
   mDevice->submit(cmdLists);
 
+  mReservedMaterials.refill(mMaterials);
+  mReservedMeshes.refill(mMeshes);
+
   if (mOnFrameCaptured) {
     auto capturedLists = std::vector<CommandList>{};
     capturedLists.reserve(cmdLists.size());
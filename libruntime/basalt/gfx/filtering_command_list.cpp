@@ -1,5 +1,7 @@
 #include <basalt/gfx/filtering_command_list.h>
 
+#include <basalt/api/math/affine3x4.h>
+
 #include <utility>
 
 using gsl::span;
@@ -75,6 +77,14 @@ auto FilteringCommandList::set_transform(TransformState const state,
   }
 }
 
+auto FilteringCommandList::set_transform(TransformState const state,
+                                         Affine3x4f32 const& transform)
+  -> void {
+  if (mDeviceState.update(state, transform.to_matrix())) {
+    mCommandList.set_transform(state, transform);
+  }
+}
+
 auto FilteringCommandList::set_ambient_light(Color const& c) -> void {
   if (mDeviceState.update_ambient_light(c)) {
     mCommandList.set_ambient_light(c);
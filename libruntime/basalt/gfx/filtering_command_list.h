@@ -32,6 +32,7 @@ public:
   auto bind_texture(u8 slot, TextureHandle) -> void;
   auto set_blend_constant(Color const&) -> void;
   auto set_transform(TransformState, Matrix4x4f32 const&) -> void;
+  auto set_transform(TransformState, Affine3x4f32 const&) -> void;
   auto set_ambient_light(Color const&) -> void;
   auto set_lights(gsl::span<LightData const>) -> void;
   auto set_material(Color const& diffuse, Color const& ambient = {},
@@ -1,6 +1,10 @@
 #include <basalt/api/gfx/gfx_system.h>
 
 #include "filtering_command_list.h"
+#include "light_selector.h"
+#include "occlusion_culler.h"
+#include "portal_culler.h"
+#include "render_proxy_list.h"
 
 #include <basalt/api/view.h> // for DrawContext ...
 
@@ -8,121 +12,202 @@
 #include <basalt/api/gfx/context.h>
 #include <basalt/api/gfx/environment.h>
 #include <basalt/api/gfx/material.h>
-#include <basalt/api/gfx/mesh.h>
 #include <basalt/api/gfx/types.h>
 #include <basalt/api/gfx/backend/types.h>
 #include <basalt/api/gfx/backend/ext/x_model_support.h>
 
+#include <basalt/gfx/backend/device.h>
+
+#include <basalt/api/scene/bounds.h>
 #include <basalt/api/scene/ecs.h>
 #include <basalt/api/scene/scene.h>
 #include <basalt/api/scene/transform.h>
 #include <basalt/api/scene/types.h>
 
-#include <basalt/api/base/functional.h>
+#include <basalt/api/math/aabb.h>
+#include <basalt/api/math/affine3x4.h>
+#include <basalt/api/math/matrix4.h>
+#include <basalt/api/math/vector3.h>
 
-#include <gsl/span>
+#include <basalt/api/base/functional.h>
 
+#include <chrono>
+#include <memory>
 #include <variant>
 #include <vector>
 
 using std::vector;
-
-using gsl::span;
+using std::chrono::steady_clock;
 
 namespace basalt::gfx {
 
-namespace {
+GfxSystem::GfxSystem() noexcept = default;
+
+GfxSystem::~GfxSystem() noexcept = default;
+
+auto GfxSystem::on_update(UpdateContext const& ctx) -> void {
+  auto& scene = ctx.scene;
+  auto& entities = scene.entity_registry();
+  auto& ecsCtx = entities.ctx();
+  auto const& gfxCtx = ecsCtx.get<Context const>();
+  auto const& drawCtx = ecsCtx.get<View::DrawContext const>();
+
+  auto const cameraEntityId = ecsCtx.get<EntityId>(GfxSystem::sMainCamera);
+  auto const cameraEntity = CameraEntity{scene.get_handle(cameraEntityId)};
+  cameraEntity.get_camera().aspectRatio = drawCtx.viewport.aspect_ratio();
+  auto const viewToClip = cameraEntity.view_to_clip();
+  auto const worldToView = cameraEntity.world_to_view();
+  auto const worldToClip = worldToView * viewToClip;
+
+  auto* const portalCulling = ecsCtx.find<PortalCulling>();
+  auto cameraCell = EntityId{entt::null};
+  if (portalCulling) {
+    portalCulling->stats = PortalCulling::Stats{};
+
+    auto const& cameraPosition = cameraEntity.get_transform().position;
+    entities.view<Cell const>().each(
+      [&](EntityId const entity, Cell const& cell) {
+        portalCulling->stats.numCells++;
+
+        if (cameraCell == entt::null && cell.box.contains(cameraPosition)) {
+          cameraCell = entity;
+        }
+      });
+  }
+
+  auto const portalCullingEnabled =
+    portalCulling && portalCulling->enabled && cameraCell != entt::null;
 
-// TODO: buffer slice types [X]BufferSlice
-//       with ownership of the buffer?
+  if (portalCullingEnabled) {
+    if (!mPortalCuller) {
+      mPortalCuller = std::make_unique<PortalCuller>();
+    }
 
-struct VertexBufferSlice {
-  VertexBufferHandle buffer;
-  u32 start;
-  u32 count;
-};
+    auto& stats = portalCulling->stats;
 
-struct IndexBufferSlice {
-  IndexBufferHandle buffer;
-  u32 start;
-  u32 count;
-};
+    auto const start = steady_clock::now();
+    mPortalCuller->begin_frame(worldToClip);
 
-struct VbRenderMesh {
-  VertexBufferSlice vbSlice;
-};
+    entities.view<Portal const>().each(
+      [&](Portal const& portal) { mPortalCuller->add_portal(portal); });
 
-struct IndexedVbRenderMesh {
-  VertexBufferSlice vbSlice;
-  IndexBufferSlice ibSlice;
-};
+    mPortalCuller->find_visible_cells(cameraCell);
 
-using RenderMesh =
-  std::variant<VbRenderMesh, IndexedVbRenderMesh, ext::XMeshHandle>;
+    stats.numVisibleCells =
+      static_cast<u32>(mPortalCuller->num_visible_cells());
+    stats.numPortalsTested = mPortalCuller->num_portals_tested();
+    stats.time = steady_clock::now() - start;
+  }
 
-struct DrawCall {
-  PipelineHandle pipeline;
-  gsl::span<MaterialProperty const> materialProperties;
-  LocalToWorld objectToScene;
-  RenderMesh renderMesh;
-};
+  auto const isInHiddenCell = [&](EntityId const entity) {
+    if (!portalCullingEnabled) {
+      return false;
+    }
 
-} // namespace
+    auto const* member = entities.try_get<CellMember>(entity);
 
-auto GfxSystem::on_update(UpdateContext const& ctx) -> void {
-  auto& scene = ctx.scene;
-  auto const& entities = scene.entity_registry();
-  auto const& ecsCtx = entities.ctx();
-  auto const& gfxCtx = ecsCtx.get<Context const>();
+    return member && !mPortalCuller->is_visible(member->cell);
+  };
+
+  auto* const occlusionCulling = ecsCtx.find<OcclusionCulling>();
+  auto const cullingEnabled =
+    occlusionCulling && occlusionCulling->enabled &&
+    !entities.view<Occluder const>().empty();
+  if (occlusionCulling) {
+    occlusionCulling->stats = OcclusionCulling::Stats{};
+  }
+
+  if (cullingEnabled) {
+    if (!mOcclusionCuller) {
+      mOcclusionCuller = std::make_unique<OcclusionCuller>();
+    }
+
+    auto& stats = occlusionCulling->stats;
+
+    auto const rasterizationStart = steady_clock::now();
+    mOcclusionCuller->begin_frame(worldToClip);
+
+    entities.view<LocalToWorld const, Occluder const>(entt::exclude<Inactive>)
+      .each([&](LocalToWorld const& localToWorld, Occluder const& occluder) {
+        mOcclusionCuller->rasterize_occluder(occluder.box,
+                                             localToWorld.matrix.to_matrix());
+        stats.numOccluders++;
+      });
+
+    mOcclusionCuller->build_hierarchy();
+    auto const testStart = steady_clock::now();
+    stats.rasterizationTime = testStart - rasterizationStart;
+
+    entities
+      .view<LocalToWorld const, LocalBounds const>(entt::exclude<Inactive>)
+      .each([&](EntityId const entity, LocalToWorld const& localToWorld,
+                LocalBounds const& bounds) {
+        // whole cells are already culled
+        if (isInHiddenCell(entity)) {
+          return;
+        }
+
+        stats.numTested++;
+
+        switch (mOcclusionCuller->test(
+          bounds.box.transformed(localToWorld.matrix))) {
+        case OcclusionCuller::Visibility::Visible:
+          return;
+        case OcclusionCuller::Visibility::Occluded:
+          stats.numOccluded++;
+          break;
+        case OcclusionCuller::Visibility::Outside:
+          stats.numOutside++;
+          break;
+        }
+
+        mOcclusionCuller->mark_culled(entity);
+      });
+
+    stats.testTime = steady_clock::now() - testStart;
+  }
+
+  auto const isCulled = [&](EntityId const entity) {
+    if (isInHiddenCell(entity)) {
+      portalCulling->stats.numCulled++;
+
+      return true;
+    }
+
+    return cullingEnabled && mOcclusionCuller->is_culled(entity);
+  };
+
+  if (!mRenderProxies) {
+    mRenderProxies = std::make_unique<RenderProxyList>(entities);
+  }
+  mRenderProxies->update(gfxCtx);
 
   auto needsDepth = false;
   auto needsLights = false;
 
   auto const drawCalls = [&] {
-    auto drawCalls = vector<DrawCall>{};
+    auto drawCalls = vector<RenderProxy const*>{};
 
-    entities.view<LocalToWorld const, ext::XModel const>().each(
-      [&](LocalToWorld const& localToWorld, ext::XModel const& model) {
-        auto const& material = gfxCtx.get(model.material);
-        drawCalls.push_back(DrawCall{material.pipeline(), material.properties(),
-                                     localToWorld, model.mesh});
+    auto const addDrawCalls = [&](RenderProxyList::Storage const& proxies) {
+      for (auto&& [entity, proxy] : proxies.each()) {
+        if (isCulled(entity)) {
+          continue;
+        }
 
-        auto const& materialFeatures = material.features();
-        needsDepth |= materialFeatures.has(MaterialFeature::DepthBuffer);
-        needsLights |= materialFeatures.has(MaterialFeature::Lighting);
-      });
+        needsDepth |= proxy.features.has(MaterialFeature::DepthBuffer);
+        needsLights |= proxy.features.has(MaterialFeature::Lighting);
+        drawCalls.push_back(&proxy);
+      }
+    };
 
-    entities.view<LocalToWorld const, Model const>().each(
-      [&](LocalToWorld const& localToWorld, Model const& model) {
-        auto const& mesh = gfxCtx.get(model.mesh);
-
-        auto const renderMesh = [&]() -> RenderMesh {
-          if (auto const indexBuffer = mesh.indexBuffer()) {
-            return IndexedVbRenderMesh{
-              VertexBufferSlice{mesh.vertexBuffer(), mesh.vertexStart(),
-                                mesh.vertexCount()},
-              IndexBufferSlice{indexBuffer, 0, mesh.indexCount()}};
-          }
-
-          return VbRenderMesh{VertexBufferSlice{
-            mesh.vertexBuffer(), mesh.vertexStart(), mesh.vertexCount()}};
-        }();
-
-        auto const& material = gfxCtx.get(model.material);
-        drawCalls.push_back(DrawCall{material.pipeline(), material.properties(),
-                                     localToWorld, renderMesh});
-
-        auto const& materialFeatures = material.features();
-        needsDepth |= materialFeatures.has(MaterialFeature::DepthBuffer);
-        needsLights |= materialFeatures.has(MaterialFeature::Lighting);
-      });
+    addDrawCalls(mRenderProxies->x_model_proxies());
+    addDrawCalls(mRenderProxies->model_proxies());
 
     return drawCalls;
   }();
 
   auto const& env = ecsCtx.get<Environment const>();
 
-  auto const& drawCtx = ecsCtx.get<View::DrawContext const>();
   auto cmdList = FilteringCommandList{};
 
   auto clearAttachments = Attachments{Attachment::RenderTarget};
@@ -140,38 +225,39 @@ auto GfxSystem::on_update(UpdateContext const& ctx) -> void {
     return;
   }
 
-  auto const cameraEntityId = ecsCtx.get<EntityId>(GfxSystem::sMainCamera);
-  auto const cameraEntity = CameraEntity{scene.get_handle(cameraEntityId)};
-  cameraEntity.get_camera().aspectRatio = drawCtx.viewport.aspect_ratio();
-  cmdList.set_transform(TransformState::ViewToClip,
-                        cameraEntity.view_to_clip());
-  cmdList.set_transform(TransformState::WorldToView,
-                        cameraEntity.world_to_view());
+  cmdList.set_transform(TransformState::ViewToClip, viewToClip);
+  cmdList.set_transform(TransformState::WorldToView, worldToView);
 
   if (needsLights) {
-    auto const lights = [&] {
-      auto lights = vector<LightData>{};
-      auto const directionalLights = env.directional_lights();
-      if (!directionalLights.empty()) {
-        lights.insert(lights.end(), directionalLights.begin(),
-                      directionalLights.end());
-      }
+    if (!mLightSelector) {
+      mLightSelector = std::make_unique<LightSelector>();
+    }
+
+    auto const localLights = [&] {
+      auto lights = vector<LightSelector::LocalLight>{};
+
+      entities
+        .view<LocalToWorld const, Light const>(entt::exclude<Inactive>)
+        .each([&](EntityId const entity, LocalToWorld const& localToWorld,
+                  Light const& light) {
+          auto const position = localToWorld.matrix.translation();
 
-      // TODO: this should use LocalToWorld
-      entities.view<Transform const, Light const>().each(
-        [&](Transform const& transform, Light const& light) {
           std::visit(Overloaded{
                        [&](PointLight const& l) {
-                         lights.emplace_back(PointLightData{
-                           l.diffuse, l.specular, l.ambient, transform.position,
-                           l.range, l.attenuation0, l.attenuation1,
-                           l.attenuation2});
+                         lights.push_back(LightSelector::LocalLight{
+                           entity, PointLightData{
+                                     l.diffuse, l.specular, l.ambient,
+                                     position, l.range, l.attenuation0,
+                                     l.attenuation1, l.attenuation2}});
                        },
                        [&](SpotLight const& l) {
-                         lights.emplace_back(SpotLightData{
-                           l.diffuse, l.specular, l.ambient, transform.position,
-                           l.direction, l.range, l.attenuation0, l.attenuation1,
-                           l.attenuation2, l.falloff, l.phi, l.theta});
+                         lights.push_back(LightSelector::LocalLight{
+                           entity,
+                           SpotLightData{l.diffuse, l.specular, l.ambient,
+                                         position, l.direction, l.range,
+                                         l.attenuation0, l.attenuation1,
+                                         l.attenuation2, l.falloff, l.phi,
+                                         l.theta}});
                        },
                      },
                      light);
@@ -180,36 +266,45 @@ auto GfxSystem::on_update(UpdateContext const& ctx) -> void {
       return lights;
     }();
 
+    mLightSelector->begin_frame(env.directional_lights(), localLights,
+                                gfxCtx.device()->capabilities().maxLights);
+
     cmdList.set_ambient_light(env.ambient_light());
-    cmdList.set_lights(lights);
   }
 
-  for (auto const& drawCall : drawCalls) {
-    cmdList.bind_pipeline(drawCall.pipeline);
+  for (auto const* const drawCall : drawCalls) {
+    cmdList.bind_pipeline(drawCall->pipeline);
+
+    // only changes of the selection are recorded
+    if (drawCall->features.has(MaterialFeature::Lighting) &&
+        mLightSelector->select(drawCall->center, drawCall->radius)) {
+      cmdList.set_lights(mLightSelector->selected_lights());
+    }
 
-    for (auto const& property : drawCall.materialProperties) {
+    auto const& material = gfxCtx.get(drawCall->material);
+    for (auto const& property : material.layout().entries()) {
       switch (property.id) {
       case MaterialPropertyId::UniformColors: {
-        auto const& colors = std::get<UniformColors>(property.value);
+        auto const colors = material.get<UniformColors>(property.id);
         cmdList.set_material(colors.diffuse, colors.ambient, colors.emissive,
                              colors.specular, colors.specularPower);
         continue;
       }
       case MaterialPropertyId::FogParameters: {
-        auto const& params = std::get<FogParameters>(property.value);
+        auto const params = material.get<FogParameters>(property.id);
         cmdList.set_fog_parameters(params.color, params.start, params.end,
                                    params.density);
         continue;
       }
       case MaterialPropertyId::SampledTexture: {
-        auto const& tex = std::get<SampledTexture>(property.value);
+        auto const tex = material.get<SampledTexture>(property.id);
         cmdList.bind_sampler(0, tex.sampler);
         cmdList.bind_texture(0, tex.texture);
         continue;
       }
       case MaterialPropertyId::TexTransform:
         cmdList.set_transform(TransformState::Texture0,
-                              std::get<Matrix4x4f32>(property.value));
+                              material.get<Matrix4x4f32>(property.id));
         continue;
       }
 
@@ -217,7 +312,7 @@ auto GfxSystem::on_update(UpdateContext const& ctx) -> void {
     }
 
     cmdList.set_transform(TransformState::LocalToWorld,
-                          drawCall.objectToScene.matrix);
+                          drawCall->objectToScene.matrix);
 
     std::visit(Overloaded{
                  [&](VbRenderMesh const& m) {
@@ -234,7 +329,7 @@ auto GfxSystem::on_update(UpdateContext const& ctx) -> void {
                    ext::XMeshCommandEncoder::draw_x_mesh(cmdList.cmd_list(), m);
                  },
                },
-               drawCall.renderMesh);
+               drawCall->mesh);
   }
 
   drawCtx.commandLists.push_back(cmdList.take_cmd_list());
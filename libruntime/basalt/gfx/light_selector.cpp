@@ -0,0 +1,143 @@
+#include <basalt/gfx/light_selector.h>
+
+#include <basalt/api/shared/color.h>
+
+#include <basalt/api/base/asserts.h>
+#include <basalt/api/base/functional.h>
+
+#include <algorithm>
+#include <utility>
+#include <variant>
+
+namespace basalt::gfx {
+
+namespace {
+
+// large enough to hold the ranges of typical lights in a few levels
+constexpr auto GRID_CELL_SIZE = 4.0f;
+
+auto position_and_range(LightData const& light) -> std::pair<Vector3f32, f32> {
+  return std::visit(
+    Overloaded{
+      [](PointLightData const& l) {
+        return std::pair{l.positionInWorld, l.rangeInWorld};
+      },
+      [](SpotLightData const& l) {
+        return std::pair{l.positionInWorld, l.rangeInWorld};
+      },
+      [](DirectionalLightData const&) -> std::pair<Vector3f32, f32> {
+        BASALT_CRASH("directional lights don't have a position");
+      },
+    },
+    light);
+}
+
+// brightest diffuse channel scaled by the fixed function attenuation
+auto attenuated_intensity(LightData const& light, f32 const distance) -> f32 {
+  auto const score = [&](auto const& l) {
+    auto const attenuation = l.attenuation0 + l.attenuation1 * distance +
+                             l.attenuation2 * distance * distance;
+    auto const brightness =
+      std::max({l.diffuse.r(), l.diffuse.g(), l.diffuse.b()});
+
+    return brightness / std::max(attenuation, 1e-4f);
+  };
+
+  return std::visit(Overloaded{
+                      [&](PointLightData const& l) { return score(l); },
+                      [&](SpotLightData const& l) { return score(l); },
+                      [](DirectionalLightData const&) -> f32 {
+                        BASALT_CRASH("directional lights are always selected");
+                      },
+                    },
+                    light);
+}
+
+} // namespace
+
+LightSelector::LightSelector() : mGrid{GRID_CELL_SIZE} {
+}
+
+auto LightSelector::begin_frame(
+  gsl::span<DirectionalLightData const> const directionalLights,
+  gsl::span<LocalLight const> const lights, u32 const maxLights) -> void {
+  mDirectionalLights.assign(directionalLights.begin(),
+                            directionalLights.end());
+  mMaxLights = maxLights;
+
+  mLights.clear();
+  mLightIndices.clear();
+  mGridEntries.clear();
+
+  for (auto const& light : lights) {
+    auto const [position, range] = position_and_range(light.data);
+
+    mLightIndices.push(light.entity);
+    mLights.push_back(light.data);
+    mGridEntries.push_back(
+      SpatialHashGrid::Entry{position, range, light.entity});
+  }
+
+  mGrid.build(mGridEntries);
+
+  // the device state is unknown at the start of a frame
+  mHasSelection = false;
+}
+
+auto LightSelector::select(Vector3f32 const& center, f32 const radius)
+  -> bool {
+  auto const numDirectional =
+    std::min(static_cast<u32>(mDirectionalLights.size()), mMaxLights);
+  auto const maxLocalLights = mMaxLights - numDirectional;
+
+  auto const addCandidate = [&](SpatialHashGrid::Entry const& entry) {
+    auto const index = static_cast<u32>(mLightIndices.index(entry.entity));
+    // distance to the surface of the bounding sphere of the object
+    auto const distance =
+      std::max((entry.position - center).length() - radius, 0.0f);
+
+    mCandidates.push_back(
+      Candidate{index, attenuated_intensity(mLights[index], distance)});
+  };
+
+  mCandidates.clear();
+  if (maxLocalLights > 0) {
+    mGrid.query_radius(center, radius, addCandidate);
+  }
+
+  auto const numLocalLights =
+    std::min(static_cast<uSize>(maxLocalLights), mCandidates.size());
+  std::partial_sort(mCandidates.begin(), mCandidates.begin() + numLocalLights,
+                    mCandidates.end(),
+                    [](Candidate const& l, Candidate const& r) {
+                      return l.score > r.score;
+                    });
+
+  mNewSelection.clear();
+  for (auto i = uSize{0}; i < numLocalLights; ++i) {
+    mNewSelection.push_back(mCandidates[i].index);
+  }
+  // the order of the lights doesn't matter
+  std::sort(mNewSelection.begin(), mNewSelection.end());
+
+  if (mHasSelection && mNewSelection == mSelection) {
+    return false;
+  }
+
+  std::swap(mSelection, mNewSelection);
+  mHasSelection = true;
+
+  mSelectedLights.assign(mDirectionalLights.begin(),
+                         mDirectionalLights.begin() + numDirectional);
+  for (auto const index : mSelection) {
+    mSelectedLights.push_back(mLights[index]);
+  }
+
+  return true;
+}
+
+auto LightSelector::selected_lights() const -> gsl::span<LightData const> {
+  return mSelectedLights;
+}
+
+} // namespace basalt::gfx
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <basalt/api/gfx/backend/types.h>
+
+#include <basalt/api/scene/spatial_hash_grid.h>
+#include <basalt/api/scene/types.h>
+
+#include <basalt/api/math/vector3.h>
+
+#include <basalt/api/base/types.h>
+
+#include <entt/entity/sparse_set.hpp>
+#include <gsl/span>
+
+#include <vector>
+
+namespace basalt::gfx {
+
+// Selects the lights for each object when there are more lights in the scene
+// than the device supports. Directional lights are always selected. Point and
+// spot lights are found with a spatial hash grid of their ranges and ranked by
+// their attenuated intensity at the object
+class LightSelector final {
+public:
+  struct LocalLight final {
+    EntityId entity;
+    LightData data;
+  };
+
+  LightSelector();
+
+  // lights must only be point or spot lights
+  auto begin_frame(gsl::span<DirectionalLightData const> directionalLights,
+                   gsl::span<LocalLight const> lights, u32 maxLights) -> void;
+
+  // returns true if the selection differs from the previous one of this frame
+  [[nodiscard]]
+  auto select(Vector3f32 const& center, f32 radius) -> bool;
+
+  [[nodiscard]]
+  auto selected_lights() const -> gsl::span<LightData const>;
+
+private:
+  struct Candidate final {
+    u32 index{};
+    f32 score{};
+  };
+
+  std::vector<LightData> mDirectionalLights;
+  std::vector<LightData> mLights;
+  // maps light entities to their index in mLights
+  entt::sparse_set mLightIndices;
+  SpatialHashGrid mGrid;
+  u32 mMaxLights{};
+
+  std::vector<SpatialHashGrid::Entry> mGridEntries;
+  std::vector<Candidate> mCandidates;
+  std::vector<u32> mSelection;
+  std::vector<u32> mNewSelection;
+  std::vector<LightData> mSelectedLights;
+  bool mHasSelection{false};
+};
+
+} // namespace basalt::gfx
@@ -1,27 +1,38 @@
 #include <basalt/api/gfx/material.h>
 
-#include <algorithm>
-#include <memory>
+#include <basalt/api/base/asserts.h>
+
+#include <cstddef>
+#include <type_traits>
 #include <utility>
+#include <variant>
 
 namespace basalt::gfx {
 
+using std::byte;
+
+static_assert(std::is_trivially_copyable_v<UniformColors>);
+static_assert(std::is_trivially_copyable_v<FogParameters>);
+static_assert(std::is_trivially_copyable_v<SampledTexture>);
+static_assert(std::is_trivially_copyable_v<Matrix4x4f32>);
+
 Material::Material(MaterialClassHandle const clazz,
                    PipelineHandle const pipeline,
                    MaterialFeatures const features,
-                   std::vector<MaterialProperty> properties)
+                   MaterialLayout const& layout)
   : mClass{clazz}
   , mPipeline{pipeline}
   , mFeatures{features}
-  , mProperties{std::move(properties)} {
+  , mLayout{layout}
+  , mData(layout.size_in_bytes()) {
 }
 
 auto Material::features() const -> MaterialFeatures {
   return mFeatures;
 }
 
-auto Material::properties() const -> gsl::span<MaterialProperty const> {
-  return mProperties;
+auto Material::layout() const -> MaterialLayout const& {
+  return mLayout;
 }
 
 auto Material::clazz() const -> MaterialClassHandle {
@@ -32,49 +43,55 @@ auto Material::pipeline() const -> PipelineHandle {
   return mPipeline;
 }
 
+auto Material::has(MaterialPropertyId const id) const -> bool {
+  return mLayout.find(id) != nullptr;
+}
+
 auto Material::get_value(MaterialPropertyId const id) const
   -> std::optional<MaterialPropertyValue> {
-  auto const property = find_property(id);
-  if (!property) {
+  auto const* const entry = mLayout.find(id);
+  if (!entry) {
     return std::nullopt;
   }
 
-  return (*property)->value;
+  switch (entry->type) {
+  case MaterialPropertyType::UniformColors:
+    return get<UniformColors>(id);
+  case MaterialPropertyType::FogParameters:
+    return get<FogParameters>(id);
+  case MaterialPropertyType::SampledTexture:
+    return get<SampledTexture>(id);
+  case MaterialPropertyType::Matrix4x4F32:
+    return get<Matrix4x4f32>(id);
+  }
+
+  BASALT_CRASH("invalid MaterialPropertyType");
 }
 
 auto Material::set_value(MaterialPropertyId const id,
-                         MaterialPropertyValue const value) -> void {
-  auto const property = find_property(id);
-  BASALT_ASSERT(property);
-  if (!property) {
+                         MaterialPropertyValue const& value) -> void {
+  BASALT_ASSERT(has(id));
+  if (!has(id)) {
     return;
   }
 
-  (*property)->value = value;
+  std::visit(
+    [&](auto const& v) { set<std::decay_t<decltype(v)>>(id, v); }, value);
 }
 
-auto Material::find_property(MaterialPropertyId const id) const
-  -> std::optional<MaterialProperty const*> {
-  auto const it =
-    std::find_if(mProperties.cbegin(), mProperties.cend(),
-                 [&](MaterialProperty const& p) { return p.id == id; });
-  if (it == mProperties.cend()) {
-    return std::nullopt;
-  }
+auto Material::value_data(MaterialPropertyId const id,
+                          MaterialPropertyType const type) const
+  -> byte const* {
+  auto const* const entry = mLayout.find(id);
+  BASALT_ASSERT(entry, "material doesn't have the property");
+  BASALT_ASSERT(entry->type == type, "wrong type of material property");
 
-  return std::addressof(*it);
+  return mData.data() + entry->offset;
 }
 
-auto Material::find_property(MaterialPropertyId const id)
-  -> std::optional<MaterialProperty*> {
-  auto const it =
-    std::find_if(mProperties.begin(), mProperties.end(),
-                 [&](MaterialProperty const& p) { return p.id == id; });
-  if (it == mProperties.cend()) {
-    return std::nullopt;
-  }
-
-  return std::addressof(*it);
+auto Material::value_data(MaterialPropertyId const id,
+                          MaterialPropertyType const type) -> byte* {
+  return const_cast<byte*>(std::as_const(*this).value_data(id, type));
 }
 
 } // namespace basalt::gfx
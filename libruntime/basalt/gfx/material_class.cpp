@@ -1,5 +1,11 @@
 #include <basalt/api/gfx/material_class.h>
 
+#include <basalt/api/gfx/material.h>
+
+#include <basalt/api/math/matrix4.h>
+
+#include <basalt/api/base/asserts.h>
+
 #include <algorithm>
 #include <utility>
 
@@ -94,11 +100,75 @@ auto basalt::gfx::collect_material_properties(
 
 namespace basalt::gfx {
 
+namespace {
+
+struct PropertyStorage {
+  u16 size;
+  u16 alignment;
+};
+
+template <typename T>
+constexpr auto storage_of() -> PropertyStorage {
+  return PropertyStorage{sizeof(T), alignof(T)};
+}
+
+auto storage_of(MaterialPropertyType const type) -> PropertyStorage {
+  switch (type) {
+  case MaterialPropertyType::UniformColors:
+    return storage_of<UniformColors>();
+  case MaterialPropertyType::FogParameters:
+    return storage_of<FogParameters>();
+  case MaterialPropertyType::SampledTexture:
+    return storage_of<SampledTexture>();
+  case MaterialPropertyType::Matrix4x4F32:
+    return storage_of<Matrix4x4f32>();
+  }
+
+  BASALT_CRASH("invalid MaterialPropertyType");
+}
+
+} // namespace
+
+MaterialLayout::MaterialLayout(
+  gsl::span<MaterialPropertyInfo const> const properties) {
+  BASALT_ASSERT(properties.size() <= mEntries.size());
+
+  std::fill(mIndices.begin(), mIndices.end(), ABSENT);
+
+  for (auto const& property : properties) {
+    BASALT_ASSERT(mIndices[property.id] == ABSENT, "duplicate property");
+
+    auto const [size, alignment] = storage_of(property.type);
+    auto const offset =
+      static_cast<u16>((mSizeInBytes + alignment - 1) / alignment * alignment);
+
+    mIndices[property.id] = mNumEntries;
+    mEntries[mNumEntries++] = Entry{property.id, property.type, offset};
+    mSizeInBytes = static_cast<u16>(offset + size);
+  }
+}
+
+auto MaterialLayout::entries() const noexcept -> gsl::span<Entry const> {
+  return gsl::span{mEntries}.first(mNumEntries);
+}
+
+auto MaterialLayout::find(MaterialPropertyId const id) const noexcept
+  -> Entry const* {
+  auto const index = mIndices[id];
+
+  return index != ABSENT ? &mEntries[index] : nullptr;
+}
+
+auto MaterialLayout::size_in_bytes() const noexcept -> u16 {
+  return mSizeInBytes;
+}
+
 MaterialClass::MaterialClass(Pipeline pipeline, MaterialFeatures const features,
                              std::vector<MaterialPropertyInfo> properties)
   : mPipeline{std::move(pipeline)}
   , mFeatures{features}
-  , mProperties{std::move(properties)} {
+  , mProperties{std::move(properties)}
+  , mLayout{mProperties} {
 }
 
 auto MaterialClass::features() const noexcept -> MaterialFeatures {
@@ -110,6 +180,10 @@ auto MaterialClass::properties() const noexcept
   return mProperties;
 }
 
+auto MaterialClass::layout() const noexcept -> MaterialLayout const& {
+  return mLayout;
+}
+
 auto MaterialClass::pipeline() const noexcept -> PipelineHandle {
   return mPipeline;
 }
@@ -0,0 +1,448 @@
+#include <basalt/gfx/occlusion_culler.h>
+
+#include <basalt/api/math/vector4.h>
+
+#include <basalt/api/base/job_system.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <tuple>
+#include <utility>
+
+#if defined(_M_X64) || defined(__SSE2__)
+#define BASALT_OCCLUSION_CULLER_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace basalt::gfx {
+
+namespace {
+
+// vertices behind this w are considered to cross the near plane
+constexpr auto MIN_W = 1e-5f;
+
+// refinement of a test stops when the screen rect covers more texels
+constexpr auto MAX_TEST_TEXELS = u32{64};
+
+// corner indices of the 6 faces of a box in cyclic order (see Aabb::corner)
+constexpr auto BOX_FACES = std::array<std::array<u8, 4>, 6>{{
+  {0, 2, 6, 4}, // -x
+  {1, 3, 7, 5}, // +x
+  {0, 1, 5, 4}, // -y
+  {2, 3, 7, 6}, // +y
+  {0, 1, 3, 2}, // -z
+  {4, 5, 7, 6}, // +z
+}};
+
+struct ClipRect final {
+  u32 x0{};
+  u32 y0{};
+  u32 x1{};
+  u32 y1{};
+
+  [[nodiscard]]
+  constexpr auto at_level(u32 const level) const -> ClipRect {
+    return ClipRect{x0 >> level, y0 >> level, x1 >> level, y1 >> level};
+  }
+
+  [[nodiscard]]
+  constexpr auto num_texels() const -> u32 {
+    return (x1 - x0 + 1) * (y1 - y0 + 1);
+  }
+};
+
+auto to_clip(Vector3f32 const& p, Matrix4x4f32 const& m) -> Vector4f32 {
+  return Vector4f32{p.x(), p.y(), p.z(), 1.0f} * m;
+}
+
+} // namespace
+
+OcclusionCuller::OcclusionCuller() {
+  auto width = WIDTH;
+  auto height = HEIGHT;
+
+  while (width >= 1 && height >= 1) {
+    auto level = Level{width, height, {}, {}};
+    level.maxDepth.resize(uSize{width} * height, 1.0f);
+    if (!mLevels.empty()) {
+      level.minDepth.resize(uSize{width} * height, 1.0f);
+    }
+
+    mLevels.push_back(std::move(level));
+
+    width /= 2;
+    height /= 2;
+  }
+}
+
+auto OcclusionCuller::begin_frame(Matrix4x4f32 const& worldToClip) -> void {
+  mWorldToClip = worldToClip;
+
+  auto& depth = mLevels.front().maxDepth;
+  std::fill(depth.begin(), depth.end(), 1.0f);
+
+  mCulled.clear();
+
+  mFaces.clear();
+  for (auto& bin : mBins) {
+    bin.clear();
+  }
+}
+
+auto OcclusionCuller::rasterize_occluder(Aabb const& box,
+                                         Matrix4x4f32 const& localToWorld)
+  -> void {
+  auto const localToClip = localToWorld * mWorldToClip;
+  auto const width = static_cast<f32>(WIDTH);
+  auto const height = static_cast<f32>(HEIGHT);
+
+  auto vertices = std::array<ScreenVertex, 8>{};
+  for (auto i = uSize{0}; i < vertices.size(); ++i) {
+    auto const clip = to_clip(box.corner(i), localToClip);
+
+    // skipping occluders which cross the near plane is always conservative
+    if (clip.w() < MIN_W || clip.z() < 0.0f) {
+      return;
+    }
+
+    auto const invW = 1.0f / clip.w();
+    vertices[i] = ScreenVertex{
+      (clip.x() * invW * 0.5f + 0.5f) * width,
+      (0.5f - clip.y() * invW * 0.5f) * height,
+      clip.z() * invW,
+    };
+  }
+
+  // Whole faces instead of two triangles each. With inner-conservative
+  // coverage, the texels on the diagonal would be covered by neither triangle
+  for (auto const& face : BOX_FACES) {
+    add_face({vertices[face[0]], vertices[face[1]], vertices[face[2]],
+              vertices[face[3]]});
+  }
+}
+
+auto OcclusionCuller::build_hierarchy() -> void {
+  // tiles don't share texels, so they can be rasterized concurrently
+  JobSystem::global().parallel_for(
+    static_cast<u32>(mBins.size()), 1, [&](u32 const begin, u32 const end) {
+      for (auto tile = begin; tile < end; ++tile) {
+        rasterize_tile(tile);
+      }
+    });
+
+  for (auto levelIdx = uSize{1}; levelIdx < mLevels.size(); ++levelIdx) {
+    auto const& src = mLevels[levelIdx - 1];
+    auto& dst = mLevels[levelIdx];
+    // level 0 doesn't have a separate min depth buffer
+    auto const& srcMin = levelIdx == 1 ? src.maxDepth : src.minDepth;
+
+    for (auto y = u32{0}; y < dst.height; ++y) {
+      auto const row0 = uSize{2 * y} * src.width;
+      auto const row1 = row0 + src.width;
+
+      for (auto x = u32{0}; x < dst.width; ++x) {
+        auto const i00 = row0 + 2 * x;
+        auto const i01 = i00 + 1;
+        auto const i10 = row1 + 2 * x;
+        auto const i11 = i10 + 1;
+        auto const dstIdx = uSize{y} * dst.width + x;
+
+        dst.maxDepth[dstIdx] =
+          std::max(std::max(src.maxDepth[i00], src.maxDepth[i01]),
+                   std::max(src.maxDepth[i10], src.maxDepth[i11]));
+        dst.minDepth[dstIdx] = std::min(std::min(srcMin[i00], srcMin[i01]),
+                                        std::min(srcMin[i10], srcMin[i11]));
+      }
+    }
+  }
+}
+
+auto OcclusionCuller::test(Aabb const& worldBox) const -> Visibility {
+  constexpr auto inf = std::numeric_limits<f32>::infinity();
+  auto minX = inf;
+  auto maxX = -inf;
+  auto minY = inf;
+  auto maxY = -inf;
+  auto minZ = inf;
+
+  for (auto i = uSize{0}; i < 8; ++i) {
+    auto const clip = to_clip(worldBox.corner(i), mWorldToClip);
+    if (clip.w() < MIN_W) {
+      return Visibility::Visible;
+    }
+
+    auto const invW = 1.0f / clip.w();
+    auto const x = clip.x() * invW;
+    auto const y = clip.y() * invW;
+    auto const z = clip.z() * invW;
+    minX = std::min(minX, x);
+    maxX = std::max(maxX, x);
+    minY = std::min(minY, y);
+    maxY = std::max(maxY, y);
+    minZ = std::min(minZ, z);
+  }
+
+  if (maxX < -1.0f || minX > 1.0f || maxY < -1.0f || minY > 1.0f ||
+      minZ > 1.0f) {
+    return Visibility::Outside;
+  }
+
+  // the box intersects the near plane
+  if (minZ < 0.0f) {
+    return Visibility::Visible;
+  }
+
+  auto const toTexel = [](f32 const v, u32 const size) {
+    auto const t = std::floor(v * static_cast<f32>(size));
+
+    return static_cast<u32>(std::clamp(t, 0.0f, static_cast<f32>(size - 1)));
+  };
+
+  auto const rect = ClipRect{
+    toTexel(minX * 0.5f + 0.5f, WIDTH),
+    toTexel(0.5f - maxY * 0.5f, HEIGHT),
+    toTexel(maxX * 0.5f + 0.5f, WIDTH),
+    toTexel(0.5f - minY * 0.5f, HEIGHT),
+  };
+
+  // start at the finest level where the rect covers at most 2x2 texels
+  auto const lastLevel = static_cast<u32>(mLevels.size() - 1);
+  auto startLevel = u32{0};
+  while (startLevel < lastLevel) {
+    auto const r = rect.at_level(startLevel);
+    if (r.x1 - r.x0 <= 1 && r.y1 - r.y0 <= 1) {
+      break;
+    }
+
+    ++startLevel;
+  }
+
+  // the box is in front of every occluder in its screen rect
+  {
+    auto const& level = mLevels[startLevel];
+    auto const& minDepth =
+      startLevel == 0 ? level.maxDepth : level.minDepth;
+    auto const r = rect.at_level(startLevel);
+
+    auto nearestOccluder = 1.0f;
+    for (auto y = r.y0; y <= r.y1; ++y) {
+      for (auto x = r.x0; x <= r.x1; ++x) {
+        nearestOccluder =
+          std::min(nearestOccluder, minDepth[uSize{y} * level.width + x]);
+      }
+    }
+
+    if (minZ <= nearestOccluder) {
+      return Visibility::Visible;
+    }
+  }
+
+  // refine towards the finer levels. The max depth of a finer level is never
+  // larger than the one of a coarser level
+  for (auto levelIdx = startLevel + 1; levelIdx-- > 0;) {
+    auto const r = rect.at_level(levelIdx);
+    if (r.num_texels() > MAX_TEST_TEXELS) {
+      break;
+    }
+
+    auto const& level = mLevels[levelIdx];
+    auto isOccluded = true;
+    for (auto y = r.y0; y <= r.y1 && isOccluded; ++y) {
+      for (auto x = r.x0; x <= r.x1; ++x) {
+        if (minZ <= level.maxDepth[uSize{y} * level.width + x]) {
+          isOccluded = false;
+          break;
+        }
+      }
+    }
+
+    if (isOccluded) {
+      return Visibility::Occluded;
+    }
+  }
+
+  return Visibility::Visible;
+}
+
+auto OcclusionCuller::mark_culled(EntityId const entity) -> void {
+  mCulled.push(entity);
+}
+
+auto OcclusionCuller::is_culled(EntityId const entity) const -> bool {
+  return mCulled.contains(entity);
+}
+
+auto OcclusionCuller::add_face(std::array<ScreenVertex, 4> v) -> void {
+  auto const cross = [](ScreenVertex const& a, ScreenVertex const& b,
+                        ScreenVertex const& c) {
+    return (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+  };
+
+  // twice the area of the two halves of the face
+  auto area0 = cross(v[0], v[1], v[2]);
+  auto area1 = cross(v[0], v[2], v[3]);
+
+  // make the face counter-clockwise, so that the edge functions are positive
+  // inside the face
+  if (area0 + area1 < 0.0f) {
+    std::swap(v[1], v[3]);
+    std::swap(area0, area1);
+    area0 = -area0;
+    area1 = -area1;
+  }
+
+  // faces seen edge-on may be degenerate or not convex due to rounding.
+  // Skipping them is always conservative
+  if (area0 < 1e-6f || area1 < 1e-6f || cross(v[1], v[2], v[3]) < 0.0f ||
+      cross(v[3], v[0], v[1]) < 0.0f) {
+    return;
+  }
+
+  auto const minX = std::min({v[0].x, v[1].x, v[2].x, v[3].x});
+  auto const maxX = std::max({v[0].x, v[1].x, v[2].x, v[3].x});
+  auto const minY = std::min({v[0].y, v[1].y, v[2].y, v[3].y});
+  auto const maxY = std::max({v[0].y, v[1].y, v[2].y, v[3].y});
+
+  if (maxX < 0.0f || maxY < 0.0f || minX >= static_cast<f32>(WIDTH) ||
+      minY >= static_cast<f32>(HEIGHT)) {
+    return;
+  }
+
+  auto face = Face{};
+  face.x0 = static_cast<u32>(std::max(minX, 0.0f));
+  face.y0 = static_cast<u32>(std::max(minY, 0.0f));
+  face.x1 = std::min(static_cast<u32>(maxX), WIDTH - 1);
+  face.y1 = std::min(static_cast<u32>(maxY), HEIGHT - 1);
+
+  auto const makeEdge = [](ScreenVertex const& from, ScreenVertex const& to) {
+    auto const a = from.y - to.y;
+    auto const b = to.x - from.x;
+
+    return LinearFunction{a, b, -a * from.x - b * from.y};
+  };
+
+  // z/w is linear in screen space. It's interpolated over the larger half,
+  // whose edge functions opposite of a vertex are its barycentric weight
+  // (times area)
+  auto const depth = [&] {
+    auto const [a, b, c, area] = area0 >= area1
+                                   ? std::tuple{v[0], v[1], v[2], area0}
+                                   : std::tuple{v[0], v[2], v[3], area1};
+    auto const ea = makeEdge(b, c);
+    auto const eb = makeEdge(c, a);
+    auto const ec = makeEdge(a, b);
+    auto const invArea = 1.0f / area;
+
+    return LinearFunction{
+      (ea.a * a.z + eb.a * b.z + ec.a * c.z) * invArea,
+      (ea.b * a.z + eb.b * b.z + ec.b * c.z) * invArea,
+      (ea.c * a.z + eb.c * b.z + ec.c * c.z) * invArea,
+    };
+  }();
+
+  // A linear function takes its extremes over a texel at one of its corners,
+  // which lie half a texel away from the center in x and y. Moving the
+  // functions by that much lets the rasterizer sample at the centers only
+  auto const halfTexel = [](LinearFunction const& f) {
+    return 0.5f * (std::abs(f.a) + std::abs(f.b));
+  };
+
+  for (auto i = uSize{0}; i < 4; ++i) {
+    auto edge = makeEdge(v[i], v[(i + 1) % 4]);
+    edge.c -= halfTexel(edge);
+    face.edges[i] = edge;
+  }
+  face.depth = depth;
+  face.depth.c += halfTexel(depth);
+
+  auto const index = static_cast<u32>(mFaces.size());
+  mFaces.push_back(face);
+
+  for (auto ty = face.y0 / TILE_HEIGHT; ty <= face.y1 / TILE_HEIGHT; ++ty) {
+    for (auto tx = face.x0 / TILE_WIDTH; tx <= face.x1 / TILE_WIDTH; ++tx) {
+      mBins[ty * NUM_TILES_X + tx].push_back(index);
+    }
+  }
+}
+
+auto OcclusionCuller::rasterize_tile(u32 const tileIndex) -> void {
+  auto const tileX0 = tileIndex % NUM_TILES_X * TILE_WIDTH;
+  auto const tileY0 = tileIndex / NUM_TILES_X * TILE_HEIGHT;
+  auto const tileX1 = tileX0 + TILE_WIDTH - 1;
+  auto const tileY1 = tileY0 + TILE_HEIGHT - 1;
+
+  auto* const depth = mLevels.front().maxDepth.data();
+
+  for (auto const faceIndex : mBins[tileIndex]) {
+    auto const& face = mFaces[faceIndex];
+    auto const& [e0, e1, e2, e3] = face.edges;
+    auto const& [za, zb, zc] = face.depth;
+
+    auto const x0 = std::max(face.x0, tileX0);
+    auto const y0 = std::max(face.y0, tileY0);
+    auto const x1 = std::min(face.x1, tileX1);
+    auto const y1 = std::min(face.y1, tileY1);
+
+#if BASALT_OCCLUSION_CULLER_SSE2
+    // WIDTH and TILE_WIDTH are multiples of 4, so 4 pixel blocks never
+    // straddle a row or a tile
+    static_assert(WIDTH % 4 == 0 && TILE_WIDTH % 4 == 0);
+    auto const alignedX0 = x0 & ~u32{3};
+
+    auto const offsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+    auto const zero = _mm_setzero_ps();
+
+    for (auto y = y0; y <= y1; ++y) {
+      auto const py = static_cast<f32>(y) + 0.5f;
+      auto* row = depth + uSize{y} * WIDTH;
+
+      for (auto x = alignedX0; x <= x1; x += 4) {
+        auto const px = _mm_add_ps(_mm_set1_ps(static_cast<f32>(x)), offsets);
+
+        auto const edge = [&](LinearFunction const& e) {
+          return _mm_add_ps(_mm_mul_ps(_mm_set1_ps(e.a), px),
+                            _mm_set1_ps(e.b * py + e.c));
+        };
+
+        auto const inside =
+          _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(edge(e0), zero),
+                                _mm_cmpge_ps(edge(e1), zero)),
+                     _mm_and_ps(_mm_cmpge_ps(edge(e2), zero),
+                                _mm_cmpge_ps(edge(e3), zero)));
+        if (_mm_movemask_ps(inside) == 0) {
+          continue;
+        }
+
+        auto const z = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(za), px),
+                                  _mm_set1_ps(zb * py + zc));
+        auto const old = _mm_loadu_ps(row + x);
+        auto const nearer = _mm_min_ps(old, z);
+        _mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, nearer),
+                                         _mm_andnot_ps(inside, old)));
+      }
+    }
+#else
+    for (auto y = y0; y <= y1; ++y) {
+      auto const py = static_cast<f32>(y) + 0.5f;
+      auto* row = depth + uSize{y} * WIDTH;
+
+      for (auto x = x0; x <= x1; ++x) {
+        auto const px = static_cast<f32>(x) + 0.5f;
+
+        if (e0.a * px + e0.b * py + e0.c < 0.0f ||
+            e1.a * px + e1.b * py + e1.c < 0.0f ||
+            e2.a * px + e2.b * py + e2.c < 0.0f ||
+            e3.a * px + e3.b * py + e3.c < 0.0f) {
+          continue;
+        }
+
+        row[x] = std::min(row[x], za * px + zb * py + zc);
+      }
+    }
+#endif
+  }
+}
+
+} // namespace basalt::gfx
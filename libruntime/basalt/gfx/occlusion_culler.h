@@ -0,0 +1,114 @@
+#pragma once
+
+#include <basalt/api/scene/types.h>
+
+#include <basalt/api/math/aabb.h>
+#include <basalt/api/math/matrix4.h>
+
+#include <basalt/api/base/types.h>
+
+#include <entt/entity/sparse_set.hpp>
+
+#include <array>
+#include <vector>
+
+namespace basalt::gfx {
+
+// CPU occlusion culling with a low resolution software depth buffer. Occluders
+// are rasterized into the depth buffer and a min/max depth hierarchy is built
+// on top of it, which is then used to test the screen space bounds of the
+// occludees.
+//
+// The rasterization is inner-conservative: a texel is only covered if a face
+// of an occluder covers it completely, and it stores the farthest depth of
+// the face within the texel. Occluders therefore never hide more than they do
+// on screen. The faces are binned into screen tiles, which are rasterized in
+// parallel on the JobSystem
+class OcclusionCuller final {
+public:
+  static constexpr auto WIDTH = u32{256};
+  static constexpr auto HEIGHT = u32{128};
+
+  enum class Visibility : u8 {
+    Visible,
+    Occluded,
+    // outside of the view frustum
+    Outside,
+  };
+
+  OcclusionCuller();
+
+  // clears the depth buffer and the culled entities
+  auto begin_frame(Matrix4x4f32 const& worldToClip) -> void;
+
+  // Box is in the local space of the occluder. Only sets up its faces,
+  // the rasterization happens in build_hierarchy
+  auto rasterize_occluder(Aabb const& box, Matrix4x4f32 const& localToWorld)
+    -> void;
+
+  // call after adding all occluders and before testing
+  auto build_hierarchy() -> void;
+
+  [[nodiscard]]
+  auto test(Aabb const& worldBox) const -> Visibility;
+
+  auto mark_culled(EntityId) -> void;
+
+  [[nodiscard]]
+  auto is_culled(EntityId) const -> bool;
+
+private:
+  struct Level final {
+    u32 width{};
+    u32 height{};
+    // empty for level 0. Use maxDepth instead
+    std::vector<f32> minDepth;
+    std::vector<f32> maxDepth;
+  };
+
+  struct ScreenVertex final {
+    f32 x{};
+    f32 y{};
+    f32 z{};
+  };
+
+  // f(x, y) = a * x + b * y + c
+  struct LinearFunction final {
+    f32 a{};
+    f32 b{};
+    f32 c{};
+  };
+
+  // convex quad
+  struct Face final {
+    // positive at the centers of the texels which are completely inside
+    std::array<LinearFunction, 4> edges;
+    // farthest z/w within the texel around the center
+    LinearFunction depth;
+    // bounding rect in texels
+    u32 x0{};
+    u32 y0{};
+    u32 x1{};
+    u32 y1{};
+  };
+
+  static constexpr auto TILE_WIDTH = u32{64};
+  static constexpr auto TILE_HEIGHT = u32{32};
+  static constexpr auto NUM_TILES_X = WIDTH / TILE_WIDTH;
+  static constexpr auto NUM_TILES_Y = HEIGHT / TILE_HEIGHT;
+
+  Matrix4x4f32 mWorldToClip;
+  // level 0 is the depth buffer itself
+  std::vector<Level> mLevels;
+  entt::sparse_set mCulled;
+  std::vector<Face> mFaces;
+  // indices of the faces overlapping each tile
+  std::array<std::vector<u32>, NUM_TILES_X * NUM_TILES_Y> mBins;
+
+  // the vertices must be in cyclic order
+  auto add_face(std::array<ScreenVertex, 4>) -> void;
+
+  auto rasterize_tile(u32 tileIndex) -> void;
+};
+
+} // namespace basalt::gfx
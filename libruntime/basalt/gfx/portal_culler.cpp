@@ -0,0 +1,160 @@
+#include <basalt/gfx/portal_culler.h>
+
+#include <basalt/api/math/vector4.h>
+
+#include <entt/entity/entity.hpp>
+
+#include <algorithm>
+#include <array>
+#include <limits>
+
+namespace basalt::gfx {
+
+namespace {
+
+// distance of the clipping plane in front of the eye
+constexpr auto MIN_W = 1e-5f;
+
+auto to_clip(Vector3f32 const& p, Matrix4x4f32 const& m) -> Vector4f32 {
+  return Vector4f32{p.x(), p.y(), p.z(), 1.0f} * m;
+}
+
+auto precedes(EntityId const l, EntityId const r) -> bool {
+  return entt::to_integral(l) < entt::to_integral(r);
+}
+
+} // namespace
+
+auto PortalCuller::begin_frame(Matrix4x4f32 const& worldToClip) -> void {
+  mWorldToClip = worldToClip;
+  mPortals.clear();
+  mLinks.clear();
+  mVisibleCells.clear();
+  mPath.clear();
+  mNumPortalsTested = 0;
+}
+
+auto PortalCuller::add_portal(Portal const& portal) -> void {
+  auto const index = static_cast<u32>(mPortals.size());
+  mPortals.push_back(portal);
+
+  mLinks.push_back(Link{portal.cell1, portal.cell2, index});
+  mLinks.push_back(Link{portal.cell2, portal.cell1, index});
+}
+
+auto PortalCuller::find_visible_cells(EntityId const cameraCell) -> void {
+  std::sort(mLinks.begin(), mLinks.end(), [](Link const& l, Link const& r) {
+    return precedes(l.cell, r.cell);
+  });
+
+  visit(cameraCell, ScreenRect{-1.0f, -1.0f, 1.0f, 1.0f});
+}
+
+auto PortalCuller::is_visible(EntityId const cell) const -> bool {
+  return mVisibleCells.contains(cell);
+}
+
+auto PortalCuller::num_visible_cells() const -> uSize {
+  return mVisibleCells.size();
+}
+
+auto PortalCuller::num_portals_tested() const -> u32 {
+  return mNumPortalsTested;
+}
+
+auto PortalCuller::visit(EntityId const cell, ScreenRect rect) -> void {
+  auto const depth = static_cast<u32>(mPath.size());
+
+  if (mVisibleCells.contains(cell)) {
+    auto& visible = mVisibleCells.get(cell);
+
+    // everything visible through the rect was found before
+    if (visible.rect.contains(rect) && visible.depth <= depth) {
+      return;
+    }
+
+    rect = ScreenRect{std::min(rect.minX, visible.rect.minX),
+                      std::min(rect.minY, visible.rect.minY),
+                      std::max(rect.maxX, visible.rect.maxX),
+                      std::max(rect.maxY, visible.rect.maxY)};
+    visible = VisibleCell{rect, std::min(depth, visible.depth)};
+  } else {
+    mVisibleCells.emplace(cell, VisibleCell{rect, depth});
+  }
+
+  if (depth >= MAX_DEPTH) {
+    return;
+  }
+
+  mPath.push_back(cell);
+
+  auto const [first, last] =
+    std::equal_range(mLinks.begin(), mLinks.end(), Link{cell, cell, 0},
+                     [](Link const& l, Link const& r) {
+                       return precedes(l.cell, r.cell);
+                     });
+
+  for (auto it = first; it != last; ++it) {
+    auto const& link = *it;
+    if (std::find(mPath.begin(), mPath.end(), link.neighbor) != mPath.end()) {
+      continue;
+    }
+
+    ++mNumPortalsTested;
+
+    auto const portalRect = project(mPortals[link.portal]);
+    auto const narrowed = ScreenRect{std::max(rect.minX, portalRect.minX),
+                                     std::max(rect.minY, portalRect.minY),
+                                     std::min(rect.maxX, portalRect.maxX),
+                                     std::min(rect.maxY, portalRect.maxY)};
+    if (narrowed.is_empty()) {
+      continue;
+    }
+
+    visit(link.neighbor, narrowed);
+  }
+
+  mPath.pop_back();
+}
+
+// The quad is clipped against a plane just in front of the eye before the
+// division by w. Clipping against the near plane instead would lose portals
+// between the eye and the near plane, e.g. while walking through a door
+auto PortalCuller::project(Portal const& portal) const -> ScreenRect {
+  auto clipped = std::array<Vector4f32, 8>{};
+  auto numClipped = uSize{0};
+
+  for (auto i = uSize{0}; i < portal.corners.size(); ++i) {
+    auto const a = to_clip(portal.corners[i], mWorldToClip);
+    auto const b = to_clip(portal.corners[(i + 1) % portal.corners.size()],
+                           mWorldToClip);
+
+    if (a.w() >= MIN_W) {
+      clipped[numClipped++] = a;
+    }
+
+    // the edge crosses the plane
+    if ((a.w() >= MIN_W) != (b.w() >= MIN_W)) {
+      auto const t = (a.w() - MIN_W) / (a.w() - b.w());
+      clipped[numClipped++] = a + (b - a) * t;
+    }
+  }
+
+  constexpr auto inf = std::numeric_limits<f32>::infinity();
+  auto rect = ScreenRect{inf, inf, -inf, -inf};
+
+  for (auto i = uSize{0}; i < numClipped; ++i) {
+    auto const& v = clipped[i];
+    auto const x = v.x() / v.w();
+    auto const y = v.y() / v.w();
+
+    rect.minX = std::min(rect.minX, x);
+    rect.minY = std::min(rect.minY, y);
+    rect.maxX = std::max(rect.maxX, x);
+    rect.maxY = std::max(rect.maxY, y);
+  }
+
+  return rect;
+}
+
+} // namespace basalt::gfx
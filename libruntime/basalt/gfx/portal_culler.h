@@ -0,0 +1,100 @@
+#pragma once
+
+#include <basalt/api/gfx/types.h>
+
+#include <basalt/api/scene/types.h>
+
+#include <basalt/api/math/matrix4.h>
+
+#include <basalt/api/base/types.h>
+
+#include <entt/entity/storage.hpp>
+
+#include <vector>
+
+namespace basalt::gfx {
+
+// Determines the visible cells of an indoor level. Starting at the cell of the
+// camera, every portal of a visible cell is projected to the screen and the
+// neighbouring cell is visible if the projection overlaps the screen rect
+// through which the cell is seen. The overlap becomes the screen rect of the
+// neighbour, so the view narrows with every portal passed.
+//
+// Every cell remembers the bounds of the screen rects it was entered with. A
+// cell isn't entered again through a rect inside of these bounds, otherwise
+// it's entered with the grown bounds. This keeps levels with many cycles from
+// exploding into a number of paths exponential in the depth, at the cost of
+// seeing a cell through slightly more than the union of its rects
+class PortalCuller final {
+public:
+  // maximum number of portals passed from the cell of the camera
+  static constexpr auto MAX_DEPTH = u32{16};
+
+  // clears the portals and the visible cells
+  auto begin_frame(Matrix4x4f32 const& worldToClip) -> void;
+
+  auto add_portal(Portal const&) -> void;
+
+  // call after adding all portals
+  auto find_visible_cells(EntityId cameraCell) -> void;
+
+  [[nodiscard]]
+  auto is_visible(EntityId cell) const -> bool;
+
+  [[nodiscard]]
+  auto num_visible_cells() const -> uSize;
+
+  [[nodiscard]]
+  auto num_portals_tested() const -> u32;
+
+private:
+  // in normalized device coordinates
+  struct ScreenRect final {
+    f32 minX{};
+    f32 minY{};
+    f32 maxX{};
+    f32 maxY{};
+
+    [[nodiscard]]
+    constexpr auto is_empty() const -> bool {
+      return minX >= maxX || minY >= maxY;
+    }
+
+    [[nodiscard]]
+    constexpr auto contains(ScreenRect const& r) const -> bool {
+      return minX <= r.minX && minY <= r.minY && maxX >= r.maxX &&
+             maxY >= r.maxY;
+    }
+  };
+
+  struct VisibleCell final {
+    // bounds of the rects the cell was entered with
+    ScreenRect rect;
+    // lowest number of portals passed to enter the cell. Entering it through
+    // fewer portals may reach cells beyond MAX_DEPTH before
+    u32 depth{};
+  };
+
+  // a portal seen from one of its cells
+  struct Link final {
+    EntityId cell;
+    EntityId neighbor;
+    u32 portal{};
+  };
+
+  Matrix4x4f32 mWorldToClip;
+  std::vector<Portal> mPortals;
+  // sorted by cell after all portals are added
+  std::vector<Link> mLinks;
+  entt::storage<VisibleCell> mVisibleCells;
+  std::vector<EntityId> mPath;
+  u32 mNumPortalsTested{};
+
+  auto visit(EntityId cell, ScreenRect) -> void;
+
+  // returns an empty rect if the portal is behind the camera
+  [[nodiscard]]
+  auto project(Portal const&) const -> ScreenRect;
+};
+
+} // namespace basalt::gfx
@@ -0,0 +1,247 @@
+#include "render_proxy_list.h"
+
+#include <basalt/api/gfx/context.h>
+#include <basalt/api/gfx/material.h>
+#include <basalt/api/gfx/mesh.h>
+
+#include <basalt/api/scene/bounds.h>
+
+#include <basalt/api/math/aabb.h>
+#include <basalt/api/math/affine3x4.h>
+
+#include <algorithm>
+#include <utility>
+
+namespace basalt::gfx {
+
+namespace {
+
+auto to_render_mesh(Mesh const& mesh) -> RenderMesh {
+  auto const vbSlice = VertexBufferSlice{
+    mesh.vertexBuffer(), mesh.vertexStart(), mesh.vertexCount()};
+  if (auto const indexBuffer = mesh.indexBuffer()) {
+    return IndexedVbRenderMesh{
+      vbSlice, IndexBufferSlice{indexBuffer, 0, mesh.indexCount()}};
+  }
+
+  return VbRenderMesh{vbSlice};
+}
+
+auto make_proxy(MaterialHandle const materialHandle, Material const& material,
+                RenderMesh const& mesh) -> RenderProxy {
+  auto proxy = RenderProxy{};
+  proxy.sortKey = u64{material.pipeline().value()} << 32 |
+                  u64{materialHandle.value()};
+  proxy.pipeline = material.pipeline();
+  proxy.material = materialHandle;
+  proxy.features = material.features();
+  proxy.mesh = mesh;
+
+  return proxy;
+}
+
+// Removes the proxies of the changed entities, which might have been
+// destroyed. Returns true if the proxies changed
+auto remove_changed(RenderProxyList::Storage& proxies,
+                    std::vector<EntityId>& changed) -> bool {
+  std::sort(changed.begin(), changed.end());
+  changed.erase(std::unique(changed.begin(), changed.end()), changed.end());
+
+  auto isChanged = false;
+  for (auto const entity : changed) {
+    isChanged |= proxies.remove(entity);
+  }
+
+  return isChanged;
+}
+
+// Recreates the proxies of the changed entities with
+// makeProxy(EntityId, ModelT const&). The changed entities must have been
+// passed to remove_changed() before. Returns true if the proxies changed
+template <typename ModelT, typename MakeProxy>
+auto rebuild(EntityRegistry const& entities, RenderProxyList::Storage& proxies,
+             std::vector<EntityId>& changed, MakeProxy const& makeProxy)
+  -> bool {
+  auto isChanged = false;
+  for (auto const entity : changed) {
+    if (!entities.valid(entity) ||
+        !entities.all_of<ModelT, LocalToWorld>(entity) ||
+        entities.all_of<Inactive>(entity)) {
+      continue;
+    }
+
+    proxies.emplace(entity, makeProxy(entity, entities.get<ModelT>(entity)));
+    isChanged = true;
+  }
+
+  changed.clear();
+
+  return isChanged;
+}
+
+} // namespace
+
+RenderProxyList::RenderProxyList(EntityRegistry& entities)
+  : mEntities{entities} {
+  mEntities.on_construct<Model>()
+    .connect<&RenderProxyList::on_model_changed>(*this);
+  mEntities.on_update<Model>()
+    .connect<&RenderProxyList::on_model_changed>(*this);
+  mEntities.on_destroy<Model>()
+    .connect<&RenderProxyList::on_model_changed>(*this);
+  mEntities.on_construct<ext::XModel>()
+    .connect<&RenderProxyList::on_x_model_changed>(*this);
+  mEntities.on_update<ext::XModel>()
+    .connect<&RenderProxyList::on_x_model_changed>(*this);
+  mEntities.on_destroy<ext::XModel>()
+    .connect<&RenderProxyList::on_x_model_changed>(*this);
+  mEntities.on_construct<LocalToWorld>()
+    .connect<&RenderProxyList::on_entity_changed>(*this);
+  mEntities.on_destroy<LocalToWorld>()
+    .connect<&RenderProxyList::on_entity_changed>(*this);
+  mEntities.on_construct<LocalBounds>()
+    .connect<&RenderProxyList::on_entity_changed>(*this);
+  mEntities.on_update<LocalBounds>()
+    .connect<&RenderProxyList::on_entity_changed>(*this);
+  mEntities.on_destroy<LocalBounds>()
+    .connect<&RenderProxyList::on_entity_changed>(*this);
+  mEntities.on_construct<Inactive>()
+    .connect<&RenderProxyList::on_entity_changed>(*this);
+  mEntities.on_destroy<Inactive>()
+    .connect<&RenderProxyList::on_entity_changed>(*this);
+
+  // the entities which existed before the signals were connected
+  auto const models = mEntities.view<Model const>();
+  mChangedModels.assign(models.begin(), models.end());
+  auto const xModels = mEntities.view<ext::XModel const>();
+  mChangedXModels.assign(xModels.begin(), xModels.end());
+}
+
+RenderProxyList::~RenderProxyList() noexcept {
+  mEntities.on_construct<Model>().disconnect(*this);
+  mEntities.on_update<Model>().disconnect(*this);
+  mEntities.on_destroy<Model>().disconnect(*this);
+  mEntities.on_construct<ext::XModel>().disconnect(*this);
+  mEntities.on_update<ext::XModel>().disconnect(*this);
+  mEntities.on_destroy<ext::XModel>().disconnect(*this);
+  mEntities.on_construct<LocalToWorld>().disconnect(*this);
+  mEntities.on_destroy<LocalToWorld>().disconnect(*this);
+  mEntities.on_construct<LocalBounds>().disconnect(*this);
+  mEntities.on_update<LocalBounds>().disconnect(*this);
+  mEntities.on_destroy<LocalBounds>().disconnect(*this);
+  mEntities.on_construct<Inactive>().disconnect(*this);
+  mEntities.on_destroy<Inactive>().disconnect(*this);
+}
+
+auto RenderProxyList::update(Context const& gfxCtx) -> void {
+  // removing the proxies of the changed entities first leaves only proxies of
+  // valid entities with a LocalToWorld. The rebuilt proxies are up to date, so
+  // the matrices are copied before rebuilding
+  remove_changed_proxies();
+  move_proxies();
+  rebuild_proxies(gfxCtx);
+
+  if (mIsUnsorted) {
+    auto const sort = [](Storage& proxies) {
+      proxies.sort([&](EntityId const l, EntityId const r) {
+        return proxies.get(l).sortKey < proxies.get(r).sortKey;
+      });
+    };
+    sort(mModelProxies);
+    sort(mXModelProxies);
+    mIsUnsorted = false;
+  }
+}
+
+auto RenderProxyList::model_proxies() const noexcept -> Storage const& {
+  return mModelProxies;
+}
+
+auto RenderProxyList::x_model_proxies() const noexcept -> Storage const& {
+  return mXModelProxies;
+}
+
+auto RenderProxyList::on_model_changed(EntityRegistry&, EntityId const entity)
+  -> void {
+  mChangedModels.push_back(entity);
+}
+
+auto RenderProxyList::on_x_model_changed(EntityRegistry&,
+                                         EntityId const entity) -> void {
+  mChangedXModels.push_back(entity);
+}
+
+auto RenderProxyList::on_entity_changed(EntityRegistry&, EntityId const entity)
+  -> void {
+  mChangedModels.push_back(entity);
+  mChangedXModels.push_back(entity);
+}
+
+auto RenderProxyList::remove_changed_proxies() -> void {
+  mIsUnsorted |= remove_changed(mModelProxies, mChangedModels);
+  mIsUnsorted |= remove_changed(mXModelProxies, mChangedXModels);
+}
+
+auto RenderProxyList::rebuild_proxies(Context const& gfxCtx) -> void {
+  mIsUnsorted |= rebuild<Model>(
+    mEntities, mModelProxies, mChangedModels,
+    [&](EntityId const entity, Model const& model) {
+      auto proxy =
+        make_proxy(model.material, gfxCtx.get(model.material),
+                   to_render_mesh(gfxCtx.get(model.mesh)));
+      move_proxy(entity, proxy);
+
+      return proxy;
+    });
+
+  mIsUnsorted |= rebuild<ext::XModel>(
+    mEntities, mXModelProxies, mChangedXModels,
+    [&](EntityId const entity, ext::XModel const& model) {
+      auto proxy =
+        make_proxy(model.material, gfxCtx.get(model.material), model.mesh);
+      move_proxy(entity, proxy);
+
+      return proxy;
+    });
+}
+
+auto RenderProxyList::move_proxies() -> void {
+  auto const* changes = mEntities.ctx().find<LocalToWorldChanges>();
+  if (!changes) {
+    for (auto&& [entity, proxy] : mModelProxies.each()) {
+      move_proxy(entity, proxy);
+    }
+    for (auto&& [entity, proxy] : mXModelProxies.each()) {
+      move_proxy(entity, proxy);
+    }
+
+    return;
+  }
+
+  for (auto const entity : changes->entities) {
+    if (mModelProxies.contains(entity)) {
+      move_proxy(entity, mModelProxies.get(entity));
+    }
+    if (mXModelProxies.contains(entity)) {
+      move_proxy(entity, mXModelProxies.get(entity));
+    }
+  }
+}
+
+// entities without bounds are treated as points
+auto RenderProxyList::move_proxy(EntityId const entity,
+                                 RenderProxy& proxy) const -> void {
+  auto const& localToWorld = mEntities.get<LocalToWorld const>(entity);
+  proxy.objectToScene = localToWorld;
+
+  if (auto const* bounds = mEntities.try_get<LocalBounds const>(entity)) {
+    auto const box = bounds->box.transformed(localToWorld.matrix);
+    proxy.center = box.center();
+    proxy.radius = box.half_extents().length();
+  } else {
+    proxy.center = localToWorld.matrix.translation();
+    proxy.radius = 0.0f;
+  }
+}
+
+} // namespace basalt::gfx
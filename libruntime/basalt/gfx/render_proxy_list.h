@@ -0,0 +1,114 @@
+#pragma once
+
+#include <basalt/api/gfx/material_class.h>
+#include <basalt/api/gfx/types.h>
+#include <basalt/api/gfx/backend/types.h>
+#include <basalt/api/gfx/backend/ext/types.h>
+
+#include <basalt/api/scene/ecs.h>
+#include <basalt/api/scene/transform.h>
+#include <basalt/api/scene/types.h>
+
+#include <basalt/api/math/vector3.h>
+
+#include <basalt/api/base/types.h>
+
+#include <entt/entity/storage.hpp>
+
+#include <variant>
+#include <vector>
+
+namespace basalt::gfx {
+
+// TODO: buffer slice types [X]BufferSlice
+//       with ownership of the buffer?
+
+struct VertexBufferSlice final {
+  VertexBufferHandle buffer;
+  u32 start{};
+  u32 count{};
+};
+
+struct IndexBufferSlice final {
+  IndexBufferHandle buffer;
+  u32 start{};
+  u32 count{};
+};
+
+struct VbRenderMesh final {
+  VertexBufferSlice vbSlice;
+};
+
+struct IndexedVbRenderMesh final {
+  VertexBufferSlice vbSlice;
+  IndexBufferSlice ibSlice;
+};
+
+using RenderMesh =
+  std::variant<VbRenderMesh, IndexedVbRenderMesh, ext::XMeshHandle>;
+
+// What is needed to draw an entity, resolved from its Model or ext::XModel
+struct RenderProxy final {
+  // orders the proxies by pipeline and then by material
+  u64 sortKey{};
+  PipelineHandle pipeline;
+  // properties are read when drawing, because they may change every frame
+  MaterialHandle material;
+  MaterialFeatures features;
+  RenderMesh mesh;
+  LocalToWorld objectToScene;
+  // bounding sphere in world space to select the lights
+  Vector3f32 center;
+  f32 radius{};
+};
+
+// Render proxies of the entities with a LocalToWorld and a Model or an
+// ext::XModel which aren't Inactive, kept from frame to frame. The signals of
+// the components mark entities as changed and only their proxies are rebuilt.
+// The matrices of the entities in the LocalToWorldChanges are copied into their
+// proxies. Per frame work is therefore proportional to the changes and not to
+// the size of the scene. Changes to the components must be made with replace
+// or patch to be noticed
+class RenderProxyList final {
+public:
+  using Storage = entt::storage<RenderProxy>;
+
+  explicit RenderProxyList(EntityRegistry&);
+
+  RenderProxyList(RenderProxyList const&) = delete;
+  RenderProxyList(RenderProxyList&&) = delete;
+
+  ~RenderProxyList() noexcept;
+
+  auto operator=(RenderProxyList const&) -> RenderProxyList& = delete;
+  auto operator=(RenderProxyList&&) -> RenderProxyList& = delete;
+
+  // rebuilds the proxies of the changed entities and restores the sort order
+  auto update(Context const&) -> void;
+
+  // sorted by their key
+  [[nodiscard]]
+  auto model_proxies() const noexcept -> Storage const&;
+  [[nodiscard]]
+  auto x_model_proxies() const noexcept -> Storage const&;
+
+private:
+  EntityRegistry& mEntities;
+  Storage mModelProxies;
+  Storage mXModelProxies;
+  // may contain duplicates and entities which were destroyed since
+  std::vector<EntityId> mChangedModels;
+  std::vector<EntityId> mChangedXModels;
+  bool mIsUnsorted{false};
+
+  auto on_model_changed(EntityRegistry&, EntityId) -> void;
+  auto on_x_model_changed(EntityRegistry&, EntityId) -> void;
+  auto on_entity_changed(EntityRegistry&, EntityId) -> void;
+
+  auto remove_changed_proxies() -> void;
+  auto rebuild_proxies(Context const&) -> void;
+  auto move_proxies() -> void;
+  auto move_proxy(EntityId, RenderProxy&) const -> void;
+};
+
+} // namespace basalt::gfx
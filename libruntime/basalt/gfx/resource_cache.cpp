@@ -1,8 +1,14 @@
 #include <basalt/api/gfx/resource_cache.h>
 
 #include <basalt/api/gfx/context.h>
+#include <basalt/api/gfx/material.h>
+#include <basalt/api/gfx/mesh.h>
+#include <basalt/api/gfx/backend/buffer.h>
+#include <basalt/api/gfx/backend/vertex_layout.h>
 #include <basalt/api/gfx/backend/ext/x_model_support.h>
 
+#include <basalt/api/base/types.h>
+
 #include <gsl/span>
 
 #include <algorithm>
@@ -10,6 +16,8 @@
 #include <filesystem>
 #include <iterator>
 #include <memory>
+#include <mutex>
+#include <thread>
 #include <utility>
 #include <variant>
 #include <vector>
@@ -22,12 +30,46 @@ using gsl::span;
 
 namespace basalt::gfx {
 
+struct ResourceCache::CreationQueue final {
+  struct QueuedMesh final {
+    MeshHandle handle;
+    VertexLayoutVector layout;
+    vector<byte> vertexData;
+    u32 vertexCount{};
+    vector<byte> indexData;
+    u32 indexCount{};
+    IndexType indexType{};
+  };
+
+  struct QueuedMaterial final {
+    MaterialHandle handle;
+    MaterialClassHandle clazz;
+    vector<MaterialProperty> initialValues;
+  };
+
+  std::mutex mutex;
+  vector<QueuedMesh> meshes;
+  vector<QueuedMaterial> materials;
+};
+
+namespace {
+
+auto num_creation_queues() -> uSize {
+  return std::max(uSize{std::thread::hardware_concurrency()}, uSize{1});
+}
+
+} // namespace
+
 auto ResourceCache::create(ContextPtr context) -> ResourceCachePtr {
   return std::make_shared<ResourceCache>(std::move(context));
 }
 
 ResourceCache::ResourceCache(ContextPtr context)
   : mContext{std::move(context)} {
+  mQueues.resize(num_creation_queues());
+  for (auto& queue : mQueues) {
+    queue = std::make_unique<CreationQueue>();
+  }
 }
 
 ResourceCache::~ResourceCache() noexcept {
@@ -137,6 +179,88 @@ auto ResourceCache::load_x_meshes(path const& filePath) -> ext::XModelData {
   return data;
 }
 
+auto ResourceCache::queue_mesh(MeshDataCreateInfo const& info)
+  -> MeshHandle {
+  auto mesh = CreationQueue::QueuedMesh{
+    mContext->reserve_mesh(),
+    VertexLayoutVector{info.layout},
+    vector<byte>{info.vertexData.begin(), info.vertexData.end()},
+    info.vertexCount,
+    vector<byte>{info.indexData.begin(), info.indexData.end()},
+    info.indexCount,
+    info.indexType,
+  };
+  auto const handle = mesh.handle;
+
+  auto& queue = queue_of_this_thread();
+  auto const lock = std::scoped_lock{queue.mutex};
+  queue.meshes.push_back(std::move(mesh));
+
+  return handle;
+}
+
+auto ResourceCache::queue_material(MaterialCreateInfo const& info)
+  -> MaterialHandle {
+  auto material = CreationQueue::QueuedMaterial{
+    mContext->reserve_material(),
+    info.clazz,
+    vector<MaterialProperty>{info.initialValues.begin(),
+                             info.initialValues.end()},
+  };
+  auto const handle = material.handle;
+
+  auto& queue = queue_of_this_thread();
+  auto const lock = std::scoped_lock{queue.mutex};
+  queue.materials.push_back(std::move(material));
+
+  return handle;
+}
+
+auto ResourceCache::commit_queued() -> void {
+  auto meshes = vector<CreationQueue::QueuedMesh>{};
+  auto materials = vector<CreationQueue::QueuedMaterial>{};
+
+  for (auto const& queue : mQueues) {
+    // swap the queue out to hold the lock only briefly
+    {
+      auto const lock = std::scoped_lock{queue->mutex};
+      meshes.swap(queue->meshes);
+      materials.swap(queue->materials);
+    }
+
+    for (auto const& mesh : meshes) {
+      auto const vb = create_vertex_buffer(
+        VertexBufferCreateInfo{mesh.vertexData.size(), mesh.layout},
+        mesh.vertexData);
+      auto ib = IndexBufferHandle{nullhdl};
+      if (!mesh.indexData.empty()) {
+        ib = create_index_buffer(
+          IndexBufferCreateInfo{mesh.indexData.size(), mesh.indexType},
+          mesh.indexData);
+      }
+
+      mMeshes.push_back(
+        mContext
+          ->create_mesh(mesh.handle, MeshCreateInfo{vb, 0, mesh.vertexCount,
+                                                    ib, mesh.indexCount})
+          .release());
+    }
+
+    for (auto const& material : materials) {
+      mMaterials.push_back(
+        mContext
+          ->create_material(material.handle,
+                            MaterialCreateInfo{material.clazz,
+                                               material.initialValues})
+          .release());
+    }
+
+    // keeps the capacity for the next swap
+    meshes.clear();
+    materials.clear();
+  }
+}
+
 auto ResourceCache::destroy_all() noexcept -> void {
   for (auto const handle : mXMeshes) {
     mContext->destroy(handle);
@@ -179,4 +303,10 @@ auto ResourceCache::destroy_all() noexcept -> void {
   }
 }
 
+auto ResourceCache::queue_of_this_thread() -> CreationQueue& {
+  auto const hash = std::hash<std::thread::id>{}(std::this_thread::get_id());
+
+  return *mQueues[hash % mQueues.size()];
+}
+
 } // namespace basalt::gfx
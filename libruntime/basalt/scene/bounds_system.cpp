@@ -0,0 +1,71 @@
+#include <basalt/api/scene/bounds_system.h>
+
+#include <basalt/api/scene/aabb_tree.h>
+#include <basalt/api/scene/bounds.h>
+#include <basalt/api/scene/ecs.h>
+#include <basalt/api/scene/scene.h>
+#include <basalt/api/scene/transform.h>
+
+#include <vector>
+
+namespace basalt {
+
+auto BoundsSystem::on_update(UpdateContext const& ctx) -> void {
+  auto& scene = ctx.scene;
+  auto& entities = scene.entity_registry();
+  auto& spatialIndex = scene.spatial_index();
+
+  // the proxy is destroyed by the scene when the component is removed.
+  // Inactive entities leave the spatial index as well
+  auto const removed = [&] {
+    auto const view =
+      entities.view<SpatialIndexProxy const>(entt::exclude<LocalBounds>);
+    auto removed = std::vector<EntityId>(view.begin(), view.end());
+
+    auto const inactive = entities.view<SpatialIndexProxy const, Inactive>();
+    removed.insert(removed.end(), inactive.begin(), inactive.end());
+
+    return removed;
+  }();
+  entities.remove<SpatialIndexProxy>(removed.begin(), removed.end());
+
+  // refit the existing proxies. The tree is only touched when an entity
+  // leaves its fat box
+  auto const refit = [&](LocalToWorld const& localToWorld,
+                         LocalBounds const& bounds,
+                         SpatialIndexProxy const& proxy) {
+    spatialIndex.move_proxy(proxy.id,
+                            bounds.box.transformed(localToWorld.matrix));
+  };
+
+  if (auto const* changes = entities.ctx().find<LocalToWorldChanges>()) {
+    for (auto const entity : changes->entities) {
+      auto const* proxy = entities.try_get<SpatialIndexProxy>(entity);
+      auto const* bounds = entities.try_get<LocalBounds>(entity);
+      if (proxy && bounds) {
+        refit(entities.get<LocalToWorld const>(entity), *bounds, *proxy);
+      }
+    }
+  } else {
+    entities
+      .view<LocalToWorld const, LocalBounds const, SpatialIndexProxy const>()
+      .each(refit);
+  }
+
+  auto const added = [&] {
+    auto const view = entities.view<LocalToWorld const, LocalBounds const>(
+      entt::exclude<SpatialIndexProxy, Inactive>);
+
+    return std::vector<EntityId>(view.begin(), view.end());
+  }();
+
+  for (auto const entity : added) {
+    auto const& localToWorld = entities.get<LocalToWorld const>(entity);
+    auto const& bounds = entities.get<LocalBounds const>(entity);
+    auto const id = spatialIndex.create_proxy(
+      bounds.box.transformed(localToWorld.matrix), entity);
+    entities.emplace<SpatialIndexProxy>(entity, id);
+  }
+}
+
+} // namespace basalt
@@ -4,19 +4,164 @@
 #include <basalt/api/scene/scene.h>
 #include <basalt/api/scene/transform.h>
 
+#include <basalt/api/base/asserts.h>
+
+#include <vector>
+
 namespace basalt {
 
-auto ParentSystem::on_update(UpdateContext const& ctx) -> void {
-  auto& entityRegistry = ctx.scene.entity_registry();
+ParentSystem::ParentSystem(EntityRegistry& entities) : mEntities{entities} {
+  mEntities.on_construct<Parent>()
+    .connect<&ParentSystem::on_parent_construct>(*this);
+  mEntities.on_update<Parent>().connect<&ParentSystem::on_parent_update>(*this);
+  mEntities.on_destroy<Parent>()
+    .connect<&ParentSystem::on_parent_destroy>(*this);
+  mEntities.on_destroy<Children>()
+    .connect<&ParentSystem::on_children_destroy>(*this);
+  mEntities.on_destroy<ChildLinks>()
+    .connect<&ParentSystem::on_child_links_destroy>(*this);
+
+  // link the children which were added before the system
+  auto const unlinked = [&] {
+    auto const view = mEntities.view<Parent const>(entt::exclude<ChildLinks>);
+
+    return std::vector<EntityId>(view.begin(), view.end());
+  }();
+  for (auto const child : unlinked) {
+    link(child, mEntities.get<Parent const>(child).id);
+  }
+}
+
+ParentSystem::~ParentSystem() noexcept {
+  mEntities.on_construct<Parent>().disconnect(*this);
+  mEntities.on_update<Parent>().disconnect(*this);
+  mEntities.on_destroy<Parent>().disconnect(*this);
+  mEntities.on_destroy<Children>().disconnect(*this);
+  mEntities.on_destroy<ChildLinks>().disconnect(*this);
+}
+
+auto ParentSystem::on_update(UpdateContext const&) -> void {
+  // the hierarchy is kept up to date by the signals
+}
+
+auto ParentSystem::on_parent_construct(EntityRegistry& entities,
+                                       EntityId const entity) -> void {
+  link(entity, entities.get<Parent const>(entity).id);
+}
+
+auto ParentSystem::on_parent_update(EntityRegistry& entities,
+                                    EntityId const entity) -> void {
+  unlink(entity);
+  link(entity, entities.get<Parent const>(entity).id);
+}
+
+auto ParentSystem::on_parent_destroy(EntityRegistry&, EntityId const entity)
+  -> void {
+  unlink(entity);
+}
 
-  entityRegistry.clear<Children>();
+// The children are detached first, so removing their ChildLinks and Parent
+// doesn't touch the list of the destroyed parent anymore
+auto ParentSystem::on_children_destroy(EntityRegistry& entities,
+                                       EntityId const entity) -> void {
+  auto& children = entities.get<Children>(entity);
 
-  auto const children = entityRegistry.view<Parent>();
+  auto orphans = std::vector<EntityId>{};
+  orphans.reserve(children.count);
 
-  for (auto const&& [id, parent] : children.each()) {
-    auto& childrenOfParent = entityRegistry.get_or_emplace<Children>(parent.id);
-    childrenOfParent.ids.push_back(id);
+  for (auto child = children.first; child != entt::null;) {
+    auto& links = entities.get<ChildLinks>(child);
+    links.parent = entt::null;
+    orphans.push_back(child);
+    child = links.next;
   }
+
+  children.first = entt::null;
+  children.count = 0;
+
+  entities.remove<ChildLinks>(orphans.begin(), orphans.end());
+  entities.remove<Parent>(orphans.begin(), orphans.end());
 }
 
+// called before the ChildLinks are removed, so they can still be read
+auto ParentSystem::on_child_links_destroy(EntityRegistry& entities,
+                                          EntityId const child) -> void {
+  auto const [parent, previous, next] = entities.get<ChildLinks const>(child);
+
+  // detached by the destruction of the parent
+  if (parent == entt::null) {
+    return;
+  }
+
+  if (previous != entt::null) {
+    entities.get<ChildLinks>(previous).next = next;
+  }
+  if (next != entt::null) {
+    entities.get<ChildLinks>(next).previous = previous;
+  }
+
+  auto& children = entities.get<Children>(parent);
+  if (children.first == child) {
+    children.first = next;
+  }
+
+  if (--children.count == 0) {
+    entities.remove<Children>(parent);
+
+    return;
+  }
+
+#if BASALT_IS_DEV_BUILD
+  validate_children(parent);
+#endif
+}
+
+// the child becomes the first one of the parent
+auto ParentSystem::link(EntityId const child, EntityId const parent) -> void {
+  BASALT_ASSERT(mEntities.valid(parent));
+  BASALT_ASSERT(child != parent);
+
+  auto& children = mEntities.get_or_emplace<Children>(parent);
+  auto const next = children.first;
+  children.first = child;
+  children.count++;
+
+  mEntities.emplace_or_replace<ChildLinks>(child, parent, entt::null, next);
+  if (next != entt::null) {
+    mEntities.get<ChildLinks>(next).previous = child;
+  }
+}
+
+// the list is fixed up by on_child_links_destroy
+auto ParentSystem::unlink(EntityId const child) -> void {
+  mEntities.remove<ChildLinks>(child);
+}
+
+#if BASALT_IS_DEV_BUILD
+
+// Walks the whole list, so it's only done in dev builds. Catches children
+// which were destroyed without leaving the list, e.g. because of a signal
+// which wasn't called
+auto ParentSystem::validate_children(EntityId const parent) const -> void {
+  auto const& children = mEntities.get<Children const>(parent);
+
+  auto count = u32{0};
+  auto previous = EntityId{entt::null};
+  for (auto child = children.first; child != entt::null;) {
+    BASALT_ASSERT(mEntities.valid(child), "destroyed child in list");
+
+    auto const& links = mEntities.get<ChildLinks const>(child);
+    BASALT_ASSERT(links.parent == parent);
+    BASALT_ASSERT(links.previous == previous);
+
+    ++count;
+    previous = child;
+    child = links.next;
+  }
+
+  BASALT_ASSERT(count == children.count);
+}
+
+#endif
+
 } // namespace basalt
@@ -0,0 +1,46 @@
+#include <basalt/api/scene/spatial_hash_grid_system.h>
+
+#include <basalt/api/scene/ecs.h>
+#include <basalt/api/scene/scene.h>
+#include <basalt/api/scene/spatial_hash_grid.h>
+#include <basalt/api/scene/transform.h>
+
+#include <basalt/api/math/affine3x4.h>
+#include <basalt/api/math/vector3.h>
+
+namespace basalt {
+
+SpatialHashGridSystem::SpatialHashGridSystem(f32 const cellSize) noexcept
+  : mCellSize{cellSize} {
+}
+
+auto SpatialHashGridSystem::on_update(UpdateContext const& ctx) -> void {
+  auto& entities = ctx.scene.entity_registry();
+  auto& ecsCtx = entities.ctx();
+
+  auto& grid = [&]() -> SpatialHashGrid& {
+    if (auto* const existing = ecsCtx.find<SpatialHashGrid>()) {
+      return *existing;
+    }
+
+    return ecsCtx.emplace<SpatialHashGrid>(mCellSize);
+  }();
+
+  // Only copies the positions, so it stays serial. Appending from several
+  // threads would need a compaction pass for the excluded entities. The
+  // expensive part of the build is parallelized by the grid itself
+  mEntries.clear();
+  auto const hashedEntities =
+    entities.view<LocalToWorld const, SpatialHashed const>(
+      entt::exclude<Inactive>);
+  hashedEntities.each([&](EntityId const entity,
+                           LocalToWorld const& localToWorld,
+                           SpatialHashed const& hashed) {
+    mEntries.push_back(SpatialHashGrid::Entry{
+      localToWorld.matrix.translation(), hashed.radius, entity});
+  });
+
+  grid.build(mEntries);
+}
+
+} // namespace basalt
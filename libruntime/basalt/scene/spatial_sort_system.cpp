@@ -0,0 +1,36 @@
+#include <basalt/api/scene/spatial_sort_system.h>
+
+#include <basalt/api/scene/ecs.h>
+#include <basalt/api/scene/scene.h>
+#include <basalt/api/scene/transform.h>
+
+#include <basalt/api/math/affine3x4.h>
+
+#include <array>
+
+namespace basalt {
+
+SpatialSortSystem::SpatialSortSystem(f32 const cellSize,
+                                     u32 const windowSize) noexcept
+  : mCellSize{cellSize}, mSort{windowSize} {
+}
+
+auto SpatialSortSystem::on_update(UpdateContext const& ctx) -> void {
+  auto& entities = ctx.scene.entity_registry();
+
+  // the group keeps the three storages in the same order
+  auto const group =
+    entities.group<Transform, LocalToWorld, PreviousTransform>(
+      entt::get<>, entt::exclude<Inactive>);
+  auto& localToWorlds = entities.storage<LocalToWorld>();
+  auto const storages = std::array<entt::sparse_set*, 3>{
+    &entities.storage<Transform>(), &localToWorlds,
+    &entities.storage<PreviousTransform>()};
+
+  mSort.step(storages, group.size(), [&](EntityId const entity) {
+    return morton_code(localToWorlds.get(entity).matrix.translation(),
+                       mCellSize);
+  });
+}
+
+} // namespace basalt
@@ -4,49 +4,312 @@
 #include <basalt/api/scene/scene.h>
 #include <basalt/api/scene/transform.h>
 
-#include <basalt/api/math/matrix4.h>
+#include <basalt/api/math/affine3x4.h>
+#include <basalt/api/math/batch.h>
+#include <basalt/api/math/vector3.h>
+
+#include <basalt/api/base/job_system.h>
+
+#include <gsl/span>
+
+#include <array>
+#include <vector>
 
 namespace basalt {
 
 namespace {
 
-auto compute_child_local_to_world(EntityRegistry& entities,
-                                  Matrix4x4f32 const& parentLocalToWorld,
-                                  EntityId const childId) -> void {
-  auto const& transform = entities.get<Transform const>(childId);
-  auto& localToWorld = entities.get<LocalToWorld>(childId);
-  localToWorld.matrix = transform.to_matrix() * parentLocalToWorld;
+// smaller chunks aren't worth the overhead of a job
+constexpr auto MIN_NODES_PER_TASK = u32{2048};
+
+// Transforms gathered into structure of arrays to compose their matrices with
+// batch::compose_transforms. Every transform is pushed together with the
+// target of its matrix
+template <typename Target>
+class TransformBatch final {
+public:
+  static constexpr auto CAPACITY = uSize{64};
+
+  // calls write(target, matrix) for every pushed transform when full.
+  // Quaternion rotations aren't batched and are written right away
+  template <typename Write>
+  auto push(Target const target, Transform const& transform,
+            Write const& write) -> void {
+    if (transform.rotationMode == Transform::RotationMode::Quaternion) {
+      write(target, transform.to_affine());
 
-  // descent the hierarchy recursively
-  if (auto const* children = entities.try_get<Children>(childId)) {
-    for (auto const child : children->ids) {
-      compute_child_local_to_world(entities, localToWorld.matrix, child);
+      return;
+    }
+
+    mTargets[mSize] = target;
+    mPositions.set(mSize, transform.position);
+    mRotations.set(mSize, transform.rotation);
+    mScales.set(mSize, transform.scale);
+
+    if (++mSize == CAPACITY) {
+      flush(write);
     }
   }
-}
+
+  template <typename Write>
+  auto flush(Write const& write) -> void {
+    auto const matrices = gsl::span{mMatrices}.first(mSize);
+    batch::compose_transforms(mPositions.first(mSize), mRotations.first(mSize),
+                              mScales.first(mSize), matrices);
+
+    for (auto i = uSize{0}; i < mSize; ++i) {
+      write(mTargets[i], matrices[i]);
+    }
+
+    mSize = 0;
+  }
+
+private:
+  struct Vectors final {
+    std::array<f32, CAPACITY> x;
+    std::array<f32, CAPACITY> y;
+    std::array<f32, CAPACITY> z;
+
+    auto set(uSize const i, Vector3f32 const& v) -> void {
+      x[i] = v.x();
+      y[i] = v.y();
+      z[i] = v.z();
+    }
+
+    [[nodiscard]]
+    auto first(uSize const count) const -> batch::ConstVectors3f32 {
+      return batch::ConstVectors3f32{gsl::span{x}.first(count),
+                                     gsl::span{y}.first(count),
+                                     gsl::span{z}.first(count)};
+    }
+  };
+
+  std::array<Target, CAPACITY> mTargets;
+  Vectors mPositions;
+  Vectors mRotations;
+  Vectors mScales;
+  std::array<Affine3x4f32, CAPACITY> mMatrices;
+  uSize mSize{};
+};
 
 } // namespace
 
-auto TransformSystem::on_update(UpdateContext const& ctx) -> void {
-  auto& entities = ctx.scene.entity_registry();
+TransformSystem::TransformSystem(EntityRegistry& entities)
+  : mEntities{entities} {
+  mEntities.ctx().emplace<LocalToWorldChanges>();
+
+  // Children and ChildLinks only change with Parent.
+  // Changes of the Transform itself are found by comparing it to the
+  // PreviousTransform, which also catches writes without patch
+  mEntities.on_construct<Parent>()
+    .connect<&TransformSystem::on_local_to_world_invalidated>(*this);
+  mEntities.on_update<Parent>()
+    .connect<&TransformSystem::on_local_to_world_invalidated>(*this);
+  mEntities.on_destroy<Parent>()
+    .connect<&TransformSystem::on_local_to_world_invalidated>(*this);
+  mEntities.on_construct<Transform>()
+    .connect<&TransformSystem::on_local_to_world_invalidated>(*this);
+  mEntities.on_destroy<Transform>()
+    .connect<&TransformSystem::on_local_to_world_invalidated>(*this);
+  mEntities.on_construct<LocalToWorld>()
+    .connect<&TransformSystem::on_local_to_world_invalidated>(*this);
+  mEntities.on_destroy<LocalToWorld>()
+    .connect<&TransformSystem::on_local_to_world_invalidated>(*this);
+  // nodes leave and reenter the hierarchy with Inactive
+  mEntities.on_construct<Inactive>()
+    .connect<&TransformSystem::on_local_to_world_invalidated>(*this);
+  mEntities.on_destroy<Inactive>()
+    .connect<&TransformSystem::on_local_to_world_invalidated>(*this);
+
+  // created before any update, because creating it isn't thread safe
+  static_cast<void>(
+    mEntities.group<Transform, LocalToWorld, PreviousTransform>(
+      entt::get<>, entt::exclude<Inactive>));
+}
+
+TransformSystem::~TransformSystem() noexcept {
+  mEntities.on_construct<Parent>().disconnect(*this);
+  mEntities.on_update<Parent>().disconnect(*this);
+  mEntities.on_destroy<Parent>().disconnect(*this);
+  mEntities.on_construct<Transform>().disconnect(*this);
+  mEntities.on_destroy<Transform>().disconnect(*this);
+  mEntities.on_construct<LocalToWorld>().disconnect(*this);
+  mEntities.on_destroy<LocalToWorld>().disconnect(*this);
+  mEntities.on_construct<Inactive>().disconnect(*this);
+  mEntities.on_destroy<Inactive>().disconnect(*this);
+}
+
+auto TransformSystem::on_update(UpdateContext const&) -> void {
+  auto& changes = mEntities.ctx().get<LocalToWorldChanges>();
+  changes.entities.clear();
+
+  auto const added = [&] {
+    auto const view = mEntities.view<Transform const, LocalToWorld const>(
+      entt::exclude<PreviousTransform, Inactive>);
 
-  auto const rootEntities = entities.view<Transform const, LocalToWorld>();
+    return std::vector<EntityId>(view.begin(), view.end());
+  }();
+  mEntities.insert<PreviousTransform>(added.begin(), added.end());
 
-  rootEntities.each([](Transform const& transform, LocalToWorld& localToWorld) {
-    localToWorld.matrix = transform.to_matrix();
+  auto const isHierarchyRebuilt = mIsDirty;
+  if (mIsDirty) {
+    rebuild_hierarchy();
+    mIsDirty = false;
+  }
+
+  auto const writeLocalToWorld = [](LocalToWorld* const localToWorld,
+                                    Affine3x4f32 const& matrix) {
+    localToWorld->matrix = matrix;
+  };
+
+  // walks the three components as parallel arrays instead of looking each
+  // one up. The nodes of the hierarchies are skipped and updated below
+  auto const& parents = mEntities.storage<Parent>();
+  auto const& children = mEntities.storage<Children>();
+  auto rootBatch = TransformBatch<LocalToWorld*>{};
+  auto const group =
+    mEntities.group<Transform, LocalToWorld, PreviousTransform>(
+      entt::get<>, entt::exclude<Inactive>);
+  group.each([&](EntityId const entity, Transform const& transform,
+                 LocalToWorld& localToWorld, PreviousTransform& previous) {
+    if (parents.contains(entity) || children.contains(entity) ||
+        previous.transform == transform) {
+      return;
+    }
+
+    previous.transform = transform;
+    rootBatch.push(&localToWorld, transform, writeLocalToWorld);
+    changes.entities.push_back(entity);
   });
+  rootBatch.flush(writeLocalToWorld);
+
+  if (mNodes.empty()) {
+    return;
+  }
+
+  // looked up once because the threads must not touch the registry
+  auto const& transforms = mEntities.storage<Transform>();
+  auto& previousTransforms = mEntities.storage<PreviousTransform>();
+  auto& localToWorlds = mEntities.storage<LocalToWorld>();
+
+  // the parents are on the previous level and therefore already computed
+  auto const writeNode = [&](u32 const i, Affine3x4f32 const& local) {
+    auto const& node = mNodes[i];
+    mMatrices[i] =
+      node.parent != NO_PARENT ? local * mMatrices[node.parent] : local;
+    localToWorlds.get(node.entity).matrix = mMatrices[i];
+  };
 
-  // compute the LocalToWorld matrix for the children.
-  // start with the parents at the root, then descent the hierarchy with a
-  // recursive helper function
-  auto const rootParents =
-    entities.view<LocalToWorld const, Children const>(entt::exclude<Parent>);
-  rootParents.each(
-    [&](LocalToWorld const& localToWorld, Children const& children) {
-      for (auto const child : children.ids) {
-        compute_child_local_to_world(entities, localToWorld.matrix, child);
+  auto const updateNodes = [&](u32 const begin, u32 const end) {
+    auto nodeBatch = TransformBatch<u32>{};
+    for (auto i = begin; i < end; ++i) {
+      auto const& node = mNodes[i];
+
+      // a root without Transform keeps its LocalToWorld, which is the parent
+      // matrix of its children
+      if (!transforms.contains(node.entity)) {
+        auto const& matrix = localToWorlds.get(node.entity).matrix;
+        mIsNodeChanged[i] = isHierarchyRebuilt || mMatrices[i] != matrix;
+        mMatrices[i] = matrix;
+
+        continue;
+      }
+
+      auto const& transform = transforms.get(node.entity);
+      auto& previous = previousTransforms.get(node.entity);
+
+      auto const hasParent = node.parent != NO_PARENT;
+      auto const isChanged = isHierarchyRebuilt ||
+                             (hasParent && mIsNodeChanged[node.parent]) ||
+                             previous.transform != transform;
+      mIsNodeChanged[i] = isChanged;
+      if (!isChanged) {
+        continue;
       }
-    });
+
+      previous.transform = transform;
+      nodeBatch.push(i, transform, writeNode);
+    }
+    nodeBatch.flush(writeNode);
+  };
+
+  // every depth only depends on the previous ones
+  auto& jobSystem = JobSystem::global();
+  for (auto level = uSize{0}; level + 1 < mLevelStarts.size(); ++level) {
+    auto const begin = mLevelStarts[level];
+    auto const end = mLevelStarts[level + 1];
+
+    jobSystem.parallel_for(end - begin, MIN_NODES_PER_TASK,
+                           [&](u32 const first, u32 const last) {
+                             updateNodes(begin + first, begin + last);
+                           });
+  }
+
+  for (auto i = uSize{0}; i < mNodes.size(); ++i) {
+    if (mIsNodeChanged[i]) {
+      changes.entities.push_back(mNodes[i].entity);
+    }
+  }
+}
+
+auto TransformSystem::on_local_to_world_invalidated(EntityRegistry& entities,
+                                                    EntityId const entity)
+  -> void {
+  if (auto* previous = entities.try_get<PreviousTransform>(entity)) {
+    previous->transform.reset();
+  }
+
+  if (entities.any_of<Parent, Children>(entity)) {
+    mIsDirty = true;
+  }
+}
+
+auto TransformSystem::rebuild_hierarchy() -> void {
+  mNodes.clear();
+  mLevelStarts.clear();
+
+  auto const roots = mEntities.view<LocalToWorld const, Children const>(
+    entt::exclude<Parent, Inactive>);
+  for (auto const entity : roots) {
+    mNodes.push_back(Node{entity, NO_PARENT});
+  }
+
+  if (mNodes.empty()) {
+    mMatrices.clear();
+    mIsNodeChanged.clear();
+
+    return;
+  }
+
+  mLevelStarts.push_back(0);
+
+  // breadth first to sort the nodes by depth
+  auto levelBegin = u32{0};
+  while (levelBegin < mNodes.size()) {
+    auto const levelEnd = static_cast<u32>(mNodes.size());
+    mLevelStarts.push_back(levelEnd);
+
+    for (auto i = levelBegin; i < levelEnd; ++i) {
+      auto const* children = mEntities.try_get<Children>(mNodes[i].entity);
+      if (!children) {
+        continue;
+      }
+
+      // the descendants of inactive children are skipped as well
+      for (auto child = children->first; child != entt::null;
+           child = mEntities.get<ChildLinks const>(child).next) {
+        if (mEntities.all_of<Transform, LocalToWorld>(child) &&
+            !mEntities.all_of<Inactive>(child)) {
+          mNodes.push_back(Node{child, i});
+        }
+      }
+    }
+
+    levelBegin = levelEnd;
+  }
+
+  mMatrices.resize(mNodes.size());
+  mIsNodeChanged.resize(mNodes.size());
 }
 
 } // namespace basalt
@@ -11,6 +11,7 @@
 
 #include <basalt/api/shared/color.h>
 
+#include <basalt/api/math/affine3x4.h>
 #include <basalt/api/math/matrix4.h>
 #include <basalt/api/math/vector3.h>
 
@@ -62,6 +63,16 @@ constexpr auto to_d3d(Matrix4x4f32 const& mat) noexcept -> D3DMATRIX {
   // clang-format on
 }
 
+// expands the affine matrix to 4x4
+constexpr auto to_d3d(Affine3x4f32 const& mat) noexcept -> D3DMATRIX {
+  // clang-format off
+  return D3DMATRIX{mat.m11(), mat.m12(), mat.m13(), 0.0f,
+                   mat.m21(), mat.m22(), mat.m23(), 0.0f,
+                   mat.m31(), mat.m32(), mat.m33(), 0.0f,
+                   mat.m41(), mat.m42(), mat.m43(), 1.0f};
+  // clang-format on
+}
+
 constexpr auto to_d3d(Vector3f32 const& vec) noexcept -> D3DVECTOR {
   return D3DVECTOR{vec.x(), vec.y(), vec.z()};
 }
@@ -618,6 +618,13 @@ auto D3D9Device::execute(CommandSetTransform const& cmd) -> void {
   D3D9CHECK(mDevice->SetTransform(state, &transform));
 }
 
+auto D3D9Device::execute(CommandSetAffineTransform const& cmd) -> void {
+  auto const state = to_d3d(cmd.transformState);
+  auto const transform{to_d3d(cmd.transform)};
+
+  D3D9CHECK(mDevice->SetTransform(state, &transform));
+}
+
 auto D3D9Device::execute(CommandSetAmbientLight const& cmd) -> void {
   D3D9CHECK(mDevice->SetRenderState(D3DRS_AMBIENT, to_d3d_color(cmd.ambient)));
 }
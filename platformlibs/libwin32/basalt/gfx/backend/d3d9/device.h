@@ -126,6 +126,7 @@ private:
   auto execute(CommandSetStencilWriteMask const&) -> void;
   auto execute(CommandSetBlendConstant const&) -> void;
   auto execute(CommandSetTransform const&) -> void;
+  auto execute(CommandSetAffineTransform const&) -> void;
   auto execute(CommandSetAmbientLight const&) -> void;
   auto execute(CommandSetLights const&) -> void;
   auto execute(CommandSetMaterial const&) -> void;
@@ -6,4 +6,5 @@ class Benchmarks {
 public:
   static auto make_textured_triangles_view(basalt::Engine&) -> basalt::ViewPtr;
   static auto make_cubes_view(basalt::Engine&) -> basalt::ViewPtr;
+  static auto make_cpu_view(basalt::Engine&) -> basalt::ViewPtr;
 };
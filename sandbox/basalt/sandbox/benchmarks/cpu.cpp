@@ -0,0 +1,1455 @@
+#include "benchmarks.h"
+
+#include <basalt/api/engine.h>
+#include <basalt/api/prelude.h>
+#include <basalt/api/view.h>
+
+#include <basalt/api/gfx/context.h>
+#include <basalt/api/gfx/material.h>
+#include <basalt/api/gfx/material_class.h>
+#include <basalt/api/gfx/mesh.h>
+#include <basalt/api/gfx/resource_cache.h>
+#include <basalt/api/gfx/types.h>
+#include <basalt/api/gfx/backend/command_list.h>
+#include <basalt/api/gfx/backend/pipeline.h>
+#include <basalt/api/gfx/backend/vertex_layout.h>
+
+#include <basalt/api/scene/aabb_tree.h>
+#include <basalt/api/scene/bounds.h>
+#include <basalt/api/scene/command_buffer.h>
+#include <basalt/api/scene/ecs.h>
+#include <basalt/api/scene/entity_pool.h>
+#include <basalt/api/scene/parallel.h>
+#include <basalt/api/scene/parent_system.h>
+#include <basalt/api/scene/prefab.h>
+#include <basalt/api/scene/scene.h>
+#include <basalt/api/scene/spatial_hash_grid.h>
+#include <basalt/api/scene/system.h>
+#include <basalt/api/scene/transform.h>
+#include <basalt/api/scene/transform_system.h>
+#include <basalt/api/scene/types.h>
+
+#include <basalt/api/shared/handle.h>
+#include <basalt/api/shared/handle_pool.h>
+
+#include <basalt/api/math/aabb.h>
+#include <basalt/api/math/affine3x4.h>
+#include <basalt/api/math/angle.h>
+#include <basalt/api/math/batch.h>
+#include <basalt/api/math/frustum.h>
+#include <basalt/api/math/matrix3.h>
+#include <basalt/api/math/matrix4.h>
+#include <basalt/api/math/vector3.h>
+#include <basalt/api/math/vector4.h>
+
+#include <basalt/api/base/job_system.h>
+#include <basalt/api/base/types.h>
+
+#include <gsl/span>
+#include <imgui.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <numeric>
+#include <optional>
+#include <random>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace basalt;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using Distribution = std::uniform_real_distribution<float>;
+
+auto constexpr NUM_QUERIES = u32{1000};
+auto constexpr WORLD_EXTENT = 1000.0f;
+
+auto milliseconds_since(Clock::time_point const start) -> f64 {
+  return std::chrono::duration<f64, std::milli>{Clock::now() - start}.count();
+}
+
+struct AabbTreeResults final {
+  u32 numEntities{};
+  u32 height{};
+  u32 numReinserted{};
+  u64 numHits{};
+  f64 build{};
+  f64 refit{};
+  f64 boxQueries{};
+  f64 batchBoxQueries{};
+  f64 sphereQueries{};
+  f64 raycasts{};
+  f64 frustumQuery{};
+};
+
+auto run_aabb_tree_benchmark(u32 const numEntities) -> AabbTreeResults {
+  auto results = AabbTreeResults{};
+  results.numEntities = numEntities;
+
+  // fixed seed to make runs comparable
+  auto randomEngine = std::default_random_engine{42};
+  auto position = Distribution{-WORLD_EXTENT, WORLD_EXTENT};
+  auto size = Distribution{0.5f, 2.0f};
+  auto offset = Distribution{-0.05f, 0.05f};
+
+  auto const randomPosition = [&] {
+    return Vector3f32{position(randomEngine), position(randomEngine),
+                      position(randomEngine)};
+  };
+
+  auto boxes = std::vector<Aabb>{};
+  boxes.reserve(numEntities);
+  for (auto i = u32{0}; i < numEntities; ++i) {
+    boxes.push_back(Aabb::from_center_half_extents(
+      randomPosition(), Vector3f32{size(randomEngine)}));
+  }
+
+  auto tree = AabbTree{};
+  auto proxies = std::vector<AabbTree::ProxyId>{};
+  proxies.reserve(numEntities);
+
+  auto start = Clock::now();
+  for (auto i = u32{0}; i < numEntities; ++i) {
+    proxies.push_back(tree.create_proxy(boxes[i], static_cast<EntityId>(i)));
+  }
+  results.build = milliseconds_since(start);
+  results.height = tree.height();
+
+  // every entity moves a bit, like in a frame of a game
+  for (auto& box : boxes) {
+    auto const delta = Vector3f32{offset(randomEngine), offset(randomEngine),
+                                  offset(randomEngine)};
+    box = Aabb::from_min_max(box.min() + delta, box.max() + delta);
+  }
+
+  start = Clock::now();
+  for (auto i = u32{0}; i < numEntities; ++i) {
+    results.numReinserted += tree.move_proxy(proxies[i], boxes[i]) ? 1 : 0;
+  }
+  results.refit = milliseconds_since(start);
+
+  auto queryBoxes = std::vector<Aabb>{};
+  queryBoxes.reserve(NUM_QUERIES);
+  for (auto i = u32{0}; i < NUM_QUERIES; ++i) {
+    queryBoxes.push_back(
+      Aabb::from_center_half_extents(randomPosition(), Vector3f32{20.0f}));
+  }
+
+  auto const countHit = [&](EntityId) { results.numHits++; };
+
+  start = Clock::now();
+  for (auto const& box : queryBoxes) {
+    tree.query(box, countHit);
+  }
+  results.boxQueries = milliseconds_since(start);
+
+  start = Clock::now();
+  tree.query(gsl::span<Aabb const>{queryBoxes},
+             [&](uSize, EntityId) { results.numHits++; });
+  results.batchBoxQueries = milliseconds_since(start);
+
+  start = Clock::now();
+  for (auto const& box : queryBoxes) {
+    tree.query_sphere(box.center(), 20.0f, countHit);
+  }
+  results.sphereQueries = milliseconds_since(start);
+
+  start = Clock::now();
+  for (auto const& box : queryBoxes) {
+    auto const direction = Vector3f32::normalized(-box.center());
+    tree.raycast(box.center(), direction, 2.0f * WORLD_EXTENT,
+                 [&](EntityId, f32 const distance) {
+                   results.numHits++;
+
+                   return distance;
+                 });
+  }
+  results.raycasts = milliseconds_since(start);
+
+  auto const worldToClip =
+    Matrix4x4f32::look_at_lh(Vector3f32{0.0f, 0.0f, -WORLD_EXTENT},
+                             Vector3f32{}, Vector3f32::up()) *
+    Matrix4x4f32::perspective_projection(60_deg, 16.0f / 9.0f, 0.1f,
+                                         WORLD_EXTENT);
+  start = Clock::now();
+  tree.query(Frustum::from_matrix(worldToClip), countHit);
+  results.frustumQuery = milliseconds_since(start);
+
+  return results;
+}
+
+struct SpatialHashGridResults final {
+  u32 numEntities{};
+  u64 numHits{};
+  f64 build{};
+  f64 radiusQueries{};
+  f64 nearestQueries{};
+};
+
+auto run_spatial_hash_grid_benchmark(u32 const numEntities)
+  -> SpatialHashGridResults {
+  auto results = SpatialHashGridResults{};
+  results.numEntities = numEntities;
+
+  // a dense swarm: one entity per 4x4x4 cell on average
+  auto const extent = 2.0f * std::cbrt(static_cast<f32>(numEntities));
+
+  auto randomEngine = std::default_random_engine{42};
+  auto position = Distribution{-extent, extent};
+  auto radius = Distribution{0.5f, 2.0f};
+
+  auto const randomPosition = [&] {
+    return Vector3f32{position(randomEngine), position(randomEngine),
+                      position(randomEngine)};
+  };
+
+  auto entries = std::vector<SpatialHashGrid::Entry>{};
+  entries.reserve(numEntities);
+  for (auto i = u32{0}; i < numEntities; ++i) {
+    entries.push_back(SpatialHashGrid::Entry{
+      randomPosition(), radius(randomEngine), static_cast<EntityId>(i)});
+  }
+
+  auto grid = SpatialHashGrid{4.0f};
+
+  auto start = Clock::now();
+  grid.build(entries);
+  results.build = milliseconds_since(start);
+
+  auto queryPositions = std::vector<Vector3f32>{};
+  queryPositions.reserve(NUM_QUERIES);
+  for (auto i = u32{0}; i < NUM_QUERIES; ++i) {
+    queryPositions.push_back(randomPosition());
+  }
+
+  start = Clock::now();
+  for (auto const& p : queryPositions) {
+    grid.query_radius(p, 8.0f,
+                      [&](SpatialHashGrid::Entry const&) { results.numHits++; });
+  }
+  results.radiusQueries = milliseconds_since(start);
+
+  auto neighbors = std::vector<SpatialHashGrid::Neighbor>{};
+  start = Clock::now();
+  for (auto const& p : queryPositions) {
+    grid.query_nearest(p, 8, neighbors);
+    results.numHits += neighbors.size();
+  }
+  results.nearestQueries = milliseconds_since(start);
+
+  return results;
+}
+
+struct TransformHierarchyResults final {
+  u32 numEntities{};
+  u32 numLevels{};
+  f64 firstUpdate{};
+  f64 staticUpdate{};
+  f64 movingUpdate{};
+  f64 recursiveUpdate{};
+};
+
+// the TransformSystem before flattening the hierarchy, as a reference
+auto update_recursively(EntityRegistry& entities, EntityId const entity,
+                        Affine3x4f32 const& parentLocalToWorld) -> void {
+  auto& localToWorld = entities.get<LocalToWorld>(entity);
+  localToWorld.matrix =
+    entities.get<Transform const>(entity).to_affine() * parentLocalToWorld;
+
+  if (auto const* children = entities.try_get<Children>(entity)) {
+    for (auto child = children->first; child != entt::null;
+         child = entities.get<ChildLinks const>(child).next) {
+      update_recursively(entities, child, localToWorld.matrix);
+    }
+  }
+}
+
+auto run_transform_hierarchy_benchmark(u32 const numEntities,
+                                       u32 const numLevels)
+  -> TransformHierarchyResults {
+  constexpr auto numUpdates = 10;
+
+  auto results = TransformHierarchyResults{};
+  results.numEntities = numEntities;
+  results.numLevels = numLevels;
+
+  auto randomEngine = std::default_random_engine{42};
+  auto offset = Distribution{-1.0f, 1.0f};
+
+  auto const scene = std::make_shared<Scene>();
+  auto& entities = scene->entity_registry();
+
+  // the same number of entities on every level, each one parented to a random
+  // entity of the level above
+  auto const entitiesPerLevel = numEntities / numLevels;
+  auto previousLevel = std::vector<EntityId>{};
+  auto level = std::vector<EntityId>{};
+  for (auto depth = u32{0}; depth < numLevels; ++depth) {
+    level.clear();
+    auto parent = std::uniform_int_distribution<uSize>{
+      0, std::max(previousLevel.size(), uSize{1}) - 1};
+
+    for (auto i = u32{0}; i < entitiesPerLevel; ++i) {
+      auto const entity = scene->create_entity(
+        Vector3f32{offset(randomEngine), offset(randomEngine),
+                   offset(randomEngine)},
+        Vector3f32{offset(randomEngine), 0.0f, 0.0f});
+      level.push_back(entity.entity());
+
+      if (!previousLevel.empty()) {
+        entity.emplace<Parent>(previousLevel[parent(randomEngine)]);
+      }
+    }
+
+    std::swap(previousLevel, level);
+  }
+
+  auto commands = EntityCommandBuffer{entities, scene->entity_reserve()};
+  auto const ctx =
+    System::UpdateContext{SecondsF32{}, SecondsF32{}, *scene, commands};
+
+  auto start = Clock::now();
+  auto parentSystem = ParentSystem{entities};
+  auto transformSystem = TransformSystem{entities};
+  parentSystem.on_update(ctx);
+  transformSystem.on_update(ctx);
+  results.firstUpdate = milliseconds_since(start);
+
+  start = Clock::now();
+  for (auto i = 0; i < numUpdates; ++i) {
+    transformSystem.on_update(ctx);
+  }
+  results.staticUpdate = milliseconds_since(start) / numUpdates;
+
+  for (auto i = 0; i < numUpdates; ++i) {
+    entities.view<Transform>().each(
+      [](Transform& transform) { transform.rotate_y(1_deg); });
+
+    start = Clock::now();
+    transformSystem.on_update(ctx);
+    results.movingUpdate += milliseconds_since(start) / numUpdates;
+  }
+
+  start = Clock::now();
+  for (auto i = 0; i < numUpdates; ++i) {
+    entities.view<Transform const, LocalToWorld>().each(
+      [](Transform const& transform, LocalToWorld& localToWorld) {
+        localToWorld.matrix = transform.to_affine();
+      });
+    entities.view<LocalToWorld const, Children const>(entt::exclude<Parent>)
+      .each([&](LocalToWorld const& localToWorld, Children const& children) {
+        for (auto child = children.first; child != entt::null;
+             child = entities.get<ChildLinks const>(child).next) {
+          update_recursively(entities, child, localToWorld.matrix);
+        }
+      });
+  }
+  results.recursiveUpdate = milliseconds_since(start) / numUpdates;
+
+  return results;
+}
+
+struct ComponentIterationResults final {
+  u32 numEntities{};
+  // view<Transform const, LocalToWorld, PreviousTransform> against the group
+  // of the TransformSystem
+  f64 transformView{};
+  f64 transformGroup{};
+  // view<LocalToWorld const, Model const> against an owning group of Model
+  f64 modelView{};
+  f64 modelGroup{};
+};
+
+// Fills both registries with the same entities. The components are added in
+// a shuffled order, like after entities came and went, so that the storages
+// of the view aren't accidentally sorted the same
+auto run_component_iteration_benchmark(u32 const numEntities)
+  -> ComponentIterationResults {
+  constexpr auto numIterations = 10;
+
+  auto results = ComponentIterationResults{};
+  results.numEntities = numEntities;
+
+  auto viewEntities = EntityRegistry{};
+  auto groupEntities = EntityRegistry{};
+  static_cast<void>(
+    groupEntities.group<Transform, LocalToWorld, PreviousTransform>());
+  static_cast<void>(groupEntities.group<gfx::Model>(entt::get<LocalToWorld>));
+
+  auto randomEngine = std::default_random_engine{42};
+  auto offset = Distribution{-WORLD_EXTENT, WORLD_EXTENT};
+
+  auto ids = std::vector<EntityId>(numEntities);
+  viewEntities.create(ids.begin(), ids.end());
+  groupEntities.create(ids.begin(), ids.end());
+
+  auto const emplaceShuffled = [&](auto const& emplace) {
+    std::shuffle(ids.begin(), ids.end(), randomEngine);
+    for (auto const id : ids) {
+      emplace(viewEntities, id);
+      emplace(groupEntities, id);
+    }
+  };
+  emplaceShuffled([&](EntityRegistry& entities, EntityId const id) {
+    entities.emplace<Transform>(
+      id, Vector3f32{offset(randomEngine), offset(randomEngine),
+                     offset(randomEngine)});
+  });
+  emplaceShuffled([](EntityRegistry& entities, EntityId const id) {
+    entities.emplace<LocalToWorld>(id);
+  });
+  emplaceShuffled([](EntityRegistry& entities, EntityId const id) {
+    entities.emplace<PreviousTransform>(id);
+  });
+  emplaceShuffled([](EntityRegistry& entities, EntityId const id) {
+    entities.emplace<gfx::Model>(id);
+  });
+
+  // the work per entity is small to measure the access to the components
+  auto const updateTransform = [](Transform const& transform,
+                                  LocalToWorld& localToWorld,
+                                  PreviousTransform& previous) {
+    localToWorld.matrix = Affine3x4f32::translation(transform.position);
+    previous.transform.reset();
+  };
+  // like collecting draw calls
+  auto positions = std::vector<Vector3f32>{};
+  positions.reserve(numEntities);
+  auto const addTranslation = [&](LocalToWorld const& localToWorld) {
+    positions.push_back(localToWorld.matrix.translation());
+  };
+
+  auto start = Clock::now();
+  for (auto i = 0; i < numIterations; ++i) {
+    viewEntities.view<Transform const, LocalToWorld, PreviousTransform>()
+      .each(updateTransform);
+  }
+  results.transformView = milliseconds_since(start) / numIterations;
+
+  start = Clock::now();
+  for (auto i = 0; i < numIterations; ++i) {
+    groupEntities.group<Transform, LocalToWorld, PreviousTransform>().each(
+      updateTransform);
+  }
+  results.transformGroup = milliseconds_since(start) / numIterations;
+
+  start = Clock::now();
+  for (auto i = 0; i < numIterations; ++i) {
+    positions.clear();
+    viewEntities.view<LocalToWorld const, gfx::Model const>().each(
+      [&](LocalToWorld const& localToWorld, gfx::Model const&) {
+        addTranslation(localToWorld);
+      });
+  }
+  results.modelView = milliseconds_since(start) / numIterations;
+
+  start = Clock::now();
+  for (auto i = 0; i < numIterations; ++i) {
+    positions.clear();
+    groupEntities.group<gfx::Model>(entt::get<LocalToWorld>)
+      .each([&](gfx::Model const&, LocalToWorld const& localToWorld) {
+        addTranslation(localToWorld);
+      });
+  }
+  results.modelGroup = milliseconds_since(start) / numIterations;
+
+  return results;
+}
+
+struct EntitySpawningResults final {
+  u32 numEntities{};
+  // create_entity and emplace against create_entities with a prefab
+  f64 createOneByOne{};
+  f64 createBulk{};
+  // destroying every entity on its own against destroy_entities
+  f64 destroyOneByOne{};
+  f64 destroyBulk{};
+  // a tenth of the entities is destroyed and created again, against
+  // releasing and acquiring them from an EntityPool
+  f64 churnCreateDestroy{};
+  f64 churnPool{};
+  EntityPool::Occupancy poolOccupancy{};
+};
+
+auto run_entity_spawning_benchmark(u32 const numEntities)
+  -> EntitySpawningResults {
+  auto results = EntitySpawningResults{};
+  results.numEntities = numEntities;
+
+  auto constexpr bounds =
+    Aabb::from_min_max(Vector3f32{-1.0f}, Vector3f32{1.0f});
+  auto const positionOf = [](u32 const i) {
+    return Vector3f32{static_cast<f32>(i % 1024),
+                      static_cast<f32>(i / 1024 % 1024),
+                      static_cast<f32>(i / (1024 * 1024))};
+  };
+
+  // the scenes contain the groups of their systems, like a real scene
+  auto oneByOne = Scene::create();
+  auto bulk = Scene::create();
+
+  auto start = Clock::now();
+  auto ids = std::vector<EntityId>{};
+  ids.reserve(numEntities);
+  for (auto i = u32{0}; i < numEntities; ++i) {
+    auto entity = oneByOne->create_entity(positionOf(i));
+    entity.emplace<gfx::Model>();
+    entity.emplace<LocalBounds>(bounds);
+    ids.push_back(entity.entity());
+  }
+  results.createOneByOne = milliseconds_since(start);
+
+  start = Clock::now();
+  auto prefab = Prefab{};
+  prefab.add(gfx::Model{}).add(LocalBounds{bounds});
+  auto const bulkIds = bulk->create_entities(numEntities, prefab);
+  parallel_for_entities<Transform>(
+    bulk->entity_registry(), bulkIds,
+    [&](u32 const i, Transform& transform) {
+      transform.position = positionOf(i);
+    });
+  results.createBulk = milliseconds_since(start);
+
+  start = Clock::now();
+  for (auto const id : ids) {
+    oneByOne->entity_registry().destroy(id);
+  }
+  results.destroyOneByOne = milliseconds_since(start);
+
+  start = Clock::now();
+  bulk->destroy_entities(bulkIds);
+  results.destroyBulk = milliseconds_since(start);
+
+  constexpr auto numRounds = 10;
+  auto const numChurned = numEntities / 10;
+
+  auto churned = std::vector<EntityId>{};
+  churned.reserve(numChurned);
+  for (auto i = u32{0}; i < numChurned; ++i) {
+    auto entity = oneByOne->create_entity(positionOf(i));
+    entity.emplace<gfx::Model>();
+    entity.emplace<LocalBounds>(bounds);
+    churned.push_back(entity.entity());
+  }
+
+  start = Clock::now();
+  for (auto round = 0; round < numRounds; ++round) {
+    for (auto i = u32{0}; i < numChurned; ++i) {
+      oneByOne->entity_registry().destroy(churned[i]);
+
+      auto entity = oneByOne->create_entity(positionOf(i));
+      entity.emplace<gfx::Model>();
+      entity.emplace<LocalBounds>(bounds);
+      churned[i] = entity.entity();
+    }
+  }
+  results.churnCreateDestroy = milliseconds_since(start) / numRounds;
+
+  auto pool = EntityPool{*bulk, prefab, numChurned};
+  for (auto& id : churned) {
+    id = pool.acquire();
+  }
+
+  start = Clock::now();
+  for (auto round = 0; round < numRounds; ++round) {
+    for (auto i = u32{0}; i < numChurned; ++i) {
+      pool.release(churned[i]);
+
+      churned[i] = pool.acquire();
+      bulk->entity_registry().get<Transform>(churned[i]).position =
+        positionOf(i);
+    }
+  }
+  results.churnPool = milliseconds_since(start) / numRounds;
+  results.poolOccupancy = pool.occupancy();
+
+  return results;
+}
+
+struct JobSystemResults final {
+  u32 numThreads{};
+  f64 parallelFor{};
+  f64 smallJobs{};
+  u32 numStressRounds{};
+  u32 numStressFailures{};
+  JobSystem::Stats stats;
+};
+
+// Runs parallel_for, a dependency graph and nested parallel_fors in child jobs
+// and checks their results. Returns the number of failed checks
+auto stress_job_system(JobSystem& jobSystem, u32 const numRounds) -> u32 {
+  constexpr auto numElements = u32{100'000};
+  constexpr auto numNestedJobs = u32{16};
+  constexpr auto numNestedElements = u32{10'000};
+
+  auto numFailures = u32{0};
+  auto values = std::vector<u32>(numElements);
+  for (auto round = u32{0}; round < numRounds; ++round) {
+    std::fill(values.begin(), values.end(), 0u);
+    jobSystem.parallel_for(numElements, 64,
+                           [&](u32 const begin, u32 const end) {
+                             for (auto i = begin; i < end; ++i) {
+                               values[i] += i;
+                             }
+                           });
+    for (auto i = u32{0}; i < numElements; ++i) {
+      if (values[i] != i) {
+        ++numFailures;
+
+        break;
+      }
+    }
+
+    // a before b and c, which both run before d
+    auto order = std::atomic<u32>{0};
+    auto a = u32{};
+    auto b = u32{};
+    auto c = u32{};
+    auto d = u32{};
+    auto& jobA = jobSystem.create_job([&] { a = order++; });
+    auto& jobB = jobSystem.create_job([&] { b = order++; });
+    auto& jobC = jobSystem.create_job([&] { c = order++; });
+    auto& jobD = jobSystem.create_job([&] { d = order++; });
+    jobSystem.add_dependency(jobB, jobA);
+    jobSystem.add_dependency(jobC, jobA);
+    jobSystem.add_dependency(jobD, jobB);
+    jobSystem.add_dependency(jobD, jobC);
+    jobSystem.run(jobD);
+    jobSystem.run(jobC);
+    jobSystem.run(jobB);
+    jobSystem.run(jobA);
+    jobSystem.wait(jobD);
+    if (a != 0 || b == 0 || c == 0 || d != 3) {
+      ++numFailures;
+    }
+
+    auto sum = std::atomic<u64>{0};
+    auto& root = jobSystem.create_job([] {});
+    for (auto i = u32{0}; i < numNestedJobs; ++i) {
+      jobSystem.run(jobSystem.create_child_job(root, [&] {
+        jobSystem.parallel_for(numNestedElements, 16,
+                               [&](u32 const begin, u32 const end) {
+                                 auto partialSum = u64{0};
+                                 for (auto j = begin; j < end; ++j) {
+                                   partialSum += j;
+                                 }
+                                 sum += partialSum;
+                               });
+      }));
+    }
+    jobSystem.run(root);
+    jobSystem.wait(root);
+    if (sum != u64{numNestedJobs} * numNestedElements *
+                 (numNestedElements - 1) / 2) {
+      ++numFailures;
+    }
+  }
+
+  return numFailures;
+}
+
+// a job system of every thread count to see how the job system scales
+auto run_job_system_benchmark() -> std::vector<JobSystemResults> {
+  constexpr auto numElements = u32{1'000'000};
+  constexpr auto numSmallJobs = u32{2000};
+  constexpr auto numRuns = 10;
+  constexpr auto numStressRounds = u32{200};
+
+  auto values = std::vector<f32>(numElements);
+  auto const work = [&](u32 const begin, u32 const end) {
+    for (auto i = begin; i < end; ++i) {
+      auto const x = static_cast<f32>(i);
+      values[i] = std::sqrt(x) * std::sin(x) + std::cos(x);
+    }
+  };
+
+  auto results = std::vector<JobSystemResults>{};
+  auto const maxThreads = std::max(std::thread::hardware_concurrency(), 1u);
+
+  for (auto numThreads = u32{1}; numThreads <= maxThreads; numThreads *= 2) {
+    auto jobSystem = JobSystem{numThreads};
+    auto& r = results.emplace_back();
+    r.numThreads = numThreads;
+
+    auto start = Clock::now();
+    for (auto run = 0; run < numRuns; ++run) {
+      jobSystem.parallel_for(numElements, 1024, work);
+    }
+    r.parallelFor = milliseconds_since(start) / numRuns;
+
+    // stresses the deques with jobs of one chunk each
+    start = Clock::now();
+    for (auto run = 0; run < numRuns; ++run) {
+      auto& root = jobSystem.create_job([] {});
+      for (auto i = u32{0}; i < numSmallJobs; ++i) {
+        jobSystem.run(jobSystem.create_child_job(root, [&work, i] {
+          work(i * 64, i * 64 + 64);
+        }));
+      }
+      jobSystem.run(root);
+      jobSystem.wait(root);
+    }
+    r.smallJobs = milliseconds_since(start) / numRuns;
+
+    r.numStressRounds = numStressRounds;
+    r.numStressFailures = stress_job_system(jobSystem, numStressRounds);
+
+    r.stats = jobSystem.stats();
+  }
+
+  return results;
+}
+
+struct CheckResults final {
+  u32 numChecks{};
+  u32 numFailures{};
+
+  auto check(bool const isPassed) -> void {
+    ++numChecks;
+    if (!isPassed) {
+      ++numFailures;
+    }
+  }
+};
+
+BASALT_DEFINE_HANDLE(CheckHandle);
+
+using CheckPool = HandlePool<u32, CheckHandle>;
+
+// destroy moves the last value into the gap
+auto check_handle_pool_destroy(CheckResults& results) -> void {
+  auto pool = CheckPool{};
+  auto const a = pool.emplace(1u);
+  auto const b = pool.emplace(2u);
+  auto const c = pool.emplace(3u);
+  pool.destroy(a);
+
+  auto const values = pool.values();
+  auto const handles = std::vector<CheckHandle>(pool.begin(), pool.end());
+  results.check(pool.size() == 2);
+  results.check(values.size() == 2 && values[0] == 3 && values[1] == 2);
+  results.check(handles == std::vector{c, b});
+  results.check(pool[b] == 2 && pool[c] == 3);
+}
+
+// Churns one value for more than a full cycle of generations. No handle may
+// repeat, and none may become valid again
+auto check_handle_pool_stale_handles(CheckResults& results) -> void {
+  constexpr auto numCycles = 300 * (CheckPool::MIN_FREE_SLOTS + 1);
+
+  auto pool = CheckPool{};
+  auto handles = std::vector<CheckHandle>{};
+  handles.reserve(numCycles);
+  for (auto i = uSize{0}; i < numCycles; ++i) {
+    auto const handle = pool.emplace(static_cast<u32>(i));
+    handles.push_back(handle);
+    pool.destroy(handle);
+  }
+  auto const live = pool.emplace(0u);
+
+  results.check(std::none_of(
+    handles.begin(), handles.end(),
+    [&](CheckHandle const handle) { return pool.is_valid(handle); }));
+  results.check(pool.is_valid(live) && pool.size() == 1);
+
+  std::sort(handles.begin(), handles.end(),
+            [](CheckHandle const l, CheckHandle const r) {
+              return l.value() < r.value();
+            });
+  results.check(std::adjacent_find(handles.begin(), handles.end()) ==
+                handles.end());
+}
+
+// Mirrors handles of a pool, whose free list was used, into another one. The
+// hinted slots are taken out of order, so the mirror's free list keeps
+// entries which it has to skip
+auto check_handle_pool_emplace_at(CheckResults& results) -> void {
+  constexpr auto count = static_cast<u32>(CheckPool::MIN_FREE_SLOTS + 16);
+
+  auto source = CheckPool{};
+  auto hints = std::vector<CheckHandle>{};
+  for (auto i = u32{0}; i < count; ++i) {
+    hints.push_back(source.emplace(i));
+  }
+  for (auto const hint : hints) {
+    source.destroy(hint);
+  }
+  hints.clear();
+  for (auto i = u32{0}; i < count; ++i) {
+    hints.push_back(source.emplace(i));
+  }
+
+  auto mirror = CheckPool{};
+  auto const last = mirror.emplace_at(hints.back(), count - 1);
+  auto const first = mirror.emplace_at(hints.front(), 0u);
+  results.check(last == hints.back() && first == hints.front());
+
+  auto handles = std::vector<CheckHandle>{};
+  for (auto i = u32{0}; i < 2 * count; ++i) {
+    handles.push_back(mirror.emplace(count + i));
+  }
+
+  results.check(mirror.size() == 2 * count + 2);
+  results.check(mirror[first] == 0 && mirror[last] == count - 1);
+  auto isIntact = true;
+  for (auto i = u32{0}; i < 2 * count; ++i) {
+    isIntact &= handles[i] != first && handles[i] != last &&
+                mirror.is_valid(handles[i]) && mirror[handles[i]] == count + i;
+  }
+  results.check(isIntact);
+}
+
+auto check_handle_pool_reserve(CheckResults& results) -> void {
+  auto pool = CheckPool{};
+  auto const reserved = pool.reserve();
+  results.check(!pool.is_valid(reserved) && pool.size() == 0);
+
+  auto const other = pool.emplace(1u);
+  results.check(other != reserved);
+
+  pool.emplace_reserved(reserved, 2u);
+  results.check(pool.is_valid(reserved) && pool[reserved] == 2 &&
+                pool[other] == 1 && pool.size() == 2);
+
+  pool.destroy(reserved);
+  results.check(!pool.is_valid(reserved) && pool.is_valid(other));
+}
+
+auto run_handle_pool_checks() -> CheckResults {
+  auto results = CheckResults{};
+  check_handle_pool_destroy(results);
+  check_handle_pool_stale_handles(results);
+  check_handle_pool_emplace_at(results);
+  check_handle_pool_reserve(results);
+
+  return results;
+}
+
+struct CheckVertex final {
+  Vector3f32 pos;
+  Vector3f32 normal;
+
+  static constexpr auto sLayout =
+    gfx::make_vertex_layout<gfx::VertexElement::Position3F32,
+                            gfx::VertexElement::Normal3F32>();
+};
+
+template <typename Handle>
+auto are_unique(std::vector<Handle> handles) -> bool {
+  std::sort(handles.begin(), handles.end(),
+            [](Handle const l, Handle const r) {
+              return l.value() < r.value();
+            });
+
+  return std::adjacent_find(handles.begin(), handles.end()) == handles.end();
+}
+
+// Queues meshes and materials from the threads of the JobSystem, the main
+// thread included, and commits them. More are queued than the handle reserve
+// of the Context holds. Mesh i has i % 8 + 3 vertices and an index per vertex
+// if i is odd. Material i has a specular power of i
+auto run_resource_cache_checks(Engine& engine) -> CheckResults {
+  constexpr auto count = 4 * gfx::Context::HANDLE_RESERVE_SIZE;
+
+  auto results = CheckResults{};
+  auto const cache = engine.create_gfx_resource_cache();
+  auto const& context = *cache->context();
+
+  auto const clazz = [&] {
+    auto info = gfx::MaterialClassCreateInfo{};
+    auto& pipelineInfo = info.pipelineInfo;
+
+    auto vs = gfx::FixedVertexShaderCreateInfo{};
+    vs.lightingEnabled = true;
+    pipelineInfo.vertexShader = &vs;
+    pipelineInfo.vertexLayout = CheckVertex::sLayout;
+
+    return cache->create_material_class(info);
+  }();
+
+  auto meshes = std::vector<gfx::MeshHandle>(count);
+  auto materials = std::vector<gfx::MaterialHandle>(count);
+  JobSystem::global().parallel_for(
+    count, 16, [&](u32 const begin, u32 const end) {
+      for (auto i = begin; i < end; ++i) {
+        auto const numVertices = i % 8 + 3;
+        auto const vertices = std::vector<CheckVertex>(numVertices);
+        auto indices = std::vector<u16>(i % 2 == 1 ? numVertices : 0);
+        std::iota(indices.begin(), indices.end(), u16{0});
+
+        auto meshInfo = gfx::MeshDataCreateInfo{};
+        meshInfo.layout = CheckVertex::sLayout;
+        meshInfo.vertexData = as_bytes(gsl::span{vertices});
+        meshInfo.vertexCount = numVertices;
+        meshInfo.indexData = as_bytes(gsl::span{indices});
+        meshInfo.indexCount = static_cast<u32>(indices.size());
+        meshes[i] = cache->queue_mesh(meshInfo);
+
+        auto colors = gfx::UniformColors{};
+        colors.specularPower = static_cast<f32>(i);
+        auto const properties = std::array{
+          gfx::MaterialProperty{gfx::MaterialPropertyId::UniformColors, colors},
+        };
+        auto materialInfo = gfx::MaterialCreateInfo{};
+        materialInfo.clazz = clazz;
+        materialInfo.initialValues = properties;
+        materials[i] = cache->queue_material(materialInfo);
+      }
+    });
+
+  results.check(are_unique(meshes) && are_unique(materials));
+  results.check(std::none_of(
+    meshes.begin(), meshes.end(),
+    [&](gfx::MeshHandle const mesh) { return context.is_valid(mesh); }));
+
+  cache->commit_queued();
+
+  auto areMeshesIntact = true;
+  auto areMaterialsIntact = true;
+  for (auto i = u32{0}; i < count; ++i) {
+    auto const isIndexed = i % 2 == 1;
+    areMeshesIntact &= context.is_valid(meshes[i]);
+    if (areMeshesIntact) {
+      auto const& mesh = context.get(meshes[i]);
+      areMeshesIntact &= mesh.vertexCount() == i % 8 + 3 &&
+                         mesh.indexCount() == (isIndexed ? i % 8 + 3 : 0) &&
+                         static_cast<bool>(mesh.indexBuffer()) == isIndexed;
+    }
+
+    areMaterialsIntact &= context.is_valid(materials[i]);
+    if (areMaterialsIntact) {
+      auto const& material = context.get(materials[i]);
+      auto const colors = material.get<gfx::UniformColors>(
+        gfx::MaterialPropertyId::UniformColors);
+      areMaterialsIntact &= material.clazz() == clazz &&
+                            colors.specularPower == static_cast<f32>(i);
+    }
+  }
+  results.check(areMeshesIntact);
+  results.check(areMaterialsIntact);
+
+  return results;
+}
+
+struct MatrixMathResults final {
+  u32 numOperations{};
+  f64 multiply{};
+  f64 multiplyReference{};
+  f64 transform{};
+  f64 transformReference{};
+  f64 transpose{};
+  f64 inverse{};
+  f64 multiplyAffine{};
+  f64 inverseAffine{};
+  f64 composeTransforms{};
+  f64 composeTransformsQuaternion{};
+  f64 composeTransformsBatch{};
+  f64 transformPoints{};
+  f64 transformPointsBatch{};
+  // results differing from the generic loops in any bit, e.g. the sign of zeros
+  u32 numMismatches{};
+  // of inverse(m) * m from the identity
+  f32 maxInverseError{};
+  f32 maxAffineInverseError{};
+};
+
+// the generic loops of detail::Matrix, which are kept for constant evaluation
+auto multiply_reference(Matrix4x4f32 const& l, Matrix4x4f32 const& r)
+  -> Matrix4x4f32 {
+  auto result = Matrix4x4f32{};
+  for (auto row = uSize{0}; row < 4; ++row) {
+    for (auto column = uSize{0}; column < 4; ++column) {
+      auto element = l[{row, 0}] * r[{0, column}];
+      for (auto i = uSize{1}; i < 4; ++i) {
+        element += l[{row, i}] * r[{i, column}];
+      }
+
+      result[{row, column}] = element;
+    }
+  }
+
+  return result;
+}
+
+auto transform_reference(Vector4f32 const& v, Matrix4x4f32 const& m)
+  -> Vector4f32 {
+  auto result = Vector4f32{};
+  for (auto column = uSize{0}; column < 4; ++column) {
+    auto element = v[0] * m[{0, column}];
+    for (auto i = uSize{1}; i < 4; ++i) {
+      element += v[i] * m[{i, column}];
+    }
+
+    result[column] = element;
+  }
+
+  return result;
+}
+
+// operator== treats -0 and +0 as equal
+template <typename T>
+auto is_bitwise_equal(T const& l, T const& r) -> bool {
+  return std::memcmp(&l, &r, sizeof(T)) == 0;
+}
+
+auto run_matrix_math_benchmark(u32 const numOperations) -> MatrixMathResults {
+  auto results = MatrixMathResults{};
+  results.numOperations = numOperations;
+
+  auto randomEngine = std::default_random_engine{42};
+  auto angle = Distribution{-180.0f, 180.0f};
+  auto offset = Distribution{-100.0f, 100.0f};
+
+  // rigid transforms are always invertible
+  auto matrices = std::vector<Matrix4x4f32>{};
+  auto vectors = std::vector<Vector4f32>{};
+  matrices.reserve(numOperations);
+  vectors.reserve(numOperations);
+  for (auto i = u32{0}; i < numOperations; ++i) {
+    auto const rotation =
+      Matrix3x3f32::rotation(Angle::degrees(angle(randomEngine)),
+                             Angle::degrees(angle(randomEngine)),
+                             Angle::degrees(angle(randomEngine)));
+    matrices.push_back(Matrix4x4f32{rotation} *
+                       Matrix4x4f32::translation(offset(randomEngine),
+                                                 offset(randomEngine),
+                                                 offset(randomEngine)));
+    vectors.emplace_back(offset(randomEngine), offset(randomEngine),
+                         offset(randomEngine), 1.0f);
+  }
+
+  // Invertible, but with sums of -0 products, e.g. the second row of the
+  // first times the first column of the second. Their sign is only kept when
+  // the sum starts with the first product, like the SSE kernels do
+  if (numOperations >= 2) {
+    // clang-format off
+    matrices[0] = Matrix4x4f32{-0.0f,  0.0f, -1.0f, 0.0f,
+                               -1.0f, -0.0f,  0.0f, 0.0f,
+                                0.0f,  2.0f, -0.0f, 0.0f,
+                                3.0f, -0.0f,  0.5f, 1.0f};
+    matrices[1] = Matrix4x4f32{ 0.0f, 1.0f, 0.0f, 0.0f,
+                                0.0f, 0.0f, 1.0f, 0.0f,
+                               -1.0f, 0.0f, 0.0f, 0.0f,
+                               -0.0f, 0.0f, 0.0f, 1.0f};
+    // clang-format on
+    vectors[0] = Vector4f32{-0.0f, -0.0f, -0.0f, -0.0f};
+    vectors[1] = Vector4f32{-1.0f, -0.0f, 0.0f, 0.0f};
+  }
+
+  auto products = std::vector<Matrix4x4f32>(numOperations);
+  auto referenceProducts = std::vector<Matrix4x4f32>(numOperations);
+  auto transformed = std::vector<Vector4f32>(numOperations);
+  auto referenceTransformed = std::vector<Vector4f32>(numOperations);
+
+  auto start = Clock::now();
+  for (auto i = u32{1}; i < numOperations; ++i) {
+    products[i] = matrices[i - 1] * matrices[i];
+  }
+  results.multiply = milliseconds_since(start);
+
+  start = Clock::now();
+  for (auto i = u32{1}; i < numOperations; ++i) {
+    referenceProducts[i] = multiply_reference(matrices[i - 1], matrices[i]);
+  }
+  results.multiplyReference = milliseconds_since(start);
+
+  start = Clock::now();
+  for (auto i = u32{0}; i < numOperations; ++i) {
+    transformed[i] = vectors[i] * matrices[i];
+  }
+  results.transform = milliseconds_since(start);
+
+  start = Clock::now();
+  for (auto i = u32{0}; i < numOperations; ++i) {
+    referenceTransformed[i] = transform_reference(vectors[i], matrices[i]);
+  }
+  results.transformReference = milliseconds_since(start);
+
+  for (auto i = u32{0}; i < numOperations; ++i) {
+    results.numMismatches +=
+      is_bitwise_equal(products[i], referenceProducts[i]) ? 0 : 1;
+    results.numMismatches +=
+      is_bitwise_equal(transformed[i], referenceTransformed[i]) ? 0 : 1;
+  }
+
+  start = Clock::now();
+  for (auto i = u32{0}; i < numOperations; ++i) {
+    products[i] = Matrix4x4f32::transposed(matrices[i]);
+  }
+  results.transpose = milliseconds_since(start);
+
+  start = Clock::now();
+  for (auto i = u32{0}; i < numOperations; ++i) {
+    products[i] = Matrix4x4f32::inverse(matrices[i]);
+  }
+  results.inverse = milliseconds_since(start);
+
+  for (auto i = u32{0}; i < numOperations; ++i) {
+    auto const identity = products[i] * matrices[i];
+    for (auto row = uSize{0}; row < 4; ++row) {
+      for (auto column = uSize{0}; column < 4; ++column) {
+        auto const expected = row == column ? 1.0f : 0.0f;
+        results.maxInverseError =
+          std::max(results.maxInverseError,
+                   std::abs(identity[{row, column}] - expected));
+      }
+    }
+  }
+
+  // the same matrices without the last column
+  auto affines = std::vector<Affine3x4f32>{};
+  affines.reserve(numOperations);
+  for (auto const& m : matrices) {
+    affines.push_back(Affine3x4f32::from_matrix(m));
+  }
+  auto affineProducts = std::vector<Affine3x4f32>(numOperations);
+
+  start = Clock::now();
+  for (auto i = u32{1}; i < numOperations; ++i) {
+    affineProducts[i] = affines[i - 1] * affines[i];
+  }
+  results.multiplyAffine = milliseconds_since(start);
+
+  start = Clock::now();
+  for (auto i = u32{0}; i < numOperations; ++i) {
+    affineProducts[i] = Affine3x4f32::inverse(affines[i]);
+  }
+  results.inverseAffine = milliseconds_since(start);
+
+  for (auto i = u32{0}; i < numOperations; ++i) {
+    auto const identity = (affineProducts[i] * affines[i]).to_matrix();
+    for (auto row = uSize{0}; row < 4; ++row) {
+      for (auto column = uSize{0}; column < 4; ++column) {
+        auto const expected = row == column ? 1.0f : 0.0f;
+        results.maxAffineInverseError =
+          std::max(results.maxAffineInverseError,
+                   std::abs(identity[{row, column}] - expected));
+      }
+    }
+  }
+
+  // the same transforms as components and as structure of arrays
+  auto transforms = std::vector<Transform>{};
+  transforms.reserve(numOperations);
+  auto soa = std::array<std::vector<f32>, 9>{};
+  for (auto& values : soa) {
+    values.reserve(numOperations);
+  }
+  for (auto i = u32{0}; i < numOperations; ++i) {
+    auto const& transform = transforms.emplace_back(Transform{
+      Vector3f32{offset(randomEngine), offset(randomEngine),
+                 offset(randomEngine)},
+      Vector3f32{Angle::degrees(angle(randomEngine)).radians(),
+                 Angle::degrees(angle(randomEngine)).radians(),
+                 Angle::degrees(angle(randomEngine)).radians()},
+      Vector3f32{1.0f}});
+
+    for (auto j = uSize{0}; j < 3; ++j) {
+      soa[j].push_back(transform.position[j]);
+      soa[3 + j].push_back(transform.rotation[j]);
+      soa[6 + j].push_back(transform.scale[j]);
+    }
+  }
+
+  start = Clock::now();
+  for (auto i = u32{0}; i < numOperations; ++i) {
+    products[i] = transforms[i].to_matrix();
+  }
+  results.composeTransforms = milliseconds_since(start);
+
+  for (auto& transform : transforms) {
+    transform.set_orientation(transform.rotation_quaternion());
+  }
+
+  start = Clock::now();
+  for (auto i = u32{0}; i < numOperations; ++i) {
+    products[i] = transforms[i].to_matrix();
+  }
+  results.composeTransformsQuaternion = milliseconds_since(start);
+
+  start = Clock::now();
+  batch::compose_transforms(
+    batch::ConstVectors3f32{soa[0], soa[1], soa[2]},
+    batch::ConstVectors3f32{soa[3], soa[4], soa[5]},
+    batch::ConstVectors3f32{soa[6], soa[7], soa[8]}, products);
+  results.composeTransformsBatch = milliseconds_since(start);
+
+  start = Clock::now();
+  for (auto i = u32{0}; i < numOperations; ++i) {
+    transformed[i] = vectors[i] * matrices[0];
+  }
+  results.transformPoints = milliseconds_since(start);
+
+  // transforms the positions in place
+  start = Clock::now();
+  batch::transform_points(batch::ConstVectors3f32{soa[0], soa[1], soa[2]},
+                          matrices[0],
+                          batch::Vectors3f32{soa[0], soa[1], soa[2]});
+  results.transformPointsBatch = milliseconds_since(start);
+
+  return results;
+}
+
+class CpuView final : public View {
+public:
+  CpuView() noexcept = default;
+
+private:
+  std::optional<AabbTreeResults> mAabbTreeResults;
+  std::optional<SpatialHashGridResults> mSpatialHashGridResults;
+  std::optional<TransformHierarchyResults> mTransformHierarchyResults;
+  std::optional<ComponentIterationResults> mComponentIterationResults;
+  std::optional<EntitySpawningResults> mEntitySpawningResults;
+  std::vector<JobSystemResults> mJobSystemResults;
+  std::optional<CheckResults> mHandlePoolResults;
+  std::optional<CheckResults> mResourceCacheResults;
+  std::optional<MatrixMathResults> mMatrixMathResults;
+
+  auto on_update(UpdateContext& ctx) -> void override {
+    auto constexpr background = Color::from_non_linear_rgba8(32, 32, 32);
+
+    auto cmdList = gfx::CommandList{};
+    cmdList.clear_attachments(gfx::Attachments{gfx::Attachment::RenderTarget},
+                              background);
+    ctx.drawCtx.commandLists.push_back(std::move(cmdList));
+
+    if (ImGui::Begin("CPU Benchmarks")) {
+      aabb_tree_ui();
+      spatial_hash_grid_ui();
+      transform_hierarchy_ui();
+      component_iteration_ui();
+      entity_spawning_ui();
+      job_system_ui();
+      handle_pool_ui();
+      resource_cache_ui(ctx.engine);
+      matrix_math_ui();
+    }
+    ImGui::End();
+  }
+
+  auto aabb_tree_ui() -> void {
+    ImGui::SeparatorText("AABB Tree");
+
+    if (ImGui::Button("100k entities##AabbTree")) {
+      mAabbTreeResults = run_aabb_tree_benchmark(100'000);
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("1M entities##AabbTree")) {
+      mAabbTreeResults = run_aabb_tree_benchmark(1'000'000);
+    }
+
+    if (!mAabbTreeResults) {
+      return;
+    }
+
+    auto const& r = *mAabbTreeResults;
+    ImGui::Text("%u entities, height %u", r.numEntities, r.height);
+    ImGui::Text("build: %.3f ms", r.build);
+    ImGui::Text("refit: %.3f ms (%u reinserted)", r.refit, r.numReinserted);
+    ImGui::Text("%u box queries: %.3f ms", NUM_QUERIES, r.boxQueries);
+    ImGui::Text("%u box queries (batch): %.3f ms", NUM_QUERIES,
+                r.batchBoxQueries);
+    ImGui::Text("%u sphere queries: %.3f ms", NUM_QUERIES, r.sphereQueries);
+    ImGui::Text("%u raycasts: %.3f ms", NUM_QUERIES, r.raycasts);
+    ImGui::Text("frustum query: %.3f ms", r.frustumQuery);
+    ImGui::Text("hits: %llu", static_cast<unsigned long long>(r.numHits));
+  }
+
+  auto spatial_hash_grid_ui() -> void {
+    ImGui::SeparatorText("Spatial Hash Grid");
+
+    if (ImGui::Button("100k entities##SpatialHashGrid")) {
+      mSpatialHashGridResults = run_spatial_hash_grid_benchmark(100'000);
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("1M entities##SpatialHashGrid")) {
+      mSpatialHashGridResults = run_spatial_hash_grid_benchmark(1'000'000);
+    }
+
+    if (!mSpatialHashGridResults) {
+      return;
+    }
+
+    auto const& r = *mSpatialHashGridResults;
+    ImGui::Text("%u entities", r.numEntities);
+    ImGui::Text("build: %.3f ms", r.build);
+    ImGui::Text("%u radius queries: %.3f ms", NUM_QUERIES, r.radiusQueries);
+    ImGui::Text("%u 8-nearest queries: %.3f ms", NUM_QUERIES,
+                r.nearestQueries);
+    ImGui::Text("hits: %llu", static_cast<unsigned long long>(r.numHits));
+  }
+
+  auto transform_hierarchy_ui() -> void {
+    ImGui::SeparatorText("Transform Hierarchy");
+
+    if (ImGui::Button("100k entities, 10 levels")) {
+      mTransformHierarchyResults =
+        run_transform_hierarchy_benchmark(100'000, 10);
+    }
+
+    if (!mTransformHierarchyResults) {
+      return;
+    }
+
+    auto const& r = *mTransformHierarchyResults;
+    ImGui::Text("%u entities, %u levels", r.numEntities, r.numLevels);
+    ImGui::Text("linking + first update: %.3f ms", r.firstUpdate);
+    ImGui::Text("update without changes: %.3f ms", r.staticUpdate);
+    ImGui::Text("update with all moving: %.3f ms", r.movingUpdate);
+    ImGui::Text("recursive update: %.3f ms", r.recursiveUpdate);
+  }
+
+  auto component_iteration_ui() -> void {
+    ImGui::SeparatorText("Component Iteration");
+
+    if (ImGui::Button("10k entities##ComponentIteration")) {
+      mComponentIterationResults = run_component_iteration_benchmark(10'000);
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("100k entities##ComponentIteration")) {
+      mComponentIterationResults = run_component_iteration_benchmark(100'000);
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("1M entities##ComponentIteration")) {
+      mComponentIterationResults =
+        run_component_iteration_benchmark(1'000'000);
+    }
+
+    if (!mComponentIterationResults) {
+      return;
+    }
+
+    auto const& r = *mComponentIterationResults;
+    ImGui::Text("%u entities", r.numEntities);
+    ImGui::Text("transforms: view %.3f ms, group %.3f ms", r.transformView,
+                r.transformGroup);
+    ImGui::Text("models: view %.3f ms, group %.3f ms", r.modelView,
+                r.modelGroup);
+  }
+
+  auto entity_spawning_ui() -> void {
+    ImGui::SeparatorText("Entity Spawning");
+
+    if (ImGui::Button("100k entities##EntitySpawning")) {
+      mEntitySpawningResults = run_entity_spawning_benchmark(100'000);
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("1M entities##EntitySpawning")) {
+      mEntitySpawningResults = run_entity_spawning_benchmark(1'000'000);
+    }
+
+    if (!mEntitySpawningResults) {
+      return;
+    }
+
+    auto const& r = *mEntitySpawningResults;
+    ImGui::Text("%u entities", r.numEntities);
+    ImGui::Text("create: one by one %.3f ms, bulk %.3f ms", r.createOneByOne,
+                r.createBulk);
+    ImGui::Text("destroy: one by one %.3f ms, bulk %.3f ms",
+                r.destroyOneByOne, r.destroyBulk);
+    ImGui::Text("churn of %u: create/destroy %.3f ms, pool %.3f ms",
+                r.numEntities / 10, r.churnCreateDestroy, r.churnPool);
+    ImGui::Text("pool: %u active, %u inactive, peak %u",
+                r.poolOccupancy.numActive, r.poolOccupancy.numInactive,
+                r.poolOccupancy.peakActive);
+  }
+
+  auto job_system_ui() -> void {
+    ImGui::SeparatorText("Job System");
+
+    if (ImGui::Button("Scaling")) {
+      mJobSystemResults = run_job_system_benchmark();
+    }
+
+    for (auto const& r : mJobSystemResults) {
+      ImGui::Text("%u threads: parallel_for %.3f ms, 2000 small jobs %.3f ms",
+                  r.numThreads, r.parallelFor, r.smallJobs);
+      ImGui::Text("  jobs %llu, steals %llu, failed %llu, contended %llu, "
+                  "sleeps %llu",
+                  static_cast<unsigned long long>(r.stats.numJobs),
+                  static_cast<unsigned long long>(r.stats.numSteals),
+                  static_cast<unsigned long long>(r.stats.numFailedSteals),
+                  static_cast<unsigned long long>(r.stats.numContendedSteals),
+                  static_cast<unsigned long long>(r.stats.numSleeps));
+      ImGui::Text("  stress: %u failed checks in %u rounds",
+                  r.numStressFailures, r.numStressRounds);
+    }
+  }
+
+  auto handle_pool_ui() -> void {
+    ImGui::SeparatorText("Handle Pool");
+
+    if (ImGui::Button("Checks##HandlePool")) {
+      mHandlePoolResults = run_handle_pool_checks();
+    }
+
+    if (!mHandlePoolResults) {
+      return;
+    }
+
+    auto const& r = *mHandlePoolResults;
+    ImGui::Text("%u of %u checks failed", r.numFailures, r.numChecks);
+  }
+
+  auto resource_cache_ui(Engine& engine) -> void {
+    ImGui::SeparatorText("Resource Cache");
+
+    if (ImGui::Button("Checks##ResourceCache")) {
+      mResourceCacheResults = run_resource_cache_checks(engine);
+    }
+
+    if (!mResourceCacheResults) {
+      return;
+    }
+
+    auto const& r = *mResourceCacheResults;
+    ImGui::Text("%u of %u checks failed", r.numFailures, r.numChecks);
+  }
+
+  auto matrix_math_ui() -> void {
+    ImGui::SeparatorText("Matrix Math");
+
+    if (ImGui::Button("1M operations")) {
+      mMatrixMathResults = run_matrix_math_benchmark(1'000'000);
+    }
+
+    if (!mMatrixMathResults) {
+      return;
+    }
+
+    auto const& r = *mMatrixMathResults;
+    ImGui::Text("%u operations each", r.numOperations);
+    ImGui::Text("multiply: %.3f ms (generic: %.3f ms)", r.multiply,
+                r.multiplyReference);
+    ImGui::Text("transform: %.3f ms (generic: %.3f ms)", r.transform,
+                r.transformReference);
+    ImGui::Text("transpose: %.3f ms", r.transpose);
+    ImGui::Text("inverse: %.3f ms (max error %g)", r.inverse,
+                static_cast<f64>(r.maxInverseError));
+    ImGui::Text("affine multiply: %.3f ms, inverse: %.3f ms (max error %g)",
+                r.multiplyAffine, r.inverseAffine,
+                static_cast<f64>(r.maxAffineInverseError));
+    ImGui::Text("compose transforms: %.3f ms (quaternion: %.3f ms, batch: "
+                "%.3f ms)",
+                r.composeTransforms, r.composeTransformsQuaternion,
+                r.composeTransformsBatch);
+    ImGui::Text("transform points: %.3f ms (batch: %.3f ms)",
+                r.transformPoints, r.transformPointsBatch);
+    ImGui::Text("results differing from generic: %u", r.numMismatches);
+  }
+};
+
+} // namespace
+
+auto Benchmarks::make_cpu_view(Engine&) -> ViewPtr {
+  return std::make_shared<CpuView>();
+}
@@ -8,6 +8,7 @@
 
 #include <basalt/api/gfx/camera.h>
 #include <basalt/api/gfx/environment.h>
+#include <basalt/api/gfx/gfx_system.h>
 #include <basalt/api/gfx/material.h>
 #include <basalt/api/gfx/material_class.h>
 #include <basalt/api/gfx/mesh.h>
@@ -15,20 +16,26 @@
 #include <basalt/api/gfx/backend/buffer.h>
 #include <basalt/api/gfx/backend/vertex_layout.h>
 
+#include <basalt/api/scene/bounds.h>
+#include <basalt/api/scene/parallel.h>
+#include <basalt/api/scene/prefab.h>
 #include <basalt/api/scene/scene.h>
+#include <basalt/api/scene/spatial_hash_grid.h>
+#include <basalt/api/scene/spatial_hash_grid_system.h>
 #include <basalt/api/scene/system.h>
 #include <basalt/api/scene/transform.h>
 
+#include <basalt/api/math/aabb.h>
 #include <basalt/api/math/angle.h>
 #include <basalt/api/math/vector2.h>
 #include <basalt/api/math/vector3.h>
 
-#include <fmt/format.h>
 #include <gsl/span>
 #include <imgui.h>
 
 #include <algorithm>
 #include <array>
+#include <cmath>
 #include <random>
 #include <utility>
 #include <vector>
@@ -40,6 +47,46 @@ namespace {
 
 using Distribution = std::uniform_real_distribution<float>;
 
+// SplitMix64: a cheap engine with an 8 byte state. Seeding it with a hash of
+// (seed, index) yields uncorrelated streams for consecutive indices
+class SplitMix64 final {
+public:
+  using result_type = u64;
+
+  SplitMix64(u64 const seed, u64 const index)
+    : mState{mix(seed ^ mix(index + GOLDEN_GAMMA))} {
+  }
+
+  [[nodiscard]]
+  static constexpr auto min() -> result_type {
+    return 0;
+  }
+
+  [[nodiscard]]
+  static constexpr auto max() -> result_type {
+    return ~result_type{0};
+  }
+
+  auto operator()() -> result_type {
+    mState += GOLDEN_GAMMA;
+
+    return mix(mState);
+  }
+
+private:
+  static constexpr auto GOLDEN_GAMMA = u64{0x9e3779b97f4a7c15};
+
+  u64 mState;
+
+  [[nodiscard]]
+  static constexpr auto mix(u64 z) -> u64 {
+    z = (z ^ (z >> 30)) * u64{0xbf58476d1ce4e5b9};
+    z = (z ^ (z >> 27)) * u64{0x94d049bb133111eb};
+
+    return z ^ (z >> 31);
+  }
+};
+
 struct Vertex {
   Vector3f32 pos;
   ColorEncoding::A8R8G8B8 diffuse{};
@@ -57,6 +104,11 @@ auto constexpr INITIAL_NUM_CUBES = u32{2048};
 auto constexpr NUM_TRIANGLES_PER_CUBE = u32{2 * 6};
 auto constexpr NUM_VERTICES_PER_CUBE = u32{8};
 auto constexpr NUM_INDICES_PER_CUBE = u32{NUM_TRIANGLES_PER_CUBE * 3};
+auto constexpr CUBE_BOUNDS =
+  Aabb::from_min_max(Vector3f32{-1.0f}, Vector3f32{1.0f});
+// radius of the bounding sphere
+auto constexpr CUBE_RADIUS = 1.7320508f;
+auto constexpr NEIGHBOR_RADIUS = 20.0f;
 
 auto generate_mesh(gsl::span<Vertex> const vb, gsl::span<u16> const ib)
   -> void {
@@ -99,12 +151,14 @@ struct VelocityComponent {
 
 class VelocitySystem final : public System {
 public:
+  using Writes = entt::type_list<VelocityComponent, Transform>;
+
   auto on_update(UpdateContext const& ctx) -> void override {
     auto const dt = ctx.deltaTime.count();
 
     auto const view =
       ctx.scene.entity_registry().view<VelocityComponent, Transform>();
-    view.each([&](VelocityComponent& velocity, Transform& transform) {
+    parallel_each(view, [&](VelocityComponent& velocity, Transform& transform) {
       transform.position += velocity.value * dt;
 
       if (transform.position.length() > 250.0f) {
@@ -138,32 +192,39 @@ private:
   EntityId mCameraEntityId;
   Angle mCameraAngleY{0_deg};
   bool mDoCubesFollowCamera{false};
+  std::vector<SpatialHashGrid::Neighbor> mNearestCubes;
 
   auto regenerate_cubes() -> void {
-    mScene->entity_registry().destroy(mCubeIds.cbegin(), mCubeIds.cend());
-    mCubeIds.clear();
-
-    auto randomEngine = std::default_random_engine{std::random_device{}()};
-    auto rng1 = Distribution{-1.0f, 1.0f};
-    auto rng2 = Distribution{20.0f, 250.f};
-    auto rng3 = Distribution{0.1f, 5.0f};
-
-    auto const normalizedRandomVector = [&] {
-      return Vector3f32::normalized(rng1(randomEngine), rng1(randomEngine),
-                                    rng1(randomEngine));
-    };
-
-    mCubeIds.reserve(mNumCubes);
-    for (auto i = u32{0}; i < mNumCubes; ++i) {
-      auto const cubePos = normalizedRandomVector() * rng2(randomEngine);
-      auto cube = mScene->create_entity(
-        fmt::format(FMT_STRING("Cube {}"), i + 1), cubePos);
-      cube.emplace<VelocityComponent>(normalizedRandomVector() *
-                                      rng3(randomEngine));
-      cube.emplace<gfx::Model>(mMeshHdl, mMaterialHdl);
-
-      mCubeIds.push_back(cube.entity());
-    }
+    mScene->destroy_entities(mCubeIds);
+
+    auto prefab = Prefab{};
+    prefab.add(VelocityComponent{})
+      .add(gfx::Model{mMeshHdl, mMaterialHdl})
+      .add(LocalBounds{CUBE_BOUNDS})
+      // the cubes are solid and occlude each other
+      .add(gfx::Occluder{CUBE_BOUNDS})
+      .add(SpatialHashed{CUBE_RADIUS});
+    mCubeIds = mScene->create_entities(mNumCubes, prefab, "Cube"sv);
+
+    // one engine per cube makes the cubes independent of the order in which
+    // the jobs run
+    auto const seed = u64{std::random_device{}()};
+    parallel_for_entities<Transform, VelocityComponent>(
+      mScene->entity_registry(), mCubeIds,
+      [&](u32 const i, Transform& transform, VelocityComponent& velocity) {
+        auto randomEngine = SplitMix64{seed, i};
+        auto rng1 = Distribution{-1.0f, 1.0f};
+        auto rng2 = Distribution{20.0f, 250.f};
+        auto rng3 = Distribution{0.1f, 5.0f};
+
+        auto const normalizedRandomVector = [&] {
+          return Vector3f32::normalized(
+            rng1(randomEngine), rng1(randomEngine), rng1(randomEngine));
+        };
+
+        transform.position = normalizedRandomVector() * rng2(randomEngine);
+        velocity.value = normalizedRandomVector() * rng3(randomEngine);
+      });
   }
 
   auto regenerate_velocities() -> void {
@@ -217,6 +278,47 @@ private:
           regenerate_velocities();
         }
       }
+
+      auto& occlusionCulling =
+        mScene->entity_registry().ctx().get<gfx::OcclusionCulling>();
+      {
+        ImGui::SeparatorText("Occlusion Culling");
+
+        ImGui::Checkbox("Enabled", &occlusionCulling.enabled);
+
+        auto const& stats = occlusionCulling.stats;
+        ImGui::Text("Occluders: %u", stats.numOccluders);
+        ImGui::Text("Tested: %u", stats.numTested);
+        ImGui::Text("Occluded: %u", stats.numOccluded);
+        ImGui::Text("Outside of frustum: %u", stats.numOutside);
+        ImGui::Text("Rasterization: %.3f ms",
+                    stats.rasterizationTime.count() * 1000.0f);
+        ImGui::Text("Testing: %.3f ms", stats.testTime.count() * 1000.0f);
+      }
+
+      if (auto const* grid =
+            mScene->entity_registry().ctx().find<SpatialHashGrid const>()) {
+        ImGui::SeparatorText("Neighbors");
+
+        auto const cameraPos =
+          gfx::CameraEntity{mScene->get_handle(mCameraEntityId)}
+            .get_transform()
+            .position;
+
+        auto numNeighbors = u32{0};
+        grid->query_radius(cameraPos, NEIGHBOR_RADIUS,
+                           [&](SpatialHashGrid::Entry const&) {
+                             numNeighbors++;
+                           });
+        ImGui::Text("Cubes within %.0f units: %u", NEIGHBOR_RADIUS,
+                    numNeighbors);
+
+        grid->query_nearest(cameraPos, 1, mNearestCubes);
+        if (!mNearestCubes.empty()) {
+          ImGui::Text("Nearest cube: %.2f units",
+                      std::sqrt(mNearestCubes.front().distanceSquared));
+        }
+      }
     }
     ImGui::End();
 
@@ -363,8 +465,10 @@ auto Benchmarks::make_cubes_view(Engine& engine) -> ViewPtr {
 
   auto scene = Scene::create();
   auto const velocitySystemId = scene->create_system<VelocitySystem>();
+  scene->create_system<SpatialHashGridSystem>(4.0f);
   auto& gfxEnv = scene->entity_registry().ctx().emplace<gfx::Environment>();
   gfxEnv.set_background(Colors::BLACK);
+  scene->entity_registry().ctx().emplace<gfx::OcclusionCulling>();
 
   auto camera = scene->create_entity("Camera"s);
   camera.emplace<gfx::Camera>(Vector3f32::forward(), Vector3f32::up(), 90_deg,
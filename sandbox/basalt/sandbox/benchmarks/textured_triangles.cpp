@@ -16,6 +16,7 @@
 #include <basalt/api/gfx/backend/buffer.h>
 #include <basalt/api/gfx/backend/vertex_layout.h>
 
+#include <basalt/api/scene/parallel.h>
 #include <basalt/api/scene/scene.h>
 #include <basalt/api/scene/system.h>
 #include <basalt/api/scene/transform.h>
@@ -26,7 +27,6 @@
 
 #include <basalt/api/base/asserts.h>
 
-#include <fmt/format.h>
 #include <gsl/span>
 #include <imgui.h>
 
@@ -64,13 +64,15 @@ struct TriangleMovement {
 };
 
 class TriangleMovementSystem : public System {
+public:
   using UpdateBefore = TransformSystem;
+  using Writes = entt::type_list<Transform, TriangleMovement>;
 
-public:
   auto on_update(UpdateContext const& ctx) -> void override {
     auto const dt = ctx.deltaTime.count();
     auto& entities = ctx.scene.entity_registry();
-    entities.view<Transform, TriangleMovement>().each(
+    parallel_each(
+      entities.view<Transform, TriangleMovement>(),
       [&](Transform& transform, TriangleMovement& triangleMovement) {
         transform.position += triangleMovement.velocity * dt;
         transform.rotation += triangleMovement.rotationVelocity * dt;
@@ -122,10 +124,9 @@ private:
 
     auto& material = gfxCtx.get(mMaterial);
     auto constexpr propertyId = gfx::MaterialPropertyId::SampledTexture;
-    auto sampledTexture =
-      std::get<gfx::SampledTexture>(*material.get_value(propertyId));
+    auto sampledTexture = material.get<gfx::SampledTexture>(propertyId);
     sampledTexture.sampler = mSampler;
-    material.set_value(propertyId, sampledTexture);
+    material.set(propertyId, sampledTexture);
   }
 
   auto update_triangles() -> void {
@@ -186,8 +187,8 @@ private:
     for (auto i = u32{0}; i < mNumTriangles; ++i) {
       auto const scale = scaleRng(randomEngine);
       auto const triangle =
-        mScene->create_entity(fmt::format(FMT_STRING("Triangle {}"), i + 1),
-                              position, rotation, Vector3f32{scale});
+        mScene->create_entity(position, rotation, Vector3f32{scale});
+      mScene->set_entity_name(triangle.entity(), "Triangle"sv, i + 1);
 
       auto const velocity = rng3(randomEngine) * getRandomNormalizedVector();
       auto const rotationVelocity = Vector3f32{
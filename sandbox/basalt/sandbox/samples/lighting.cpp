@@ -50,6 +50,8 @@ struct Bobbing {
 class BobbingSystem final : public System {
 public:
   using UpdateBefore = TransformSystem;
+  using Reads = entt::type_list<Bobbing>;
+  using Writes = entt::type_list<Transform>;
 
   auto on_update(UpdateContext const& ctx) -> void override {
     auto& ecs = ctx.scene.entity_registry();
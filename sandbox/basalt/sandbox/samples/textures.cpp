@@ -91,10 +91,9 @@ private:
 
     auto& material = gfxCtx.get(mMaterial);
     auto constexpr propertyId = gfx::MaterialPropertyId::SampledTexture;
-    auto sampledTexture =
-      std::get<gfx::SampledTexture>(*material.get_value(propertyId));
+    auto sampledTexture = material.get<gfx::SampledTexture>(propertyId);
     sampledTexture.sampler = mSampler;
-    material.set_value(propertyId, sampledTexture);
+    material.set(propertyId, sampledTexture);
   }
 
   auto on_update(UpdateContext& ctx) -> void override {
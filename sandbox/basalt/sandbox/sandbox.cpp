@@ -102,6 +102,10 @@ SandboxView::SandboxView(Engine& engine, Settings settings)
     "Benchmark: Cubes"s,
     &Benchmarks::make_cubes_view,
   });
+  mExamples.push_back(Example{
+    "Benchmark: CPU"s,
+    &Benchmarks::make_cpu_view,
+  });
 
   set_scene(mCurrentExampleIndex, engine);
 }
@@ -10,11 +10,13 @@
 #include <basalt/api/scene/transform.h>
 
 #include <basalt/api/math/angle.h>
+#include <basalt/api/math/quaternion.h>
 
 #include <basalt/api/base/functional.h>
 
 #include <imgui.h>
 
+#include <array>
 #include <variant>
 
 using namespace basalt;
@@ -22,13 +24,26 @@ using namespace basalt;
 auto ComponentUi::transform(Transform& transform) -> void {
   ImGui::DragFloat3("Position", transform.position.data(), 0.1f);
 
-  ImGui::DragFloat3("Rotation", transform.rotation.data(), 0.01f, -PI, PI);
+  if (transform.rotationMode == Transform::RotationMode::Quaternion) {
+    auto const& q = transform.orientation;
+    auto components = std::array{q.x(), q.y(), q.z(), q.w()};
+    if (ImGui::DragFloat4("Orientation", components.data(), 0.01f, -1.0f,
+                          1.0f)) {
+      auto const edited =
+        Quaternion{components[0], components[1], components[2], components[3]};
+      if (edited.length() > 0.0f) {
+        transform.orientation = Quaternion::normalized(edited);
+      }
+    }
+  } else {
+    ImGui::DragFloat3("Rotation", transform.rotation.data(), 0.01f, -PI, PI);
+  }
 
   ImGui::DragFloat3("Scale", transform.scale.data(), 0.1f);
 }
 
 auto ComponentUi::local_to_world(LocalToWorld const& localToWorld) -> void {
-  DebugUi::display_matrix4x4("##value", localToWorld.matrix);
+  DebugUi::display_matrix4x4("##value", localToWorld.matrix.to_matrix());
 }
 
 auto ComponentUi::camera(gfx::Camera& camera) -> void {
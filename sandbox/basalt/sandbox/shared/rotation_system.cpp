@@ -1,5 +1,7 @@
 #include "rotation_system.h"
 
+#include <basalt/api/scene/ecs.h>
+#include <basalt/api/scene/parallel.h>
 #include <basalt/api/scene/scene.h>
 #include <basalt/api/scene/transform.h>
 
@@ -10,7 +12,8 @@ using namespace basalt;
 auto RotationSystem::on_update(UpdateContext const& ctx) -> void {
   auto const dt = ctx.deltaTime.count();
 
-  ctx.scene.entity_registry().view<Transform, RotationSpeed const>().each(
+  parallel_each(
+    ctx.scene.entity_registry().view<Transform, RotationSpeed const>(),
     [&](Transform& t, RotationSpeed const& rotationSpeed) {
       t.rotate(Angle::radians(rotationSpeed.xRadPerSecond * dt),
                Angle::radians(rotationSpeed.yRadPerSecond * dt),
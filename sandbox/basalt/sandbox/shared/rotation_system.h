@@ -1,6 +1,7 @@
 #pragma once
 
 #include <basalt/api/scene/system.h>
+#include <basalt/api/scene/transform.h>
 #include <basalt/api/scene/types.h>
 
 #include <basalt/api/base/types.h>
@@ -14,6 +15,8 @@ struct RotationSpeed {
 class RotationSystem final : public basalt::System {
 public:
   using UpdateBefore = basalt::TransformSystem;
+  using Reads = entt::type_list<RotationSpeed>;
+  using Writes = entt::type_list<basalt::Transform>;
 
   auto on_update(UpdateContext const& ctx) -> void override;
 };
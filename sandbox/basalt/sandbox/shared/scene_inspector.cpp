@@ -2,7 +2,9 @@
 
 #include <basalt/api/debug_ui.h>
 
+#include <basalt/api/scene/command_buffer.h>
 #include <basalt/api/scene/ecs.h>
+#include <basalt/api/scene/name_table.h>
 #include <basalt/api/scene/scene.h>
 #include <basalt/api/scene/transform.h>
 
@@ -35,7 +37,7 @@ auto SceneInspector::show_window(Scene& scene, bool& open) -> void {
   if (ImGui::BeginChild(
         "entities", ImVec2{0.33f * ImGui::GetContentRegionAvail().x, 0},
         ImGuiChildFlags_Borders | ImGuiChildFlags_ResizeX, windowFlags)) {
-    entity_hierarchy(entities);
+    entity_hierarchy(entities, scene.names());
   }
   ImGui::EndChild();
 
@@ -49,22 +51,25 @@ auto SceneInspector::show_window(Scene& scene, bool& open) -> void {
   ImGui::End();
 }
 
-auto SceneInspector::entity_hierarchy(EntityRegistry& entities) -> void {
-  auto const rootEntities = entities.view<EntityId>(entt::exclude<Parent>);
+auto SceneInspector::entity_hierarchy(EntityRegistry& entities,
+                                      NameTable const& names) -> void {
+  auto const rootEntities =
+    entities.view<EntityId>(entt::exclude<Parent, ReservedEntity>);
 
   for (auto const id : rootEntities) {
-    entity_node(Entity{entities, id});
+    entity_node(Entity{entities, id}, names);
   }
 }
 
-auto SceneInspector::entity_node(Entity entity) -> void {
+auto SceneInspector::entity_node(Entity entity, NameTable const& names)
+  -> void {
   constexpr auto baseFlags =
     ImGuiTreeNodeFlags_OpenOnDoubleClick | ImGuiTreeNodeFlags_OpenOnArrow |
     ImGuiTreeNodeFlags_SpanAvailWidth | ImGuiTreeNodeFlags_NavLeftJumpsToParent;
   constexpr auto leafFlags =
     baseFlags | ImGuiTreeNodeFlags_Leaf | ImGuiTreeNodeFlags_NoTreePushOnOpen;
 
-  auto const* children = entity.try_get<Children>();
+  auto const* children = entity.try_get<Children const>();
   auto const hasChildren = children != nullptr;
   auto flags = hasChildren ? baseFlags : leafFlags;
   if (mSelectedEntity == entity) {
@@ -76,7 +81,7 @@ auto SceneInspector::entity_node(Entity entity) -> void {
 
   auto const open = [&] {
     if (auto const* name{entity.try_get<EntityName const>()}) {
-      return ImGui::TreeNodeEx(name->value.c_str(), flags);
+      return ImGui::TreeNodeEx("", flags, "%s", names.format(*name).c_str());
     }
 
     return ImGui::TreeNodeEx("", flags, "Entity %d", entityId);
@@ -87,9 +92,12 @@ auto SceneInspector::entity_node(Entity entity) -> void {
   }
 
   if (open && children) {
+    auto& entities = *entity.registry();
+
     // recursively traverse children
-    for (auto const childId : children->ids) {
-      entity_node(Entity{*entity.registry(), childId});
+    for (auto childId = children->first; childId != entt::null;
+         childId = entities.get<ChildLinks const>(childId).next) {
+      entity_node(Entity{entities, childId}, names);
     }
 
     ImGui::TreePop();
@@ -28,9 +28,10 @@ private:
   basalt::EntityId mSelectedEntity;
   std::vector<ComponentUi> mComponentUis;
 
-  auto entity_hierarchy(basalt::EntityRegistry&) -> void;
+  auto entity_hierarchy(basalt::EntityRegistry&, basalt::NameTable const&)
+    -> void;
 
-  auto entity_node(basalt::Entity) -> void;
+  auto entity_node(basalt::Entity, basalt::NameTable const&) -> void;
 
   auto entity_components(basalt::EntityRegistry&) -> void;
 };